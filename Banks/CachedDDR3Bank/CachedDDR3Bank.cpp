@@ -36,6 +36,7 @@
 #include "Banks/CachedDDR3Bank/CachedDDR3Bank.h"
 #include "include/NVMHelpers.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 
 #include <cassert>
 
@@ -54,8 +55,6 @@ CachedDDR3Bank::CachedDDR3Bank( )
     writebackCount = 0;
     RDBReads = 0;
     RDBWrites = 0;
-    allocationReadsHisto = "";
-    allocationWritesHisto = "";
 }
 
 
@@ -147,15 +146,8 @@ bool CachedDDR3Bank::Activate( NVMainRequest *request )
     {
         ncounter_t bufferIdx = rowBufferCount - 1;
 
-        if( allocationReadsMap.count( cachedRowBuffer[bufferIdx]->reads ) )
-            allocationReadsMap[ cachedRowBuffer[bufferIdx]->reads ]++;
-        else
-            allocationReadsMap[ cachedRowBuffer[bufferIdx]->reads ] = 1;
-
-        if( allocationWritesMap.count( cachedRowBuffer[bufferIdx]->writes ) )
-            allocationWritesMap[ cachedRowBuffer[bufferIdx]->writes ]++;
-        else
-            allocationWritesMap[ cachedRowBuffer[bufferIdx]->writes ] = 1;
+        allocationReadsHisto.Record( static_cast<double>( cachedRowBuffer[bufferIdx]->reads ) );
+        allocationWritesHisto.Record( static_cast<double>( cachedRowBuffer[bufferIdx]->writes ) );
 
         cachedRowBuffer[bufferIdx]->used = true;
         cachedRowBuffer[bufferIdx]->address = request->address;
@@ -433,11 +425,53 @@ void CachedDDR3Bank::RegisterStats( )
     AddStat(allocationWritesHisto);
 }
 
-void CachedDDR3Bank::CalculateStats( )
+/* The row buffers are saved in LRU order next to the DDR3Bank state. */
+void CachedDDR3Bank::CreateCheckpoint( std::string dir )
 {
-    allocationReadsHisto = PyDictHistogram<uint64_t, uint64_t>( allocationReadsMap );
-    allocationWritesHisto = PyDictHistogram<uint64_t, uint64_t>( allocationWritesMap );
+    Checkpoint cpt;
+
+    if( cpt.Create( Checkpoint::File( dir, StatName( ) + "_rdb" ) ) )
+    {
+        for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
+        {
+            CachedRowBuffer *buffer = cachedRowBuffer[bufferIdx];
+
+            cpt.Write( buffer->used );
+            cpt.Write( buffer->address );
+            cpt.WriteArray( buffer->dirty, rowBufferSize );
+            cpt.Write( buffer->colStart );
+            cpt.Write( buffer->colEnd );
+            cpt.Write( buffer->reads );
+            cpt.Write( buffer->writes );
+        }
+
+        cpt.Close( );
+    }
+
+    DDR3Bank::CreateCheckpoint( dir );
 }
 
+void CachedDDR3Bank::RestoreCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( cpt.Open( Checkpoint::File( dir, StatName( ) + "_rdb" ) ) )
+    {
+        for( ncounter_t bufferIdx = 0; bufferIdx < rowBufferCount; bufferIdx++ )
+        {
+            CachedRowBuffer *buffer = cachedRowBuffer[bufferIdx];
+
+            cpt.Read( buffer->used );
+            cpt.Read( buffer->address );
+            cpt.ReadArray( buffer->dirty, rowBufferSize );
+            cpt.Read( buffer->colStart );
+            cpt.Read( buffer->colEnd );
+            cpt.Read( buffer->reads );
+            cpt.Read( buffer->writes );
+        }
 
+        cpt.Close( );
+    }
 
+    DDR3Bank::RestoreCheckpoint( dir );
+}
@@ -68,7 +68,9 @@ class CachedDDR3Bank : public DDR3Bank
     virtual void SetConfig( Config *config, bool createChildren = true );
 
     virtual void RegisterStats( );
-    virtual void CalculateStats( );
+
+    virtual void CreateCheckpoint( std::string dir );
+    virtual void RestoreCheckpoint( std::string dir );
 
   private:
     CachedRowBuffer **cachedRowBuffer;
@@ -79,10 +81,8 @@ class CachedDDR3Bank : public DDR3Bank
     ncounter_t RDBAllocations;
     ncounter_t writebackCount;
     ncounter_t RDBReads, RDBWrites;
-    std::map<uint64_t, uint64_t> allocationReadsMap; // Number of reads in an allocation, Count
-    std::map<uint64_t, uint64_t> allocationWritesMap;
-    std::string allocationReadsHisto;
-    std::string allocationWritesHisto;
+    Histogram allocationReadsHisto; // Number of reads in an allocation, Count
+    Histogram allocationWritesHisto;
 
 };
 
@@ -36,6 +36,7 @@
 #include "Banks/DDR3Bank/DDR3Bank.h"
 #include "src/MemoryController.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 
 #include <signal.h>
 #include <cassert>
@@ -922,6 +923,11 @@ bool DDR3Bank::IssueCommand( NVMainRequest *req )
     return rv;
 }
 
+bool DDR3Bank::IssueAtomic( NVMainRequest *req )
+{
+    return GetChild( req )->IssueAtomic( req );
+}
+
 DDR3BankState DDR3Bank::GetState( ) 
 {
     return state;
@@ -1004,17 +1010,43 @@ void DDR3Bank::CalculateStats( )
     bankEnergy = activeEnergy = burstEnergy = refreshEnergy 
                = 0.0f;
 
+    if( subArrayStatHandles.empty( ) )
+    {
+        for( unsigned saIdx = 0; saIdx < subArrayNum; saIdx++ )
+        {
+            subArrayStatHandles.push_back( GetStatHandle( GetChild(saIdx), "subArrayEnergy" ) );
+            subArrayStatHandles.push_back( GetStatHandle( GetChild(saIdx), "activeEnergy" ) );
+            subArrayStatHandles.push_back( GetStatHandle( GetChild(saIdx), "burstEnergy" ) );
+            subArrayStatHandles.push_back( GetStatHandle( GetChild(saIdx), "refreshEnergy" ) );
+            subArrayStatHandles.push_back( GetStatHandle( GetChild(saIdx), "worstCaseEndurance" ) );
+            subArrayStatHandles.push_back( GetStatHandle( GetChild(saIdx), "averageEndurance" ) );
+        }
+    }
+
+    /* The handles are in the order they were looked up above. */
+    std::vector<StatHandle>::iterator handle = subArrayStatHandles.begin( );
+
+    worstCaseEndurance = std::numeric_limits<uint64_t>::max( );
+    averageEndurance = 0;
+
     for( unsigned saIdx = 0; saIdx < subArrayNum; saIdx++ )
     {
-        StatType saEstat  = GetStat( GetChild(saIdx), "subArrayEnergy" );
-        StatType actEstat = GetStat( GetChild(saIdx), "activeEnergy" );
-        StatType bstEstat = GetStat( GetChild(saIdx), "burstEnergy" );
-        StatType refEstat = GetStat( GetChild(saIdx), "refreshEnergy" );
+        StatType saEstat  = GetStats( )->getStat( *handle++ );
+        StatType actEstat = GetStats( )->getStat( *handle++ );
+        StatType bstEstat = GetStats( )->getStat( *handle++ );
+        StatType refEstat = GetStats( )->getStat( *handle++ );
 
         bankEnergy += CastStat( saEstat, double );
         activeEnergy += CastStat( actEstat, double );
         burstEnergy += CastStat( bstEstat, double );
         refreshEnergy += CastStat( refEstat, double );
+
+        StatType subArrayWorstEndr = GetStats( )->getStat( *handle++ );
+        StatType subArrayAverageEndr = GetStats( )->getStat( *handle++ );
+
+        uint64_t subArrayEndurance = CastStat( subArrayWorstEndr, uint64_t );
+        worstCaseEndurance = (subArrayEndurance < worstCaseEndurance) ? subArrayEndurance : worstCaseEndurance;
+        averageEndurance += CastStat( subArrayAverageEndr, uint64_t );
     }
 
     CalculatePower( );
@@ -1024,20 +1056,64 @@ void DDR3Bank::CalculateStats( )
 
     actWaitAverage = static_cast<double>(actWaitTotal) / static_cast<double>(actWaits);
 
-    worstCaseEndurance = std::numeric_limits<uint64_t>::max( );
-    averageEndurance = 0;
-    for( ncounter_t i = 0; i < GetChildCount( ); i++ )
-    {
-        StatType subArrayWorstEndr = GetStat( GetChild(i), "worstCaseEndurance" );
-        StatType subArrayAverageEndr = GetStat( GetChild(i), "averageEndurance" );
+    averageEndurance /= GetChildCount( );
+}
 
-        uint64_t subArrayEndurance = CastStat( subArrayWorstEndr, uint64_t );
-        worstCaseEndurance = (subArrayEndurance < worstCaseEndurance) ? subArrayEndurance : worstCaseEndurance;
-        averageEndurance += CastStat( subArrayAverageEndr, uint64_t );
+void DDR3Bank::CreateCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( cpt.Create( Checkpoint::File( dir, StatName( ) ) ) )
+    {
+        cpt.Write( state );
+        cpt.WriteSequence( activeSubArrayQueue );
+        cpt.Write( lastActivate );
+        cpt.Write( nextActivate );
+        cpt.Write( nextPrecharge );
+        cpt.Write( nextRead );
+        cpt.Write( nextWrite );
+        cpt.Write( nextRefresh );
+        cpt.Write( nextRefreshDone );
+        cpt.Write( nextPowerDown );
+        cpt.Write( nextPowerDownDone );
+        cpt.Write( nextPowerUp );
+        cpt.Write( writeCycle );
+        cpt.Write( idleTimer );
+        cpt.Write( openRow );
+
+        cpt.Close( );
     }
-    averageEndurance /= GetChildCount( );
+
+    NVMObject::CreateCheckpoint( dir );
 }
 
+void DDR3Bank::RestoreCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( cpt.Open( Checkpoint::File( dir, StatName( ) ) ) )
+    {
+        cpt.Read( state );
+        cpt.ReadSequence( activeSubArrayQueue );
+        cpt.Read( lastActivate );
+        cpt.Read( nextActivate );
+        cpt.Read( nextPrecharge );
+        cpt.Read( nextRead );
+        cpt.Read( nextWrite );
+        cpt.Read( nextRefresh );
+        cpt.Read( nextRefreshDone );
+        cpt.Read( nextPowerDown );
+        cpt.Read( nextPowerDownDone );
+        cpt.Read( nextPowerUp );
+        cpt.Read( writeCycle );
+        cpt.Read( idleTimer );
+        cpt.Read( openRow );
+
+        cpt.Close( );
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
+}
 
 bool DDR3Bank::Idle( )
 {
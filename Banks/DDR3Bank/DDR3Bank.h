@@ -38,6 +38,7 @@
 
 #include <stdint.h>
 #include <map>
+#include <vector>
 
 #include "src/Bank.h"
 #include "src/Config.h"
@@ -82,6 +83,7 @@ class DDR3Bank : public Bank
 
     virtual bool IsIssuable( NVMainRequest *req, FailReason *reason = NULL );
     virtual bool IssueCommand( NVMainRequest *req );
+    virtual bool IssueAtomic( NVMainRequest *req );
     virtual ncycle_t NextIssuable( NVMainRequest *request );
 
     virtual void SetConfig( Config *c, bool createChildren = true );
@@ -102,6 +104,9 @@ class DDR3Bank : public Bank
     virtual void RegisterStats( );
     virtual void CalculateStats( );
 
+    virtual void CreateCheckpoint( std::string dir );
+    virtual void RestoreCheckpoint( std::string dir );
+
     virtual ncounter_t GetId( );
     virtual std::string GetName( );
 
@@ -158,6 +163,9 @@ class DDR3Bank : public Bank
 
     uint64_t averageEndurance, worstCaseEndurance;
 
+    /* Sub-array stats summed by CalculateStats, looked up on its first call. */
+    std::vector<StatHandle> subArrayStatHandles;
+
     ncounter_t reads, writes, activates, precharges, refreshes;
     ncounter_t idleTimer;
 
@@ -32,6 +32,7 @@
 *******************************************************************************/
 
 #include "DataEncoders/FlipNWrite/FlipNWrite.h"
+#include "src/Checkpoint.h"
 
 #include <iostream>
 
@@ -75,6 +76,16 @@ void FlipNWrite::RegisterStats( )
     AddUnitStat(flipNWriteReduction, "%");
 }
 
+void FlipNWrite::WriteCheckpoint( Checkpoint& cpt )
+{
+    cpt.WriteSequence( flippedAddresses );
+}
+
+void FlipNWrite::ReadCheckpoint( Checkpoint& cpt )
+{
+    cpt.ReadSequence( flippedAddresses );
+}
+
 void FlipNWrite::InvertData( NVMDataBlock& data, uint64_t startBit, uint64_t endBit )
 {
     uint64_t wordSize;
@@ -53,6 +53,9 @@ class FlipNWrite : public DataEncoder
     void RegisterStats( );
     void CalculateStats( );
 
+    void WriteCheckpoint( Checkpoint& cpt );
+    void ReadCheckpoint( Checkpoint& cpt );
+
   private:
     std::set< uint64_t > flippedAddresses;
   
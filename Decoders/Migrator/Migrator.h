@@ -64,6 +64,8 @@ class Migrator : public AddressTranslator
                             uint64_t *rank, uint64_t *channel, uint64_t *subarray );
     using AddressTranslator::Translate;
 
+    void RequestIssued( NVMainRequest *request );
+
     void StartMigration( NVMAddress& promotee, NVMAddress& demotee );
     void SetMigrationState( NVMAddress& address, MigratorState newState );
     bool Migrating( );
@@ -138,6 +138,11 @@ bool OffChipBus::IsIssuable( NVMainRequest *req, FailReason *reason )
     return GetChild( req )->IsIssuable( req, reason );
 }
 
+bool OffChipBus::IssueAtomic( NVMainRequest *req )
+{
+    return GetChild( req )->IssueAtomic( req );
+}
+
 void OffChipBus::CalculateStats( )
 {
     for( ncounter_t childIdx = 0; childIdx < GetChildren().size(); childIdx++ )
@@ -50,6 +50,7 @@ class OffChipBus : public Interconnect
 
     bool IssueCommand( NVMainRequest *req );
     bool IsIssuable( NVMainRequest *req, FailReason *reason = NULL );
+    bool IssueAtomic( NVMainRequest *req );
     bool RequestComplete( NVMainRequest *request );
 
     void CalculateStats( );
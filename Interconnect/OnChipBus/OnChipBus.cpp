@@ -126,6 +126,11 @@ bool OnChipBus::IsIssuable( NVMainRequest *req, FailReason *reason )
     return GetChild( req )->IsIssuable( req, reason );
 }
 
+bool OnChipBus::IssueAtomic( NVMainRequest *req )
+{
+    return GetChild( req )->IssueAtomic( req );
+}
+
 void OnChipBus::CalculateStats( )
 {
     for( ncounter_t childIdx = 0; childIdx < GetChildren().size(); childIdx++ )
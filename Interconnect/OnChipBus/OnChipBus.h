@@ -50,6 +50,7 @@ class OnChipBus : public Interconnect
 
     bool IssueCommand( NVMainRequest *mop );
     bool IsIssuable( NVMainRequest *mop, FailReason *reason = NULL );
+    bool IssueAtomic( NVMainRequest *mop );
 
     void CalculateStats( );
 
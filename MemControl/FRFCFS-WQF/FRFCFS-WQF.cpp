@@ -35,6 +35,7 @@
 
 #include "MemControl/FRFCFS-WQF/FRFCFS-WQF.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 
 #include <cassert>
 
@@ -231,6 +232,10 @@ bool FRFCFS_WQF::IsIssuable( NVMainRequest *request, FailReason * /*fail*/ )
 {
     bool rv = true;
 
+    /* A forced drain is over once the write queue has emptied. */
+    if( force_drain == true && writeQueue->empty( ) )
+        force_drain = false;
+
     /* during a write drain, no write can enqueue */
     if( (request->type == READ  && readQueue->size()  >= readQueueSize) 
             || (request->type == WRITE && ( writeQueue->size() >= writeQueueSize 
@@ -541,3 +546,44 @@ bool FRFCFS_WQF::Drain( )
     return true;
 }
 
+void FRFCFS_WQF::CreateCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( cpt.Create( Checkpoint::File( dir, StatName( ) + "_drain" ) ) )
+    {
+        cpt.Write( m_draining );
+        cpt.Write( force_drain );
+        cpt.Write( m_request_per_drain );
+        cpt.Write( m_drain_start_cycle );
+        cpt.Write( m_drain_end_cycle );
+        cpt.Write( m_drain_start_readqueue_size );
+        cpt.Write( m_drain_end_readqueue_size );
+        cpt.Write( m_last_drain_end_cycle );
+
+        cpt.Close( );
+    }
+
+    MemoryController::CreateCheckpoint( dir );
+}
+
+void FRFCFS_WQF::RestoreCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( cpt.Open( Checkpoint::File( dir, StatName( ) + "_drain" ) ) )
+    {
+        cpt.Read( m_draining );
+        cpt.Read( force_drain );
+        cpt.Read( m_request_per_drain );
+        cpt.Read( m_drain_start_cycle );
+        cpt.Read( m_drain_end_cycle );
+        cpt.Read( m_drain_start_readqueue_size );
+        cpt.Read( m_drain_end_readqueue_size );
+        cpt.Read( m_last_drain_end_cycle );
+
+        cpt.Close( );
+    }
+
+    MemoryController::RestoreCheckpoint( dir );
+}
@@ -59,6 +59,9 @@ class FRFCFS_WQF : public MemoryController
     void RegisterStats( );
     void CalculateStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   private:
     /* separate read/write queue */
     NVMTransactionQueue *readQueue;
@@ -35,8 +35,10 @@
 #include "include/NVMHelpers.h"
 #include "NVM/nvmain.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 
 #include <iostream>
+#include <sstream>
 #include <set>
 #include <assert.h>
 
@@ -685,3 +687,47 @@ void LH_Cache::CalculateStats( )
 {
     MemoryController::CalculateStats( );
 }
+
+void LH_Cache::CreateCheckpoint( std::string dir )
+{
+    for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+    {
+        for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
+        {
+            std::stringstream cpt_file;
+            cpt_file << StatName( ) << "_r" << rankIdx << "_b" << bankIdx;
+
+            Checkpoint cpt;
+
+            if( cpt.Create( Checkpoint::File( dir, cpt_file.str( ) ) ) )
+            {
+                functionalCache[rankIdx][bankIdx]->WriteCheckpoint( cpt );
+                cpt.Close( );
+            }
+        }
+    }
+
+    MemoryController::CreateCheckpoint( dir );
+}
+
+void LH_Cache::RestoreCheckpoint( std::string dir )
+{
+    for( ncounter_t rankIdx = 0; rankIdx < p->RANKS; rankIdx++ )
+    {
+        for( ncounter_t bankIdx = 0; bankIdx < p->BANKS; bankIdx++ )
+        {
+            std::stringstream cpt_file;
+            cpt_file << StatName( ) << "_r" << rankIdx << "_b" << bankIdx;
+
+            Checkpoint cpt;
+
+            if( cpt.Open( Checkpoint::File( dir, cpt_file.str( ) ) ) )
+            {
+                functionalCache[rankIdx][bankIdx]->ReadCheckpoint( cpt );
+                cpt.Close( );
+            }
+        }
+    }
+
+    MemoryController::RestoreCheckpoint( dir );
+}
@@ -69,6 +69,9 @@ class LH_Cache : public AbstractDRAMCache
     void RegisterStats( );
     void CalculateStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   protected:
     NVMainRequest *MakeTagRequest( NVMainRequest *triggerRequest, int tag );
     NVMainRequest *MakeTagWriteRequest( NVMainRequest *triggerRequest );
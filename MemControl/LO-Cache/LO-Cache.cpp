@@ -36,6 +36,7 @@
 #include "include/NVMHelpers.h"
 #include "NVM/nvmain.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 
 #include <iostream>
 #include <sstream>
@@ -532,51 +533,19 @@ void LO_Cache::CreateCheckpoint( std::string dir )
         for( ncounter_t bankIdx = 0; bankIdx < banks; bankIdx++ )
         {
             std::stringstream cpt_file;
-            cpt_file.str("");
-            cpt_file << dir << "/" << statName << "_r";
-            cpt_file << rankIdx << "_b" << bankIdx;
+            cpt_file << StatName( ) << "_r" << rankIdx << "_b" << bankIdx;
 
-            std::ofstream cpt_handle;
-            
-            cpt_handle.open( cpt_file.str().c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary );
+            Checkpoint cpt;
 
-            if( !cpt_handle.is_open( ) )
+            if( cpt.Create( Checkpoint::File( dir, cpt_file.str( ) ) ) )
             {
-                std::cout << "LO_Cache: Warning: Could not open checkpoint file: " << cpt_file.str() << "!" << std::endl;
-            }
-            else
-            {
-                /* Iterate over cache sets, since they may not be allocated contiguously. */
-                for( uint64_t set = 0; set < functionalCache[rankIdx][bankIdx]->numSets; set++ )
-                {
-                    cpt_handle.write( (const char *)(functionalCache[rankIdx][bankIdx]->cacheEntry[set]), 
-                                      sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numAssoc );
-                }
-
-                cpt_handle.close( );
-            }
-
-            /* Write checkpoint information. */
-            /* Note: For future compatability only at the memory. This is not read during restoration. */
-            std::string cpt_info = cpt_file.str() + ".json";
-
-            cpt_handle.open( cpt_info.c_str(), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary );
-
-            if( !cpt_handle.is_open() )
-            {
-                std::cout << "LO_Cache: Warning: Could not open checkpoint info file: " << cpt_info << "!" << std::endl;
-            }
-            else
-            {
-                std::string cpt_info_str = "{\n\t\"Version\": 1\n}";
-                cpt_handle.write( cpt_info_str.c_str(), cpt_info_str.length() ); 
-
-                cpt_handle.close();
+                functionalCache[rankIdx][bankIdx]->WriteCheckpoint( cpt );
+                cpt.Close( );
             }
         }
     }
 
-    NVMObject::CreateCheckpoint( dir );
+    MemoryController::CreateCheckpoint( dir );
 }
 
 void LO_Cache::RestoreCheckpoint( std::string dir )
@@ -586,45 +555,17 @@ void LO_Cache::RestoreCheckpoint( std::string dir )
         for( ncounter_t bankIdx = 0; bankIdx < banks; bankIdx++ )
         {
             std::stringstream cpt_file;
-            cpt_file.str("");
-            cpt_file << dir << "/" << statName << "_r";
-            cpt_file << rankIdx << "_b" << bankIdx;
-
-            std::ifstream cpt_handle;
+            cpt_file << StatName( ) << "_r" << rankIdx << "_b" << bankIdx;
 
-            cpt_handle.open( cpt_file.str().c_str(), std::ifstream::ate | std::ifstream::binary );
+            Checkpoint cpt;
 
-            if( !cpt_handle.is_open( ) )
-            {
-                std::cout << "LO_Cache: Warning: Could not open checkpoint file: " << cpt_file.str() << "!" << std::endl;
-            }
-            else
+            if( cpt.Open( Checkpoint::File( dir, cpt_file.str( ) ) ) )
             {
-                std::streampos expectedSize = sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numSets*functionalCache[rankIdx][bankIdx]->numAssoc;
-                if( cpt_handle.tellg( ) != expectedSize )
-                {
-                    std::cout << "LO_Cache: Warning: Expected checkpoint size differs from DRAM cache configuration. Skipping restore." << std::endl;
-                }
-                else
-                {
-                    cpt_handle.close( );
-
-                    cpt_handle.open( cpt_file.str().c_str(), std::ifstream::in | std::ifstream::binary );
-
-                    /* Iterate over cache sets, since they may not be allocated contiguously. */
-                    for( uint64_t set = 0; set < functionalCache[rankIdx][bankIdx]->numSets; set++ )
-                    {
-                        cpt_handle.read( (char *)(functionalCache[rankIdx][bankIdx]->cacheEntry[set]), 
-                                          sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numAssoc );
-                    }
-
-                    cpt_handle.close( );
-
-                    std::cout << "LO_Cache: Checkpoint read " << (sizeof(CacheEntry)*functionalCache[rankIdx][bankIdx]->numAssoc*functionalCache[rankIdx][bankIdx]->numSets) << " bytes." << std::endl;
-                }
+                functionalCache[rankIdx][bankIdx]->ReadCheckpoint( cpt );
+                cpt.Close( );
             }
         }
     }
 
-    NVMObject::RestoreCheckpoint( dir );
+    MemoryController::RestoreCheckpoint( dir );
 }
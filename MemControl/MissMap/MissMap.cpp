@@ -36,6 +36,7 @@
 #include "MemControl/LH-Cache/LH-Cache.h"
 #include "include/NVMHelpers.h"
 #include "NVM/nvmain.h"
+#include "src/Checkpoint.h"
 #include <assert.h>
 
 using namespace NVM;
@@ -166,9 +167,11 @@ bool MissMap::IssueAtomic( NVMainRequest *req )
     lineOffset = ((req->address.GetPhysicalAddress( ) >> 6) & 0xFFF) / 64; 
     lineMask = (uint64_t)(1ULL << lineOffset);
 
+#ifdef DBGMISSMAP
     std::cout << "Address 0x" << std::hex << req->address.GetPhysicalAddress() 
         << " maps to page 0x" << testAddr.GetPhysicalAddress( ) << std::dec 
         << " with offset " << lineOffset << std::endl;
+#endif
     
     /* Entry exists, so augment the existing bit-vector */
     if( missMap->Present( testAddr ) )
@@ -532,3 +535,29 @@ void MissMap::Cycle( ncycle_t )
 void MissMap::CalculateStats( )
 {
 }
+
+void MissMap::CreateCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( cpt.Create( Checkpoint::File( dir, StatName( ) + "_missmap" ) ) )
+    {
+        missMap->WriteCheckpoint( cpt );
+        cpt.Close( );
+    }
+
+    MemoryController::CreateCheckpoint( dir );
+}
+
+void MissMap::RestoreCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( cpt.Open( Checkpoint::File( dir, StatName( ) + "_missmap" ) ) )
+    {
+        missMap->ReadCheckpoint( cpt );
+        cpt.Close( );
+    }
+
+    MemoryController::RestoreCheckpoint( dir );
+}
@@ -69,6 +69,9 @@ class MissMap : public MemoryController
     void RegisterStats( );
     void CalculateStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   private:
     CacheBank *missMap;
     std::queue<NVMainRequest *> missMapQueue;
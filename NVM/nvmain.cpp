@@ -37,6 +37,7 @@
 #include "src/Interconnect.h"
 #include "src/SimInterface.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 #include "Interconnect/InterconnectFactory.h"
 #include "MemControl/MemoryControllerFactory.h"
 #include "traceWriter/TraceWriterFactory.h"
@@ -48,6 +49,8 @@
 
 #include <sstream>
 #include <cassert>
+#include <algorithm>
+#include <limits>
 
 using namespace NVM;
 
@@ -66,10 +69,40 @@ NVMain::NVMain( )
     prefetcher = NULL;
     successfulPrefetches = 0;
     unsuccessfulPrefetches = 0;
+
+    parallelChannels = false;
+    channelQueues = NULL;
+    channelResponses = NULL;
+    runningChannels = false;
+    lookahead = 1;
+    nextEpoch = std::numeric_limits<ncycle_t>::max( );
+    numWorkers = 0;
+    workers = NULL;
+    epochCount = 0;
+    workersBusy = 0;
+    epochTarget = 0;
+    workersExit = false;
 }
 
 NVMain::~NVMain( )
 {
+    if( workers )
+    {
+        pthread_mutex_lock( &workerLock );
+        workersExit = true;
+        pthread_cond_broadcast( &workerStart );
+        pthread_mutex_unlock( &workerLock );
+
+        for( ncounter_t i = 1; i < numWorkers; i++ )
+            pthread_join( workers[i].thread, NULL );
+
+        pthread_cond_destroy( &workerStart );
+        pthread_cond_destroy( &workerDone );
+        pthread_mutex_destroy( &workerLock );
+
+        delete [] workers;
+    }
+
     if( config ) 
         delete config;
     
@@ -87,6 +120,9 @@ NVMain::~NVMain( )
     if( translator )
         delete translator;
 
+    if( preTracer )
+        delete preTracer;
+
     if( channelConfig )
     {
         for( unsigned int i = 0; i < numChannels; i++ )
@@ -96,6 +132,15 @@ NVMain::~NVMain( )
 
         delete [] channelConfig;
     }
+
+    if( channelQueues )
+    {
+        for( unsigned int i = 0; i < numChannels; i++ )
+            delete channelQueues[i];
+
+        delete [] channelQueues;
+        delete [] channelResponses;
+    }
 }
 
 Config *NVMain::GetConfig( )
@@ -162,6 +207,33 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
 
         memoryControllers = new MemoryController* [channels];
         channelConfig = new Config* [channels];
+
+        if( p->ParallelChannels )
+        {
+            if( p->MemoryPrefetcher != "none" )
+            {
+                std::cout << "NVMain: ParallelChannels does not support memory prefetchers. "
+                          << "Running channels sequentially." << std::endl;
+            }
+            else if( !hooks[NVMHOOK_PREISSUE].empty( ) || !hooks[NVMHOOK_POSTISSUE].empty( ) )
+            {
+                std::cout << "NVMain: ParallelChannels does not support hooks. "
+                          << "Running channels sequentially." << std::endl;
+            }
+            else if( config->KeyExists( "MM_CONFIG" ) )
+            {
+                /* DRAM cache channels share an off-chip memory. */
+                std::cout << "NVMain: ParallelChannels does not support DRAM caches. "
+                          << "Running channels sequentially." << std::endl;
+            }
+            else
+            {
+                parallelChannels = true;
+                channelQueues = new EventQueue* [channels];
+                channelResponses = new std::vector<ChannelResponse> [channels];
+            }
+        }
+
         for( int i = 0; i < channels; i++ )
         {
             std::stringstream confString;
@@ -203,6 +275,15 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
             AddChild( memoryControllers[i] );
             memoryControllers[i]->SetParent( this );
 
+            /* Children created by SetConfig inherit the channel's queue. */
+            if( parallelChannels )
+            {
+                channelQueues[i] = new EventQueue( );
+                channelQueues[i]->SetFrequency( GetEventQueue( )->GetFrequency( ) );
+                channelQueues[i]->SetConfig( channelConfig[i] );
+                memoryControllers[i]->SetEventQueue( channelQueues[i] );
+            }
+
             /* Set Config recursively. */
             memoryControllers[i]->SetConfig( channelConfig[i], createChildren );
 
@@ -219,6 +300,9 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
     }
 
     numChannels = static_cast<unsigned int>(p->CHANNELS);
+
+    if( parallelChannels )
+        SetupParallelChannels( );
     
     std::string pretraceFile;
 
@@ -246,6 +330,8 @@ void NVMain::SetConfig( Config *conf, std::string memoryName, bool createChildre
             preTracer->SetTraceFile( pretraceFile );
         if( p->EchoPreTrace )
             preTracer->SetEcho( true );
+
+        preTracer->Init( config );
     }
 
     RegisterStats( );
@@ -261,12 +347,49 @@ bool NVMain::IsIssuable( NVMainRequest *request, FailReason *reason )
     GetDecoder( )->Translate( request->address.GetPhysicalAddress( ), 
                            &row, &col, &rank, &bank, &channel, &subarray );
 
+    if( parallelChannels )
+        SyncChannel( channel, GetEventQueue( )->GetCurrentCycle( ) );
+
     rv = memoryControllers[channel]->IsIssuable( request, reason );
 
     return rv;
 }
 
-void NVMain::GeneratePrefetches( NVMainRequest *request, std::vector<NVMAddress>& prefetchList )
+/*
+ *  Controllers only change whether they accept a request when one of their
+ *  events fires, so the next event on the request's channel (or on any
+ *  channel for a NULL request) is the earliest cycle IsIssuable can change.
+ */
+ncycle_t NVMain::NextIssuable( NVMainRequest *request )
+{
+    uint64_t channel, rank, bank, row, col, subarray;
+    ncycle_t nextWakeup;
+
+    if( !parallelChannels )
+        return GetEventQueue( )->GetNextEvent( );
+
+    if( request != NULL )
+    {
+        GetDecoder( )->Translate( request->address.GetPhysicalAddress( ), 
+                               &row, &col, &rank, &bank, &channel, &subarray );
+
+        return channelQueues[channel]->GetNextEvent( );
+    }
+
+    nextWakeup = std::numeric_limits<ncycle_t>::max( );
+
+    for( unsigned int i = 0; i < numChannels; i++ )
+        nextWakeup = std::min( nextWakeup, channelQueues[i]->GetNextEvent( ) );
+
+    return nextWakeup;
+}
+
+/*
+ *  Atomic prefetches are placed in the prefetch buffer at once, as if they
+ *  had completed, since atomic requests are not simulated.
+ */
+void NVMain::GeneratePrefetches( NVMainRequest *request, std::vector<NVMAddress>& prefetchList,
+                                 bool atomic )
 {
     std::vector<NVMAddress>::iterator iter;
     ncounter_t channel, rank, bank, row, col, subarray;
@@ -290,11 +413,14 @@ void NVMain::GeneratePrefetches( NVMainRequest *request, std::vector<NVMAddress>
         //          << request->address.GetPhysicalAddress( ) << std::dec << std::endl;
 
         /* Just type to issue; If the queue is full it simply won't be enqueued. */
-        GetChild( pfRequest )->IssueCommand( pfRequest );
+        if( atomic )
+            BufferPrefetch( pfRequest );
+        else
+            GetChild( pfRequest )->IssueCommand( pfRequest );
     }
 }
 
-void NVMain::IssuePrefetch( NVMainRequest *request )
+void NVMain::IssuePrefetch( NVMainRequest *request, bool atomic )
 {
     /* 
      *  Generate prefetches here. It makes the most sense to prefetch in this class
@@ -307,11 +433,32 @@ void NVMain::IssuePrefetch( NVMainRequest *request )
     if( prefetcher && request->type == READ && request->isPrefetch == false 
         && prefetcher->DoPrefetch(request, prefetchList) )
     {
-        GeneratePrefetches( request, prefetchList );
+        GeneratePrefetches( request, prefetchList, atomic );
     }
 }
 
-bool NVMain::CheckPrefetch( NVMainRequest *request )
+void NVMain::BufferPrefetch( NVMainRequest *request )
+{
+    //std::cout << "Placing 0x" << std::hex << request->address.GetPhysicalAddress( )
+    //          << std::dec << " into prefetch buffer (cur size: " << prefetchBuffer.size( )
+    //          << ")." << std::endl;
+
+    /* Place in prefetch buffer. */
+    if( prefetchBuffer.size() >= p->PrefetchBufferSize )
+    {
+        unsuccessfulPrefetches++;
+        //std::cout << "Prefetch buffer is full. Removing oldest prefetch: 0x" << std::hex
+        //          << prefetchBuffer.front()->address.GetPhysicalAddress() << std::dec
+        //          << std::endl;
+
+        delete prefetchBuffer.front();
+        prefetchBuffer.pop_front();
+    }
+
+    prefetchBuffer.push_back( request );
+}
+
+bool NVMain::CheckPrefetch( NVMainRequest *request, bool atomic )
 {
     bool rv = false;
     NVMainRequest *pfRequest = NULL;
@@ -324,7 +471,7 @@ bool NVMain::CheckPrefetch( NVMainRequest *request )
         {
             if( prefetcher->NotifyAccess(request, prefetchList) )
             {
-                GeneratePrefetches( request, prefetchList );
+                GeneratePrefetches( request, prefetchList, atomic );
             }
 
             successfulPrefetches++;
@@ -393,11 +540,18 @@ bool NVMain::IssueCommand( NVMainRequest *request )
         return true;
     }
 
+    if( parallelChannels )
+        SyncChannel( channel, GetEventQueue( )->GetCurrentCycle( ) );
+
     assert( GetChild( request )->GetTrampoline( ) == memoryControllers[channel] );
     mc_rv = GetChild( request )->IssueCommand( request );
+
+    if( parallelChannels )
+        ScheduleEpoch( );
     if( mc_rv == true )
     {
         IssuePrefetch( request );
+        GetDecoder( )->RequestIssued( request );
 
         if( request->type == READ ) 
         {
@@ -432,15 +586,22 @@ bool NVMain::IssueAtomic( NVMainRequest *request )
     request->bulkCmd = CMD_NOP;
 
     /* Check for any successful prefetches. */
-    if( CheckPrefetch( request ) )
+    if( CheckPrefetch( request, true ) )
     {
         return true;
     }
 
+    if( parallelChannels )
+        SyncChannel( channel, GetEventQueue( )->GetCurrentCycle( ) );
+
     mc_rv = memoryControllers[channel]->IssueAtomic( request );
+
+    if( parallelChannels )
+        ScheduleEpoch( );
     if( mc_rv == true )
     {
-        IssuePrefetch( request );
+        IssuePrefetch( request, true );
+        GetDecoder( )->RequestIssued( request );
 
         if( request->type == READ ) 
         {
@@ -461,27 +622,26 @@ bool NVMain::RequestComplete( NVMainRequest *request )
 {
     bool rv = false;
 
-    if( request->owner == this )
+    /* Completions from a channel being caught up wait for the epoch boundary. */
+    if( runningChannels )
     {
-        if( request->isPrefetch )
-        {
-            //std::cout << "Placing 0x" << std::hex << request->address.GetPhysicalAddress( )
-            //          << std::dec << " into prefetch buffer (cur size: " << prefetchBuffer.size( )
-            //          << ")." << std::endl;
+        ncounter_t channel = request->address.GetChannel( );
+        ChannelResponse response;
 
-            /* Place in prefetch buffer. */
-            if( prefetchBuffer.size() >= p->PrefetchBufferSize )
-            {
-                unsuccessfulPrefetches++;
-                //std::cout << "Prefetch buffer is full. Removing oldest prefetch: 0x" << std::hex
-                //          << prefetchBuffer.front()->address.GetPhysicalAddress() << std::dec
-                //          << std::endl;
+        assert( channel < numChannels );
 
-                delete prefetchBuffer.front();
-                prefetchBuffer.pop_front();
-            }
+        response.cycle = channelQueues[channel]->GetCurrentCycle( );
+        response.request = request;
+        channelResponses[channel].push_back( response );
+
+        return true;
+    }
 
-            prefetchBuffer.push_back( request );
+    if( request->owner == this )
+    {
+        if( request->isPrefetch )
+        {
+            BufferPrefetch( request );
             rv = true;
         }
         else
@@ -523,6 +683,9 @@ void NVMain::RegisterStats( )
 
 void NVMain::CalculateStats( )
 {
+    if( parallelChannels )
+        SyncChannels( GetEventQueue( )->GetCurrentCycle( ) );
+
     for( unsigned int i = 0; i < numChannels; i++ )
         memoryControllers[i]->CalculateStats( );
 }
@@ -532,3 +695,273 @@ void NVMain::EnqueuePendingMemoryRequests( NVMainRequest *req )
     pendingMemoryRequests.push(req);
 }
 
+
+bool NVMain::Drain( )
+{
+    bool rv;
+
+    /* Drain state is set on each controller at the current cycle. */
+    if( parallelChannels )
+        SyncChannels( GetEventQueue( )->GetCurrentCycle( ) );
+
+    rv = NVMObject::Drain( );
+
+    if( parallelChannels )
+        ScheduleEpoch( );
+
+    return rv;
+}
+
+/*
+ *  The memory system is checkpointed once it has drained, so only the
+ *  clock of its event queue is saved here. The children restore their
+ *  pending events before the clock is moved forward.
+ */
+void NVMain::CreateCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( parallelChannels )
+    {
+        std::cout << "NVMain: Warning: Checkpoints do not support ParallelChannels. "
+            << StatName( ) << " is not saved." << std::endl;
+        return;
+    }
+
+    if( cpt.Create( Checkpoint::File( dir, StatName( ) ) ) )
+    {
+        cpt.Write( GetEventQueue( )->GetCurrentCycle( ) );
+        cpt.Write( GetEventQueue( )->GetLastEventCycle( ) );
+
+        cpt.Close( );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void NVMain::RestoreCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+    ncycle_t currentCycle = 0, lastEventCycle = 0;
+
+    if( parallelChannels )
+    {
+        std::cout << "NVMain: Warning: Checkpoints do not support ParallelChannels. "
+            << StatName( ) << " is not restored." << std::endl;
+        return;
+    }
+
+    if( !cpt.Open( Checkpoint::File( dir, StatName( ) ) ) )
+        return;
+
+    cpt.Read( currentCycle );
+    cpt.Read( lastEventCycle );
+
+    if( cpt.Close( ) )
+    {
+        NVMObject::RestoreCheckpoint( dir );
+
+        GetEventQueue( )->RestoreCycles( currentCycle, lastEventCycle );
+    }
+}
+
+void NVMain::SetupParallelChannels( )
+{
+    lookahead = p->ParallelLookahead;
+
+    /* No response can leave a channel sooner than a row buffer hit. */
+    if( lookahead == 0 )
+    {
+        lookahead = std::numeric_limits<ncycle_t>::max( );
+
+        for( unsigned int i = 0; i < numChannels; i++ )
+        {
+            Params *channelParams = memoryControllers[i]->GetParams( );
+
+            lookahead = std::min( lookahead, channelParams->tCAS + channelParams->tBURST );
+        }
+
+        if( lookahead == 0 )
+            lookahead = 1;
+    }
+
+    numWorkers = p->ParallelThreads;
+    if( numWorkers == 0 || numWorkers > numChannels )
+        numWorkers = numChannels;
+
+    std::cout << "NVMain: Simulating " << numChannels << " channels on " << numWorkers
+              << " threads with a " << lookahead << " cycle lookahead." << std::endl;
+
+    pthread_mutex_init( &workerLock, NULL );
+    pthread_cond_init( &workerStart, NULL );
+    pthread_cond_init( &workerDone, NULL );
+
+    /* The calling thread acts as worker 0. */
+    workers = new ChannelWorker[numWorkers];
+    for( ncounter_t i = 0; i < numWorkers; i++ )
+    {
+        workers[i].nvmain = this;
+        workers[i].id = i;
+
+        if( i > 0 )
+            pthread_create( &workers[i].thread, NULL, &NVMain::WorkerThread, &workers[i] );
+    }
+}
+
+void *NVMain::WorkerThread( void *arg )
+{
+    ChannelWorker *worker = reinterpret_cast<ChannelWorker *>(arg);
+    NVMain *nvmain = worker->nvmain;
+    ncounter_t lastEpoch = 0;
+
+    pthread_mutex_lock( &nvmain->workerLock );
+
+    while( true )
+    {
+        while( !nvmain->workersExit && nvmain->epochCount == lastEpoch )
+            pthread_cond_wait( &nvmain->workerStart, &nvmain->workerLock );
+
+        if( nvmain->workersExit )
+            break;
+
+        lastEpoch = nvmain->epochCount;
+        ncycle_t target = nvmain->epochTarget;
+
+        pthread_mutex_unlock( &nvmain->workerLock );
+
+        nvmain->RunChannels( worker->id, target );
+
+        pthread_mutex_lock( &nvmain->workerLock );
+
+        if( --nvmain->workersBusy == 0 )
+            pthread_cond_signal( &nvmain->workerDone );
+    }
+
+    pthread_mutex_unlock( &nvmain->workerLock );
+
+    return NULL;
+}
+
+/* Channels are statically assigned to workers round-robin. */
+void NVMain::RunChannels( ncounter_t worker, ncycle_t target )
+{
+    for( ncounter_t i = worker; i < numChannels; i += numWorkers )
+    {
+        ncycle_t channelCycle = channelQueues[i]->GetCurrentCycle( );
+
+        if( target > channelCycle )
+            channelQueues[i]->Loop( target - channelCycle );
+    }
+}
+
+/* 
+ *  Catch up a single channel on the calling thread. Used before a request
+ *  is handed to the channel so it sees the channel's state at this cycle.
+ */
+void NVMain::SyncChannel( ncounter_t channel, ncycle_t target )
+{
+    ncycle_t channelCycle = channelQueues[channel]->GetCurrentCycle( );
+
+    if( target > channelCycle )
+    {
+        runningChannels = true;
+        channelQueues[channel]->Loop( target - channelCycle );
+        runningChannels = false;
+    }
+}
+
+void NVMain::SyncChannels( ncycle_t target )
+{
+    runningChannels = true;
+
+    if( numWorkers > 1 )
+    {
+        pthread_mutex_lock( &workerLock );
+        epochTarget = target;
+        epochCount++;
+        workersBusy = numWorkers - 1;
+        pthread_cond_broadcast( &workerStart );
+        pthread_mutex_unlock( &workerLock );
+    }
+
+    RunChannels( 0, target );
+
+    if( numWorkers > 1 )
+    {
+        pthread_mutex_lock( &workerLock );
+        while( workersBusy > 0 )
+            pthread_cond_wait( &workerDone, &workerLock );
+        pthread_mutex_unlock( &workerLock );
+    }
+
+    runningChannels = false;
+}
+
+bool NVMain::ResponseBefore( const ChannelResponse& a, const ChannelResponse& b )
+{
+    return a.cycle < b.cycle;
+}
+
+void NVMain::DeliverResponses( )
+{
+    std::vector<ChannelResponse> responses;
+    std::vector<ChannelResponse>::iterator it;
+
+    /* Channel order breaks ties, since the sort is stable. */
+    for( unsigned int i = 0; i < numChannels; i++ )
+    {
+        responses.insert( responses.end( ), channelResponses[i].begin( ), channelResponses[i].end( ) );
+        channelResponses[i].clear( );
+    }
+
+    std::stable_sort( responses.begin( ), responses.end( ), &NVMain::ResponseBefore );
+
+    for( it = responses.begin( ); it != responses.end( ); it++ )
+        RequestComplete( it->request );
+}
+
+/* 
+ *  Epochs fall on multiples of the lookahead, at the first one not before
+ *  the earliest pending channel event. Buffered responses need an epoch
+ *  even if the channels are otherwise idle.
+ */
+void NVMain::ScheduleEpoch( )
+{
+    ncycle_t now = GetEventQueue( )->GetCurrentCycle( );
+    ncycle_t when = std::numeric_limits<ncycle_t>::max( );
+
+    for( unsigned int i = 0; i < numChannels; i++ )
+    {
+        when = std::min( when, channelQueues[i]->GetNextEvent( ) );
+
+        if( !channelResponses[i].empty( ) )
+            when = std::min( when, now + 1 );
+    }
+
+    if( when == std::numeric_limits<ncycle_t>::max( ) )
+        return;
+
+    if( when <= now )
+        when = now + 1;
+
+    ncycle_t epoch = ((when + lookahead - 1) / lookahead) * lookahead;
+
+    if( epoch >= nextEpoch )
+        return;
+
+    GetEventQueue( )->RemoveEvent( epochEvent );
+
+    nextEpoch = epoch;
+    epochEvent = GetEventQueue( )->InsertCallback( this, 
+                     (CallbackPtr)&NVMain::EpochCallback, nextEpoch );
+}
+
+void NVMain::EpochCallback( void * /*data*/ )
+{
+    nextEpoch = std::numeric_limits<ncycle_t>::max( );
+    epochEvent = EventHandle( );
+
+    SyncChannels( GetEventQueue( )->GetCurrentCycle( ) );
+    DeliverResponses( );
+    ScheduleEpoch( );
+}
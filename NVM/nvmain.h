@@ -40,9 +40,12 @@
 #include "src/Params.h"
 #include "src/NVMObject.h"
 #include "src/Prefetcher.h"
+#include "src/EventQueue.h"
 #include "include/NVMainRequest.h"
 #include "traceWriter/GenericTraceWriter.h"
 #include <queue>
+#include <vector>
+#include <pthread.h>
 
 namespace NVM {
 
@@ -64,22 +67,29 @@ class NVMain : public NVMObject
 
     Config *GetConfig( );
 
-    void IssuePrefetch( NVMainRequest *request );
+    void IssuePrefetch( NVMainRequest *request, bool atomic = false );
     bool IssueCommand( NVMainRequest *request );
     bool IssueAtomic( NVMainRequest *request );
     bool IsIssuable( NVMainRequest *request, FailReason *reason );
+    ncycle_t NextIssuable( NVMainRequest *request );
 
     bool RequestComplete( NVMainRequest *request );
 
-    bool CheckPrefetch( NVMainRequest *request );
+    bool CheckPrefetch( NVMainRequest *request, bool atomic = false );
 
     void RegisterStats( );
     void CalculateStats( );
 
     void Cycle( ncycle_t steps );
+    bool Drain( );
+
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
 
     void EnqueuePendingMemoryRequests( NVMainRequest *request );
 
+    void EpochCallback( void *data );
+
   private:
     Config *config;
     Config **channelConfig;
@@ -102,7 +112,56 @@ class NVMain : public NVMObject
     GenericTraceWriter *preTracer;
 
     void PrintPreTrace( NVMainRequest *request );
-    void GeneratePrefetches( NVMainRequest *request, std::vector<NVMAddress>& prefetchList );
+    void GeneratePrefetches( NVMainRequest *request, std::vector<NVMAddress>& prefetchList,
+                             bool atomic );
+    void BufferPrefetch( NVMainRequest *request );
+
+    /* 
+     *  ParallelChannels: each channel runs on its own event queue and the
+     *  channels are caught up together by worker threads once per epoch.
+     *  Responses are buffered per channel and passed up at the epoch
+     *  boundary in (cycle, channel) order, so results do not depend on
+     *  thread scheduling.
+     */
+    struct ChannelResponse
+    {
+        ncycle_t cycle;
+        NVMainRequest *request;
+    };
+
+    struct ChannelWorker
+    {
+        NVMain *nvmain;
+        ncounter_t id;
+        pthread_t thread;
+    };
+
+    bool parallelChannels;
+    EventQueue **channelQueues;
+    std::vector<ChannelResponse> *channelResponses;
+    bool runningChannels;
+    ncycle_t lookahead;
+    ncycle_t nextEpoch;
+    EventHandle epochEvent;
+
+    ncounter_t numWorkers;
+    ChannelWorker *workers;
+    pthread_mutex_t workerLock;
+    pthread_cond_t workerStart;
+    pthread_cond_t workerDone;
+    ncounter_t epochCount;
+    ncounter_t workersBusy;
+    ncycle_t epochTarget;
+    bool workersExit;
+
+    void SetupParallelChannels( );
+    void SyncChannel( ncounter_t channel, ncycle_t target );
+    void SyncChannels( ncycle_t target );
+    void RunChannels( ncounter_t worker, ncycle_t target );
+    void DeliverResponses( );
+    static bool ResponseBefore( const ChannelResponse& a, const ChannelResponse& b );
+    void ScheduleEpoch( );
+    static void *WorkerThread( void *arg );
 };
 
 };
@@ -35,6 +35,7 @@
 
 #include "Ranks/StandardRank/StandardRank.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 #include "Banks/BankFactory.h"
 
 #include <iostream>
@@ -823,6 +824,11 @@ bool StandardRank::IssueCommand( NVMainRequest *req )
     return rv;
 }
 
+bool StandardRank::IssueAtomic( NVMainRequest *req )
+{
+    return GetChild( req )->IssueAtomic( req );
+}
+
 /* 
  *  Other ranks should notify us when they read/write so we can ensure minimum 
  *  timings are met.
@@ -951,20 +957,36 @@ void StandardRank::CalculateStats( )
     totalPower = backgroundPower = activatePower = burstPower = refreshPower = 0.0;
     reads = writes = 0;
 
+    if( bankStatHandles.empty( ) )
+    {
+        for( ncounter_t i = 0; i < bankCount; i++ )
+        {
+            bankStatHandles.push_back( GetStatHandle( GetChild(i), "bankEnergy" ) );
+            bankStatHandles.push_back( GetStatHandle( GetChild(i), "activeEnergy" ) );
+            bankStatHandles.push_back( GetStatHandle( GetChild(i), "burstEnergy" ) );
+            bankStatHandles.push_back( GetStatHandle( GetChild(i), "refreshEnergy" ) );
+            bankStatHandles.push_back( GetStatHandle( GetChild(i), "reads" ) );
+            bankStatHandles.push_back( GetStatHandle( GetChild(i), "writes" ) );
+        }
+    }
+
+    /* The handles are in the order they were looked up above. */
+    std::vector<StatHandle>::iterator handle = bankStatHandles.begin( );
+
     for( ncounter_t i = 0; i < bankCount; i++ )
     {
-        StatType bankEstat = GetStat( GetChild(i), "bankEnergy" );
-        StatType actEstat =  GetStat( GetChild(i), "activeEnergy" );
-        StatType bstEstat =  GetStat( GetChild(i), "burstEnergy" );
-        StatType refEstat =  GetStat( GetChild(i), "refreshEnergy" );
+        StatType bankEstat = GetStats( )->getStat( *handle++ );
+        StatType actEstat =  GetStats( )->getStat( *handle++ );
+        StatType bstEstat =  GetStats( )->getStat( *handle++ );
+        StatType refEstat =  GetStats( )->getStat( *handle++ );
 
         totalEnergy += CastStat( bankEstat, double );
         activateEnergy += CastStat( actEstat, double );
         burstEnergy += CastStat( bstEstat, double );
         refreshEnergy += CastStat( refEstat, double );
 
-        StatType readCount = GetStat( GetChild(i), "reads" );
-        StatType writeCount = GetStat( GetChild(i), "writes" );
+        StatType readCount = GetStats( )->getStat( *handle++ );
+        StatType writeCount = GetStats( )->getStat( *handle++ );
 
         reads += CastStat( readCount, ncounter_t );
         writes += CastStat( writeCount, ncounter_t );
@@ -1030,3 +1052,44 @@ void StandardRank::ResetStats( )
     lastReset = GetEventQueue()->GetCurrentCycle();
 }
 
+void StandardRank::CreateCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( cpt.Create( Checkpoint::File( dir, StatName( ) ) ) )
+    {
+        cpt.Write( state );
+        cpt.WriteArray( lastActivate, rawNum );
+        cpt.Write( RAWindex );
+        cpt.Write( nextRead );
+        cpt.Write( nextWrite );
+        cpt.Write( nextActivate );
+        cpt.Write( nextPrecharge );
+        cpt.Write( lastReset );
+
+        cpt.Close( );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void StandardRank::RestoreCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( cpt.Open( Checkpoint::File( dir, StatName( ) ) ) )
+    {
+        cpt.Read( state );
+        cpt.ReadArray( lastActivate, rawNum );
+        cpt.Read( RAWindex );
+        cpt.Read( nextRead );
+        cpt.Read( nextWrite );
+        cpt.Read( nextActivate );
+        cpt.Read( nextPrecharge );
+        cpt.Read( lastReset );
+
+        cpt.Close( );
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
+}
@@ -41,6 +41,7 @@
 
 #include <cstdint>
 #include <list>
+#include <vector>
 #include <iostream>
 
 namespace NVM {
@@ -79,6 +80,7 @@ class StandardRank : public Rank
 
     bool IssueCommand( NVMainRequest *request );
     bool IsIssuable( NVMainRequest *request, FailReason *reason = NULL );
+    bool IssueAtomic( NVMainRequest *request );
     void Notify( NVMainRequest *request );
     bool RequestComplete( NVMainRequest* );
     ncycle_t NextIssuable( NVMainRequest *request );
@@ -93,6 +95,9 @@ class StandardRank : public Rank
     void CalculateStats( );
     void ResetStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   protected:
     Config *conf;
     ncounter_t stateTimeout;
@@ -135,6 +140,9 @@ class StandardRank : public Rank
     double totalEnergy, backgroundEnergy, activateEnergy, burstEnergy, refreshEnergy;
     double totalPower, backgroundPower, activatePower, burstPower, refreshPower;
 
+    /* Bank stats summed by CalculateStats, looked up on its first call. */
+    std::vector<StatHandle> bankStatHandles;
+
     bool Activate( NVMainRequest *request );
     bool Read( NVMainRequest *request );
     bool Write( NVMainRequest *request );
@@ -0,0 +1,129 @@
+#!/usr/bin/python
+
+#
+# Compare simulation time of the event queue backends (EventQueueBackend
+# config key) on the shipped configurations. Each configuration is run once
+# per backend with the same trace and the statistics are checked to be
+# identical, since the backend must not change event ordering.
+#
+# Example (from the NVMain root directory):
+#
+#   ./Scripts/EventQueueBenchmark.py -t /path/to/trace.nvt -r 3
+#
+
+
+from optparse import OptionParser
+import subprocess
+import sys
+import os
+import time
+
+
+parser = OptionParser()
+parser.add_option("-t", "--trace", type="string", help="NVMain trace file to simulate.")
+parser.add_option("-b", "--build", type="string", help="NVMain standalone build to test (e.g., fast, prof, debug)", default="fast")
+parser.add_option("-c", "--configs", type="string", help="Comma separated list of configuration files to run.", default="")
+parser.add_option("-n", "--cycles", type="string", help="Number of cycles to simulate (0 = entire trace).", default="0")
+parser.add_option("-r", "--repeat", type="int", help="Number of times to run each configuration.", default=1)
+parser.add_option("-k", "--buckets", type="string", help="CalendarBuckets value for the calendar backend.", default="4096")
+parser.add_option("-o", "--overrides", type="string", help="Extra PARAM=value overrides passed to every run.", default="IgnoreData=true")
+
+(options, args) = parser.parse_args()
+
+
+nvmain_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+nvmainexec = os.path.join(nvmain_root, "nvmain." + options.build)
+
+if not os.path.isfile(nvmainexec) or not os.access(nvmainexec, os.X_OK):
+    print("Could not find Nvmain executable: '%s'" % nvmainexec)
+    print("Exiting...")
+    sys.exit(1)
+
+if not options.trace or not os.path.isfile(options.trace):
+    print("A trace file must be specified with --trace.")
+    sys.exit(1)
+
+
+#
+# Configurations which run standalone. Per-channel and off-chip memory
+# configurations are included by these and are not run on their own.
+#
+shipped_configs = [
+    "2D_DRAM_example.config",
+    "3D_DRAM_example.config",
+    "3D_DRAMCache_example.config",
+    "3D_PredictorDRC_example.config",
+    "3D_VariableDRC_example.config",
+    "Hybrid_example.config",
+    "PCM_ISSCC_2012_4GB.config",
+    "PCM_MLC_example.config",
+    "RRAM_ISSCC_2012_4GB.config",
+    "STTRAM_Everspin_4GB.config"
+]
+
+if options.configs != "":
+    configs = options.configs.split(",")
+else:
+    configs = [os.path.join(nvmain_root, "Config", c) for c in shipped_configs]
+
+backends = [
+    ("Map", ["EventQueueBackend=Map"]),
+    ("Calendar", ["EventQueueBackend=Calendar", "CalendarBuckets=" + options.buckets])
+]
+
+
+def run_nvmain(config, backend_overrides):
+    command = [nvmainexec, config, options.trace, options.cycles]
+    command.extend(options.overrides.split())
+    command.extend(backend_overrides)
+
+    start = time.time()
+    proc = subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    output = proc.communicate()[0].decode("utf-8", "replace")
+    elapsed = time.time() - start
+
+    # Only the statistics are compared; they are prefixed with the interval.
+    stats = [line for line in output.splitlines() if line.startswith("i") and line[1:2].isdigit()]
+
+    return proc.returncode, elapsed, stats
+
+
+print("%-32s %12s %12s %9s %s" % ("Config", "Map (s)", "Calendar (s)", "Speedup", "Stats"))
+
+failed = False
+
+for config in configs:
+    times = {}
+    stats = {}
+    rc = 0
+
+    for name, overrides in backends:
+        best = None
+
+        for i in range(options.repeat):
+            rc, elapsed, stats[name] = run_nvmain(config, overrides)
+
+            if rc != 0:
+                break
+
+            if best is None or elapsed < best:
+                best = elapsed
+
+        times[name] = best
+
+        if rc != 0:
+            break
+
+    if rc != 0:
+        print("%-32s failed with return code %d" % (os.path.basename(config), rc))
+        failed = True
+        continue
+
+    match = "same" if stats["Map"] == stats["Calendar"] else "DIFFERENT"
+    if match != "same":
+        failed = True
+
+    print("%-32s %12.3f %12.3f %8.2fx %s" % (os.path.basename(config), times["Map"], times["Calendar"],
+                                           times["Map"] / times["Calendar"], match))
+
+sys.exit(1 if failed else 0)
@@ -0,0 +1,177 @@
+#!/usr/bin/python
+
+#
+# Read NVMain stats written with StatsFormat Text, JSON, CSV or Binary and
+# print the selected stats of each interval, or import read_stats() to get
+# them as a list of (interval, {name: value}, {name: units}) tuples. The
+# format is detected from the file contents. Histograms from JSON and binary
+# stats are dicts of their bucket starts, counts, overflowStart and overflow.
+# CSV stats have them as four columns of the same names.
+#
+# Example (from the NVMain root directory):
+#
+#   ./Scripts/StatsReader.py -f run.stats -s averageLatency,totalReadRequests
+#
+
+
+from optparse import OptionParser
+import csv
+import json
+import struct
+import sys
+
+
+# StatValueType in src/Stats.h; the struct format of each numeric column.
+binary_formats = ["i", "f", "d", "Q", "q"]
+binary_string_type = 5
+binary_histogram_type = 7
+
+
+def read_text(handle):
+    intervals = {}
+
+    for line in handle:
+        tags = line.split('.', 1)
+        if len(tags) < 2 or tags[0][0:1] != 'i' or not tags[0][1:].isdigit():
+            continue
+
+        fields = tags[1].rstrip('\n').split(' ', 1)
+        value = fields[1] if len(fields) > 1 else ""
+        intervals.setdefault(int(tags[0][1:]), {})[fields[0]] = value
+
+    # Text stats have their units appended to the value.
+    return [(interval, stats, {}) for interval, stats in sorted(intervals.items())]
+
+
+def read_json(handle):
+    result = []
+
+    for line in handle:
+        if line.strip() == "":
+            continue
+
+        block = json.loads(line)
+        result.append((block["interval"], block["stats"], block.get("units", {})))
+
+    return result
+
+
+def read_csv(handle):
+    result = []
+    header = None
+
+    for row in csv.reader(handle):
+        if len(row) == 0:
+            continue
+
+        if row[0] == "interval":
+            header = row
+            continue
+
+        result.append((int(row[0]), dict(zip(header[1:], row[1:])), {}))
+
+    return result
+
+
+def read_binary(data):
+    result = []
+    schema = []
+    offset = 0
+
+    def read_string(offset):
+        length = struct.unpack_from("=I", data, offset)[0]
+        offset += 4
+        return data[offset:offset + length].decode("utf-8", "replace"), offset + length
+
+    # Same layout as histograms in JSON stats.
+    def read_histogram(offset):
+        buckets = struct.unpack_from("=I", data, offset)[0]
+        offset += 4
+        starts = list(struct.unpack_from("=%dd" % buckets, data, offset))
+        offset += 8 * buckets
+        counts = list(struct.unpack_from("=%dQ" % buckets, data, offset))
+        offset += 8 * buckets
+        overflow_start, overflow = struct.unpack_from("=dQ", data, offset)
+        histogram = {"starts": starts, "counts": counts,
+                     "overflowStart": overflow_start, "overflow": overflow}
+        return histogram, offset + 16
+
+    while offset < len(data):
+        magic, version, flags, reserved, interval, count = struct.unpack_from("=4sIIIQQ", data, offset)
+        offset += 32
+
+        if magic != b"NVMS" or version not in (1, 2):
+            raise ValueError("Not an NVMain binary stats block at offset %d" % (offset - 32))
+
+        # Blocks without a schema have the stats of the block before.
+        if flags & 1:
+            schema = []
+        for i in range(count if flags & 1 else 0):
+            stat_type = struct.unpack_from("=B", data, offset)[0]
+            name, offset = read_string(offset + 1)
+            units, offset = read_string(offset)
+            schema.append((stat_type, name, units))
+
+        # Values are stored in schema order, one column per type.
+        stats = {}
+        units = {}
+        for stat_type, name, unit in schema:
+            if stat_type == binary_string_type:
+                stats[name], offset = read_string(offset)
+            elif stat_type == binary_histogram_type:
+                stats[name], offset = read_histogram(offset)
+            else:
+                value_format = "=" + binary_formats[stat_type]
+                stats[name] = struct.unpack_from(value_format, data, offset)[0]
+                offset += struct.calcsize(value_format)
+
+            if unit != "":
+                units[name] = unit
+
+        result.append((interval, stats, units))
+
+    return result
+
+
+def read_stats(filename):
+    with open(filename, "rb") as handle:
+        data = handle.read()
+
+    if data[0:4] == b"NVMS":
+        return read_binary(data)
+
+    text = data.decode("utf-8", "replace").splitlines(True)
+    first = next((line for line in text if line.strip() != ""), "")
+
+    if first.startswith("{"):
+        return read_json(text)
+    elif first.startswith("interval,"):
+        return read_csv(text)
+
+    return read_text(text)
+
+
+if __name__ == "__main__":
+    parser = OptionParser()
+    parser.add_option("-f", "--file", type="string", help="NVMain stats file to read.")
+    parser.add_option("-s", "--stats", type="string", default="",
+                      help="Comma separated stat names or name suffixes to print (default all).")
+    parser.add_option("-i", "--interval", type="int", default=-1, help="Interval to print (default all).")
+
+    (options, args) = parser.parse_args()
+
+    if not options.file:
+        print("A stats file must be specified with --file.")
+        sys.exit(1)
+
+    selected = [s for s in options.stats.split(",") if s != ""]
+
+    for interval, stats, units in read_stats(options.file):
+        if options.interval != -1 and interval != options.interval:
+            continue
+
+        for name, value in stats.items():
+            if selected and not any(name == s or name.endswith("." + s) for s in selected):
+                continue
+
+            print("i%d.%s %s%s" % (interval, name, value, units.get(name, "")))
@@ -0,0 +1,132 @@
+#!/usr/bin/python
+
+#
+# Convert an NVMain text trace (NVMV0 or NVMV1) to the binary trace format
+# read by the NVMainBinaryTrace trace reader. The layout is described in
+# traceReader/NVMainBinaryTrace/NVMainBinaryTraceFormat.h. Fields are
+# written in the byte order of this machine.
+#
+# Example (from the NVMain root directory):
+#
+#   ./Scripts/TraceToBinary.py -i trace.nvt -o trace.nvb
+#
+# Traces used only with IgnoreData=true can drop the data payloads with -n,
+# which shrinks each record from 152 to 24 bytes.
+#
+
+
+from optparse import OptionParser
+import struct
+import sys
+
+
+parser = OptionParser()
+parser.add_option("-i", "--input", type="string", help="NVMain text trace to convert.")
+parser.add_option("-o", "--output", type="string", help="Binary trace file to write.")
+parser.add_option("-n", "--no-data", action="store_true", dest="nodata", default=False,
+                  help="Do not store data or old data payloads.")
+
+(options, args) = parser.parse_args()
+
+if not options.input or not options.output:
+    print("Both an input (-i) and output (-o) trace must be specified.")
+    sys.exit(1)
+
+
+NVMB_VERSION = 1
+NVMB_HAS_DATA = 0x1
+NVMB_HAS_OLDDATA = 0x2
+
+# magic, version, flags, dataSize, recordSize, reserved, recordCount
+header_format = "=4sIIIIIQ"
+# cycle, address, threadId, operation, reserved
+record_format = "=QQIB3x"
+
+record_size = struct.calcsize(record_format)
+
+
+def parse_line(line, version):
+    fields = line.split()
+
+    if len(fields) < 3:
+        return None
+
+    cycle = int(fields[0])
+    operation = 1 if fields[1] == "W" else 0
+    address = int(fields[2], 16)
+    data = None
+    old_data = None
+    thread_id = 0
+
+    # NVMV0 lines: CYCLE OP ADDRESS DATA THREADID
+    # NVMV1 lines: CYCLE OP ADDRESS DATA OLDDATA THREADID
+    if len(fields) > 3:
+        data = bytes.fromhex(fields[3])
+
+    if version == 0:
+        if len(fields) > 4:
+            thread_id = int(fields[4])
+    else:
+        if len(fields) > 4:
+            old_data = bytes.fromhex(fields[4])
+        if len(fields) > 5:
+            thread_id = int(fields[5])
+
+    return cycle, operation, address, data, old_data, thread_id
+
+
+infile = open(options.input, "r")
+outfile = open(options.output, "wb")
+
+version = 0
+first = infile.readline()
+
+if first.startswith("NVMV"):
+    version = int(first[4:].strip())
+    lines = infile
+else:
+    lines = [first]
+    lines.extend(infile)
+
+flags = 0
+data_size = 0
+count = 0
+payload_size = 0
+
+for line in lines:
+    parsed = parse_line(line, version)
+
+    if parsed is None:
+        continue
+
+    cycle, operation, address, data, old_data, thread_id = parsed
+
+    # The first record decides which payloads the trace carries. The text
+    # reader zeroes old data for NVMV0 traces, so it is stored as zeros.
+    if count == 0:
+        if not options.nodata and data is not None:
+            flags = NVMB_HAS_DATA | NVMB_HAS_OLDDATA
+            data_size = len(data)
+            payload_size = 2 * data_size
+
+        outfile.write(struct.pack(header_format, b"NVMB", NVMB_VERSION, flags,
+                                  data_size, record_size + payload_size, 0, 0))
+
+    outfile.write(struct.pack(record_format, cycle, address, thread_id, operation))
+
+    if flags & NVMB_HAS_DATA:
+        for payload in (data, old_data):
+            payload = (payload or b"")[:data_size]
+            outfile.write(payload + b"\0" * (data_size - len(payload)))
+
+    count += 1
+
+if count == 0:
+    outfile.write(struct.pack(header_format, b"NVMB", NVMB_VERSION, 0, 0, record_size, 0, 0))
+
+# Fill in the record count now that it is known.
+outfile.seek(struct.calcsize("=4sIIIII"))
+outfile.write(struct.pack("=Q", count))
+outfile.close()
+
+print("Wrote %d records to %s" % (count, options.output))
@@ -0,0 +1,164 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "StatsWriters/BinaryStats/BinaryStatsWriter.h"
+
+#include <cstring>
+#include <string>
+
+using namespace NVM;
+
+static void WriteBinaryString( std::ostream& stream, const std::string& text )
+{
+    uint32_t length = static_cast<uint32_t>( text.size( ) );
+
+    stream.write( reinterpret_cast<const char *>( &length ), sizeof(length) );
+    stream.write( text.data( ), length );
+}
+
+static void WriteBinaryHistogram( std::ostream& stream, Histogram& histogram )
+{
+    ncounter_t overflow = histogram.GetOverflowBucket( );
+    ncounter_t bucket;
+    uint32_t bucketCount = 0;
+    double start;
+    uint64_t count;
+
+    for( bucket = 0; bucket < overflow; bucket++ )
+    {
+        if( histogram.GetBucketSamples( bucket ) != 0 )
+            bucketCount++;
+    }
+
+    stream.write( reinterpret_cast<const char *>( &bucketCount ), sizeof(bucketCount) );
+
+    for( bucket = 0; bucket < overflow; bucket++ )
+    {
+        if( histogram.GetBucketSamples( bucket ) == 0 )
+            continue;
+
+        start = histogram.GetBucketStart( bucket );
+        stream.write( reinterpret_cast<const char *>( &start ), sizeof(start) );
+    }
+
+    for( bucket = 0; bucket < overflow; bucket++ )
+    {
+        if( histogram.GetBucketSamples( bucket ) == 0 )
+            continue;
+
+        count = histogram.GetBucketSamples( bucket );
+        stream.write( reinterpret_cast<const char *>( &count ), sizeof(count) );
+    }
+
+    start = histogram.GetBucketStart( overflow );
+    count = histogram.GetBucketSamples( overflow );
+    stream.write( reinterpret_cast<const char *>( &start ), sizeof(start) );
+    stream.write( reinterpret_cast<const char *>( &count ), sizeof(count) );
+}
+
+BinaryStatsWriter::BinaryStatsWriter( )
+{
+
+}
+
+BinaryStatsWriter::~BinaryStatsWriter( )
+{
+
+}
+
+void BinaryStatsWriter::Write( std::ostream& stream, std::vector<StatBase *>& statList, 
+                               ncounter_t psInterval )
+{
+    NVMStatsBlockHeader header;
+    std::vector<const std::string *> blockSchema;
+    std::vector<StatBase *>::iterator it;
+
+    for( int type = 0; type <= STAT_TYPE_HISTOGRAM; type++ )
+        typeColumns[type].clear( );
+
+    for( it = statList.begin(); it != statList.end(); it++ )
+    {
+        if( (*it) == NULL || (*it)->GetValueType( ) == STAT_TYPE_UNKNOWN )
+            continue;
+
+        typeColumns[(*it)->GetValueType( )].push_back( (*it) );
+    }
+
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, NVMS_MAGIC, sizeof(header.magic) );
+    header.version = NVMS_VERSION;
+    header.interval = psInterval;
+
+    for( int type = 0; type <= STAT_TYPE_HISTOGRAM; type++ )
+    {
+        for( it = typeColumns[type].begin(); it != typeColumns[type].end(); it++ )
+            blockSchema.push_back( &((*it)->GetName( )) );
+    }
+
+    header.statCount = blockSchema.size( );
+
+    if( blockSchema != schema )
+    {
+        header.flags |= NVMS_HAS_SCHEMA;
+        schema.swap( blockSchema );
+    }
+
+    stream.write( reinterpret_cast<const char *>( &header ), sizeof(header) );
+
+    /* The schema is in column order, so stat n of the schema is value n. */
+    for( int type = 0; (header.flags & NVMS_HAS_SCHEMA) && type <= STAT_TYPE_HISTOGRAM; type++ )
+    {
+        uint8_t typeTag = static_cast<uint8_t>( type );
+
+        for( it = typeColumns[type].begin(); it != typeColumns[type].end(); it++ )
+        {
+            stream.write( reinterpret_cast<const char *>( &typeTag ), sizeof(typeTag) );
+            WriteBinaryString( stream, (*it)->GetName( ) );
+            WriteBinaryString( stream, (*it)->GetUnits( ) );
+        }
+    }
+
+    for( int type = 0; type <= STAT_TYPE_HISTOGRAM; type++ )
+    {
+        for( it = typeColumns[type].begin(); it != typeColumns[type].end(); it++ )
+        {
+            if( type == STAT_TYPE_STRING )
+                WriteBinaryString( stream, (*it)->GetText( ) );
+            else if( type == STAT_TYPE_HISTOGRAM )
+                WriteBinaryHistogram( stream, *(static_cast<Histogram *>((*it)->GetValue( ))) );
+            else
+                stream.write( static_cast<const char *>( (*it)->GetValue( ) ), 
+                              (*it)->GetTypeSize( ) );
+        }
+    }
+}
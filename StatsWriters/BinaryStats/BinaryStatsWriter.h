@@ -0,0 +1,100 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __STATSWRITERS_BINARYSTATSWRITER_H__
+#define __STATSWRITERS_BINARYSTATSWRITER_H__
+
+#include "src/StatsWriter.h"
+
+#include <stdint.h>
+
+namespace NVM {
+
+/*
+ *  NVMain binary stats (NVMS) layout. Each interval is a block: an
+ *  NVMStatsBlockHeader, then the schema if NVMS_HAS_SCHEMA is set and then
+ *  the columns. A block without a schema has the stats of the block before.
+ *
+ *  The schema has one entry per stat: a uint8_t StatValueType, then the 
+ *  name and the units, each as a uint32_t length followed by its bytes.
+ *
+ *  The columns follow in StatValueType order. Each column holds the values
+ *  of the stats of its type in schema order: int32_t, float, double,
+ *  uint64_t and int64_t values as raw bytes, and strings as a uint32_t
+ *  length followed by the bytes. A reader can load a numeric column as an 
+ *  array without parsing. Histograms come last, each as a uint32_t count
+ *  of its non-empty buckets, the double starts and uint64_t counts of
+ *  those buckets, then the double start and uint64_t count of its overflow
+ *  bucket. Stats of STAT_TYPE_UNKNOWN are not written.
+ *
+ *  Fields are in the byte order of the machine that wrote the file.
+ */
+#define NVMS_MAGIC "NVMS"
+
+const uint32_t NVMS_VERSION = 2;
+
+const uint32_t NVMS_HAS_SCHEMA = 0x1;
+
+struct NVMStatsBlockHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t interval;
+    uint64_t statCount;
+};
+
+static_assert( sizeof(NVMStatsBlockHeader) == 32, "NVMS block header must be 32 bytes" );
+
+class BinaryStatsWriter : public StatsWriter
+{
+  public:
+    BinaryStatsWriter( );
+    ~BinaryStatsWriter( );
+
+    void Write( std::ostream& stream, std::vector<StatBase *>& statList, 
+                ncounter_t psInterval );
+
+    bool IsPlainText( ) { return false; }
+
+  private:
+    std::vector<StatBase *> typeColumns[STAT_TYPE_HISTOGRAM + 1];
+
+    /* Interned names of the stats in the last schema written. */
+    std::vector<const std::string *> schema;
+};
+
+};
+
+#endif
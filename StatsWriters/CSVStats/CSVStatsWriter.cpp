@@ -0,0 +1,168 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "StatsWriters/CSVStats/CSVStatsWriter.h"
+
+#include <limits>
+
+using namespace NVM;
+
+static void WriteCSVString( std::ostream& stream, const std::string& text )
+{
+    stream << '"';
+
+    for( size_t i = 0; i < text.size( ); i++ )
+    {
+        if( text[i] == '"' )
+            stream << '"';
+        stream << text[i];
+    }
+
+    stream << '"';
+}
+
+/*
+ *  A histogram has four columns: the starts and the counts of its non-empty
+ *  buckets as space-separated lists, the start of the overflow bucket and
+ *  the count of the values at or past it.
+ */
+static const char *histogramColumns[] = { ".starts", ".counts", ".overflowStart", ".overflow" };
+
+static void WriteCSVHistogram( std::ostream& stream, Histogram& histogram )
+{
+    ncounter_t overflow = histogram.GetOverflowBucket( );
+    ncounter_t bucket;
+    bool first = true;
+
+    for( bucket = 0; bucket < overflow; bucket++ )
+    {
+        if( histogram.GetBucketSamples( bucket ) == 0 )
+            continue;
+
+        if( !first )
+            stream << ' ';
+        first = false;
+
+        stream << histogram.GetBucketStart( bucket );
+    }
+
+    stream << ',';
+    first = true;
+
+    for( bucket = 0; bucket < overflow; bucket++ )
+    {
+        if( histogram.GetBucketSamples( bucket ) == 0 )
+            continue;
+
+        if( !first )
+            stream << ' ';
+        first = false;
+
+        stream << histogram.GetBucketSamples( bucket );
+    }
+
+    stream << ',' << histogram.GetBucketStart( overflow ) 
+           << ',' << histogram.GetBucketSamples( overflow );
+}
+
+CSVStatsWriter::CSVStatsWriter( )
+{
+
+}
+
+CSVStatsWriter::~CSVStatsWriter( )
+{
+
+}
+
+void CSVStatsWriter::Write( std::ostream& stream, std::vector<StatBase *>& statList, 
+                            ncounter_t psInterval )
+{
+    std::vector<const std::string *> statColumns;
+    std::vector<StatBase *>::iterator it;
+
+    for( it = statList.begin(); it != statList.end(); it++ )
+    {
+        if( (*it) != NULL && (*it)->GetValueType( ) != STAT_TYPE_UNKNOWN )
+            statColumns.push_back( &((*it)->GetName( )) );
+    }
+
+    if( statColumns != columns )
+    {
+        columns.swap( statColumns );
+
+        stream << "interval";
+        for( it = statList.begin(); it != statList.end(); it++ )
+        {
+            if( (*it) == NULL || (*it)->GetValueType( ) == STAT_TYPE_UNKNOWN )
+                continue;
+
+            if( (*it)->GetValueType( ) == STAT_TYPE_HISTOGRAM )
+            {
+                for( size_t colIdx = 0; colIdx < 4; colIdx++ )
+                {
+                    stream << ',';
+                    WriteCSVString( stream, (*it)->GetName( ) + histogramColumns[colIdx] );
+                }
+            }
+            else
+            {
+                stream << ',';
+                WriteCSVString( stream, (*it)->GetName( ) );
+            }
+        }
+        stream << '\n';
+    }
+
+    std::streamsize precision = stream.precision( std::numeric_limits<double>::max_digits10 );
+
+    stream << psInterval;
+
+    for( it = statList.begin(); it != statList.end(); it++ )
+    {
+        if( (*it) == NULL || (*it)->GetValueType( ) == STAT_TYPE_UNKNOWN )
+            continue;
+
+        stream << ',';
+
+        if( (*it)->GetValueType( ) == STAT_TYPE_STRING )
+            WriteCSVString( stream, (*it)->GetText( ) );
+        else if( (*it)->GetValueType( ) == STAT_TYPE_HISTOGRAM )
+            WriteCSVHistogram( stream, *(static_cast<Histogram *>((*it)->GetValue( ))) );
+        else
+            (*it)->PrintValue( stream );
+    }
+
+    stream << '\n';
+    stream.precision( precision );
+}
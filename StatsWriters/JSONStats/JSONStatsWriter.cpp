@@ -0,0 +1,185 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "StatsWriters/JSONStats/JSONStatsWriter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+using namespace NVM;
+
+static void WriteJSONString( std::ostream& stream, const std::string& text )
+{
+    stream << '"';
+
+    for( size_t i = 0; i < text.size( ); i++ )
+    {
+        unsigned char c = static_cast<unsigned char>( text[i] );
+
+        if( c == '"' ) stream << "\\\"";
+        else if( c == '\\' ) stream << "\\\\";
+        else if( c == '\n' ) stream << "\\n";
+        else if( c == '\t' ) stream << "\\t";
+        else if( c < 0x20 )
+        {
+            char escaped[8];
+
+            snprintf( escaped, sizeof(escaped), "\\u%04x", c );
+            stream << escaped;
+        }
+        else stream << text[i];
+    }
+
+    stream << '"';
+}
+
+template<typename T>
+static void WriteJSONNumber( std::ostream& stream, T value )
+{
+    if( !std::isfinite( value ) )
+    {
+        stream << "null";
+        return;
+    }
+
+    std::streamsize precision = stream.precision( std::numeric_limits<T>::max_digits10 );
+
+    stream << value;
+    stream.precision( precision );
+}
+
+/* 
+ *  The non-empty buckets as arrays of bucket starts and counts, and the 
+ *  count of the values at or past overflowStart. 
+ */
+static void WriteJSONHistogram( std::ostream& stream, Histogram& histogram )
+{
+    ncounter_t overflow = histogram.GetOverflowBucket( );
+    ncounter_t bucket;
+    bool first = true;
+
+    stream << "{\"starts\":[";
+    for( bucket = 0; bucket < overflow; bucket++ )
+    {
+        if( histogram.GetBucketSamples( bucket ) == 0 )
+            continue;
+
+        if( !first )
+            stream << ',';
+        first = false;
+
+        WriteJSONNumber( stream, histogram.GetBucketStart( bucket ) );
+    }
+
+    stream << "],\"counts\":[";
+    first = true;
+    for( bucket = 0; bucket < overflow; bucket++ )
+    {
+        if( histogram.GetBucketSamples( bucket ) == 0 )
+            continue;
+
+        if( !first )
+            stream << ',';
+        first = false;
+
+        stream << histogram.GetBucketSamples( bucket );
+    }
+
+    stream << "],\"overflowStart\":";
+    WriteJSONNumber( stream, histogram.GetBucketStart( overflow ) );
+    stream << ",\"overflow\":" << histogram.GetBucketSamples( overflow ) << "}";
+}
+
+JSONStatsWriter::JSONStatsWriter( )
+{
+
+}
+
+JSONStatsWriter::~JSONStatsWriter( )
+{
+
+}
+
+void JSONStatsWriter::Write( std::ostream& stream, std::vector<StatBase *>& statList, 
+                             ncounter_t psInterval )
+{
+    std::vector<StatBase *>::iterator it;
+    bool first = true;
+
+    stream << "{\"interval\":" << psInterval << ",\"stats\":{";
+
+    for( it = statList.begin(); it != statList.end(); it++ )
+    {
+        if( (*it) == NULL || (*it)->GetValueType( ) == STAT_TYPE_UNKNOWN )
+            continue;
+
+        if( !first )
+            stream << ',';
+        first = false;
+
+        WriteJSONString( stream, (*it)->GetName( ) );
+        stream << ':';
+
+        switch( (*it)->GetValueType( ) )
+        {
+            case STAT_TYPE_INT: stream << *(static_cast<int *>((*it)->GetValue( ))); break;
+            case STAT_TYPE_FLOAT: WriteJSONNumber( stream, *(static_cast<float *>((*it)->GetValue( ))) ); break;
+            case STAT_TYPE_DOUBLE: WriteJSONNumber( stream, *(static_cast<double *>((*it)->GetValue( ))) ); break;
+            case STAT_TYPE_UINT64: stream << *(static_cast<uint64_t *>((*it)->GetValue( ))); break;
+            case STAT_TYPE_INT64: stream << *(static_cast<int64_t *>((*it)->GetValue( ))); break;
+            case STAT_TYPE_HISTOGRAM: WriteJSONHistogram( stream, *(static_cast<Histogram *>((*it)->GetValue( ))) ); break;
+            default: WriteJSONString( stream, (*it)->GetText( ) ); break;
+        }
+    }
+
+    stream << "},\"units\":{";
+    first = true;
+
+    for( it = statList.begin(); it != statList.end(); it++ )
+    {
+        if( (*it) == NULL || (*it)->GetValueType( ) == STAT_TYPE_UNKNOWN 
+            || (*it)->GetUnits( ).empty( ) )
+            continue;
+
+        if( !first )
+            stream << ',';
+        first = false;
+
+        WriteJSONString( stream, (*it)->GetName( ) );
+        stream << ':';
+        WriteJSONString( stream, (*it)->GetUnits( ) );
+    }
+
+    stream << "}}\n";
+}
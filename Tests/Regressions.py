@@ -63,6 +63,17 @@ json_data = open('Tests.json')
 testdata = json.load(json_data)
 
 
+#
+# Remove the files and directories a test lists under "cleanup".
+#
+def cleanup(test):
+    for path in test.get("cleanup", []):
+        if os.path.isdir(path):
+            shutil.rmtree(path)
+        elif os.path.exists(path):
+            os.remove(path)
+
+
 #
 # Run all tests with each trace
 #
@@ -72,24 +83,59 @@ for trace in testdata["traces"]:
     for idx, test in enumerate(testdata["tests"]):
         faillog = testdata["tests"][idx]["name"] + ".out"
 
+        # Tests with their own trace only run once, not once per trace
+        testtrace = trace
+        if "trace" in testdata["tests"][idx]:
+            if trace != testdata["traces"][0]:
+                continue
+            testtrace = testdata["tests"][idx]["trace"]
+
         # Reset log each time for correct stat comparison
         testlog = open(options.tempfile, 'w')
 
-        command = [nvmainexec, testdata["tests"][idx]["config"], trace, testdata["tests"][idx]["cycles"]]
-        command.extend(testdata["tests"][idx]["overrides"].split(" "))
-        sys.stdout.write("Testing " + testdata["tests"][idx]["name"] + " with " + trace + " ... ")
+        command = [nvmainexec, testdata["tests"][idx]["config"], testtrace, testdata["tests"][idx]["cycles"]]
+        sys.stdout.write("Testing " + testdata["tests"][idx]["name"] + " with " + testtrace + " ... ")
         sys.stdout.flush()
 
+        # Tests that need state from an earlier run (e.g., a checkpoint) 
+        # make it first with the "setup" overrides.
+        if "setup" in testdata["tests"][idx]:
+            try:
+                subprocess.check_call(command + testdata["tests"][idx]["setup"].split(" "), 
+                                      stdout=testlog, stderr=subprocess.STDOUT)
+            except subprocess.CalledProcessError as e:
+                print("[Failed setup RC=%u]" % e.returncode)
+                testlog.close()
+                shutil.copyfile(options.tempfile, faillog)
+                cleanup(testdata["tests"][idx])
+                continue
+
+            # Only the test run itself is checked.
+            testlog.seek(0)
+            testlog.truncate()
+
+        command.extend(testdata["tests"][idx]["overrides"].split(" "))
+
         try:
             subprocess.check_call(command, stdout=testlog, stderr=subprocess.STDOUT)
         except subprocess.CalledProcessError as e:
             expectedrc = testdata["tests"][idx]["returncode"]
             if e.returncode != expectedrc:
                 print("[Failed RC=%u]" % e.returncode)
+                testlog.close()
                 shutil.copyfile(options.tempfile, faillog)
+                cleanup(testdata["tests"][idx])
                 continue
 
+        # Output of a "postrun" script (e.g., reading back a stats file) is 
+        # checked along with the simulator output.
+        if "postrun" in testdata["tests"][idx]:
+            testlog.flush()
+            postrun = [sys.executable] + testdata["tests"][idx]["postrun"].split(" ")
+            subprocess.call(postrun, stdout=testlog, stderr=subprocess.STDOUT)
+
         testlog.close()
+        cleanup(testdata["tests"][idx])
 
         checkcount = 0
         checkcounter = 0
@@ -53,6 +53,9 @@ VariablePredictor::VariablePredictor( )
     accuracy = 0.95;
 
     seed = 1;
+
+    truePredictions = 0;
+    falsePredictions = 0;
 }
 
 
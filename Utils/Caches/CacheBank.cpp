@@ -34,6 +34,7 @@
 #include "Utils/Caches/CacheBank.h"
 #include "include/NVMHelpers.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 
 #include <iostream>
 #include <cassert>
@@ -499,3 +500,64 @@ bool CacheBank::RequestComplete( NVMainRequest *req )
 void CacheBank::Cycle( ncycle_t /*steps*/ )
 {
 }
+
+/* Entries are saved in place so that the replacement order is kept. */
+void CacheBank::WriteCheckpoint( Checkpoint& cpt )
+{
+    for( uint64_t r = 0; r < numRows; r++ )
+    {
+        for( uint64_t i = 0; i < numSets; i++ )
+        {
+            for( uint64_t j = 0; j < numAssoc; j++ )
+            {
+                CacheEntry& entry = cacheEntry[r][i][j];
+
+                cpt.Write( entry.flags );
+                cpt.Write( entry.address );
+                cpt.Write( entry.data.IsValid( ) );
+                cpt.Write( entry.data.GetSize( ) );
+
+                for( uint64_t byte = 0; byte < entry.data.GetSize( ); byte++ )
+                    cpt.Write( entry.data.GetByte( byte ) );
+            }
+        }
+    }
+}
+
+void CacheBank::ReadCheckpoint( Checkpoint& cpt )
+{
+    for( uint64_t r = 0; r < numRows && cpt.Good( ); r++ )
+    {
+        for( uint64_t i = 0; i < numSets && cpt.Good( ); i++ )
+        {
+            for( uint64_t j = 0; j < numAssoc && cpt.Good( ); j++ )
+            {
+                CacheEntry& entry = cacheEntry[r][i][j];
+                NVMDataBlock data;
+                bool valid = false;
+                uint64_t size = 0;
+
+                cpt.Read( entry.flags );
+                cpt.Read( entry.address );
+                cpt.Read( valid );
+                cpt.Read( size );
+
+                if( size > 0 && cpt.Good( ) )
+                {
+                    data.SetSize( size );
+
+                    for( uint64_t byte = 0; byte < size; byte++ )
+                    {
+                        uint8_t value = 0;
+
+                        cpt.Read( value );
+                        data.SetByte( byte, value );
+                    }
+                }
+
+                data.SetValid( valid );
+                entry.data = data;
+            }
+        }
+    }
+}
@@ -42,6 +42,8 @@
 
 namespace NVM {
 
+class Checkpoint;
+
 typedef uint64_t (NVMObject::*CacheSetDecoder)(NVMAddress&);
 
 enum CacheState { CACHE_IDLE, CACHE_BUSY };
@@ -118,6 +120,10 @@ class CacheBank : public NVMObject
 
     void SetDecodeFunction( NVMObject *dcClass, CacheSetDecoder dcFunc );
 
+    /* Saved in the checkpoint file of the controller owning the cache. */
+    void WriteCheckpoint( Checkpoint& cpt );
+    void ReadCheckpoint( Checkpoint& cpt );
+
     uint64_t numRows, numSets, numAssoc, cachelineSize;
     CacheEntry ***cacheEntry;
     uint64_t accessTime, stateTimer;
@@ -0,0 +1,167 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "Utils/Caches/FilterCache.h"
+#include "Utils/Caches/CacheBank.h"
+#include "include/NVMHelpers.h"
+
+#include <cassert>
+
+using namespace NVM;
+
+/* The line number sits above the flag bits of a tag word. */
+static const uint64_t filterFlagBits = 2;
+
+FilterCache::FilterCache( uint64_t sets, uint64_t assoc, uint64_t lineSize )
+{
+    assert( sets > 0 && assoc > 0 );
+    assert( lineSize > 0 && (lineSize & (lineSize - 1)) == 0 );
+
+    numSets = sets;
+    numAssoc = assoc;
+    cachelineSize = lineSize;
+
+    lineShift = mlog2( static_cast<int>( lineSize ) );
+
+    /* Power of two set counts are indexed with a mask instead of a divide. */
+    maskSets = ((sets & (sets - 1)) == 0);
+    setMask = sets - 1;
+
+    tags.assign( sets * assoc, CACHE_ENTRY_NONE );
+
+    reads = 0;
+    writes = 0;
+    hits = 0;
+    misses = 0;
+    writebacks = 0;
+    hitRate = 0.0;
+
+    StatName( "llc" );
+}
+
+FilterCache::~FilterCache( )
+{
+
+}
+
+void FilterCache::RegisterStats( )
+{
+    AddStat(reads);
+    AddStat(writes);
+    AddStat(hits);
+    AddStat(misses);
+    AddStat(writebacks);
+    AddStat(hitRate);
+}
+
+void FilterCache::CalculateStats( )
+{
+    if( hits + misses > 0 )
+        hitRate = static_cast<double>( hits ) / static_cast<double>( hits + misses );
+}
+
+bool FilterCache::Access( uint64_t address, bool write, bool *writeback, uint64_t *victim )
+{
+    uint64_t lineNumber = address >> lineShift;
+    uint64_t setID = maskSets ? (lineNumber & setMask) : (lineNumber % numSets);
+    uint64_t *set = &tags[setID * numAssoc];
+    uint64_t tag = (lineNumber << filterFlagBits) | CACHE_ENTRY_VALID;
+    uint64_t way;
+    bool hit = false;
+
+    *writeback = false;
+
+    if( write )
+        writes++;
+    else
+        reads++;
+
+    for( way = 0; way < numAssoc; way++ )
+    {
+        if( (set[way] & ~static_cast<uint64_t>( CACHE_ENTRY_DIRTY )) == tag )
+        {
+            hit = true;
+            tag = set[way];
+            break;
+        }
+    }
+
+    if( hit )
+    {
+        hits++;
+    }
+    else
+    {
+        /* Replace the LRU way, which is the last one (or an invalid one). */
+        misses++;
+        way = numAssoc - 1;
+
+        if( (set[way] & CACHE_ENTRY_VALID) && (set[way] & CACHE_ENTRY_DIRTY) )
+        {
+            *writeback = true;
+            *victim = (set[way] >> filterFlagBits) << lineShift;
+            writebacks++;
+        }
+    }
+
+    if( write )
+        tag |= CACHE_ENTRY_DIRTY;
+
+    /* Move the line to the MRU position. */
+    for( ; way > 0; way-- )
+        set[way] = set[way - 1];
+
+    set[0] = tag;
+
+    return hit;
+}
+
+uint64_t FilterCache::GetLineAddress( uint64_t address )
+{
+    return (address >> lineShift) << lineShift;
+}
+
+uint64_t FilterCache::GetSetCount( )
+{
+    return numSets;
+}
+
+uint64_t FilterCache::GetAssociativity( )
+{
+    return numAssoc;
+}
+
+uint64_t FilterCache::GetCachelineSize( )
+{
+    return cachelineSize;
+}
@@ -0,0 +1,91 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_UTILS_CACHES_FILTERCACHE_H__
+#define __NVMAIN_UTILS_CACHES_FILTERCACHE_H__
+
+#include "src/NVMObject.h"
+
+#include <vector>
+
+namespace NVM {
+
+/*
+ *  A tag-only, set-associative, writeback and write-allocate cache used
+ *  to filter CPU accesses before they reach memory. Unlike CacheBank it
+ *  keeps no data or NVMAddress per line: each way is a single word in one
+ *  flat array holding the line number and the CACHE_ENTRY_* flags, and the
+ *  ways of a set are contiguous and kept in LRU order (MRU first), so a
+ *  lookup touches one or two host cache lines.
+ */
+class FilterCache : public NVMObject
+{
+  public:
+    FilterCache( uint64_t sets, uint64_t assoc, uint64_t lineSize );
+    ~FilterCache( );
+
+    void RegisterStats( );
+    void CalculateStats( );
+
+    void Cycle( ncycle_t ) { }
+
+    /* 
+     *  Return true on a hit. On a miss the line is installed, and if a
+     *  dirty line was evicted to make room its address is put in *victim
+     *  and *writeback is set.
+     */
+    bool Access( uint64_t address, bool write, bool *writeback, uint64_t *victim );
+
+    uint64_t GetLineAddress( uint64_t address );
+
+    uint64_t GetSetCount( );
+    uint64_t GetAssociativity( );
+    uint64_t GetCachelineSize( );
+
+  private:
+    uint64_t numSets, numAssoc, cachelineSize;
+    uint64_t lineShift, setMask;
+    bool maskSets;
+    std::vector<uint64_t> tags;
+
+    ncounter_t reads;
+    ncounter_t writes;
+    ncounter_t hits;
+    ncounter_t misses;
+    ncounter_t writebacks;
+    double hitRate;
+};
+
+};
+
+#endif
@@ -36,6 +36,7 @@
 #include "NVM/nvmain.h"
 #include "src/SubArray.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 #include "include/NVMHelpers.h"
 
 using namespace NVM;
@@ -391,7 +392,6 @@ void CoinMigrator::ChooseVictim( Migrator *at, NVMAddress& /*promotee*/, NVMAddr
         promotionChannelParams = p;
 
         totalPromotionPages = p->RANKS * p->BANKS * p->ROWS;
-        currentPromotionPage = 0;
 
         if( p->COLS != numCols )
         {
@@ -433,3 +433,37 @@ void CoinMigrator::Cycle( ncycle_t /*steps*/ )
 
 }
 
+
+void CoinMigrator::CreateCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( promoBuffered || demoBuffered )
+    {
+        std::cout << "CoinMigrator: Warning: The migration in progress is not "
+            << "saved in the checkpoint." << std::endl;
+    }
+
+    /* The coin toss seed is saved so the restored run makes the same choices. */
+    if( cpt.Create( Checkpoint::File( dir, StatName( ) ) ) )
+    {
+        cpt.Write( seed );
+        cpt.Write( currentPromotionPage );
+
+        cpt.Close( );
+    }
+}
+
+
+void CoinMigrator::RestoreCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( cpt.Open( Checkpoint::File( dir, StatName( ) ) ) )
+    {
+        cpt.Read( seed );
+        cpt.Read( currentPromotionPage );
+
+        cpt.Close( );
+    }
+}
@@ -59,6 +59,9 @@ class CoinMigrator : public NVMObject
 
     void Cycle( ncycle_t steps );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   private:
     bool promoBuffered, demoBuffered; 
     NVMAddress demotee, promotee; 
@@ -80,6 +80,9 @@ class AddressTranslator
     virtual uint64_t Translate( NVMainRequest *request );
     virtual void SetDefaultField( TranslationField f ); 
 
+    /* Called once for each request the memory system accepts. */
+    virtual void RequestIssued( NVMainRequest * /*request*/ ) { }
+
     void SetStats( Stats *stats );
     Stats *GetStats( );
 
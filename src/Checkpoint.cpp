@@ -0,0 +1,160 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/Checkpoint.h"
+
+#include <iostream>
+
+
+using namespace NVM;
+
+
+Checkpoint::Checkpoint( )
+{
+
+}
+
+Checkpoint::~Checkpoint( )
+{
+    Close( );
+}
+
+std::string Checkpoint::File( std::string dir, std::string name )
+{
+    return dir + "/" + name;
+}
+
+bool Checkpoint::Create( std::string file )
+{
+    Close( );
+
+    fileName = file;
+    stream.open( file.c_str( ), std::fstream::out | std::fstream::trunc | std::fstream::binary );
+
+    if( !stream.is_open( ) )
+    {
+        std::cout << "NVMain: Warning: Could not open checkpoint file: " 
+                  << file << std::endl;
+        return false;
+    }
+
+    Write( checkpointMagic );
+    Write( checkpointVersion );
+
+    return true;
+}
+
+bool Checkpoint::Open( std::string file )
+{
+    uint32_t magic = 0, version = 0;
+
+    Close( );
+
+    fileName = file;
+    stream.open( file.c_str( ), std::fstream::in | std::fstream::binary );
+
+    if( !stream.is_open( ) )
+    {
+        std::cout << "NVMain: Warning: Could not open checkpoint file: " 
+                  << file << std::endl;
+        return false;
+    }
+
+    Read( magic );
+    Read( version );
+
+    if( !Good( ) || magic != checkpointMagic )
+    {
+        std::cout << "NVMain: Warning: " << file << " is not a checkpoint file."
+                  << std::endl;
+        stream.close( );
+        return false;
+    }
+
+    if( version != checkpointVersion )
+    {
+        std::cout << "NVMain: Warning: " << file << " is a version " << version
+                  << " checkpoint. Only version " << checkpointVersion 
+                  << " can be restored." << std::endl;
+        stream.close( );
+        return false;
+    }
+
+    return true;
+}
+
+bool Checkpoint::Close( )
+{
+    bool rv = true;
+
+    if( stream.is_open( ) )
+    {
+        rv = stream.good( );
+        stream.close( );
+
+        if( !rv )
+        {
+            std::cout << "NVMain: Warning: Checkpoint file " << fileName 
+                      << " is truncated or could not be written." << std::endl;
+        }
+    }
+
+    return rv;
+}
+
+bool Checkpoint::Good( )
+{
+    return stream.is_open( ) && stream.good( );
+}
+
+void Checkpoint::WriteString( const std::string& value )
+{
+    Write( static_cast<uint64_t>( value.size( ) ) );
+    stream.write( value.data( ), value.size( ) );
+}
+
+void Checkpoint::ReadString( std::string& value )
+{
+    uint64_t size = 0;
+
+    Read( size );
+    value.clear( );
+
+    if( !Good( ) )
+        return;
+
+    value.resize( size );
+
+    if( size > 0 )
+        stream.read( &value[0], size );
+}
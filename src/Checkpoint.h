@@ -0,0 +1,175 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAIN_CHECKPOINT_H__
+#define __NVMAIN_CHECKPOINT_H__
+
+
+#include <deque>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <stdint.h>
+
+
+namespace NVM {
+
+/*
+ *  Bumped whenever the state saved by any object changes, so that an old
+ *  checkpoint is rejected instead of being restored into the wrong fields.
+ */
+const uint32_t checkpointMagic = 0x4E564D43;
+const uint32_t checkpointVersion = 4;
+
+/*
+ *  Binary file holding the checkpointed state of one object. The file starts
+ *  with checkpointMagic and checkpointVersion. Values are written in host
+ *  byte order, so checkpoints only move between hosts of the same kind.
+ */
+class Checkpoint
+{
+  public:
+    Checkpoint( );
+    ~Checkpoint( );
+
+    static std::string File( std::string dir, std::string name );
+
+    bool Create( std::string file );
+    bool Open( std::string file );
+    /* Warns and returns false if a read ran past the end or a write failed. */
+    bool Close( );
+
+    /* False once a read ran past the end of the file or a write failed. */
+    bool Good( );
+
+    template<typename T> void Write( const T& value )
+    {
+        stream.write( reinterpret_cast<const char *>(&value), sizeof(T) );
+    }
+
+    template<typename T> void Read( T& value )
+    {
+        stream.read( reinterpret_cast<char *>(&value), sizeof(T) );
+    }
+
+    template<typename T> void WriteArray( const T *values, uint64_t count )
+    {
+        stream.write( reinterpret_cast<const char *>(values), sizeof(T) * count );
+    }
+
+    template<typename T> void ReadArray( T *values, uint64_t count )
+    {
+        stream.read( reinterpret_cast<char *>(values), sizeof(T) * count );
+    }
+
+    void WriteString( const std::string& value );
+    void ReadString( std::string& value );
+
+    /* Containers are written as their size followed by the elements. */
+    template<typename C> void WriteSequence( const C& values )
+    {
+        Write( static_cast<uint64_t>( values.size( ) ) );
+
+        for( typename C::const_iterator it = values.begin( ); it != values.end( ); ++it )
+            Write( *it );
+    }
+
+    template<typename T> void ReadSequence( std::deque<T>& values )
+    {
+        uint64_t count = 0;
+        T value;
+
+        Read( count );
+        values.clear( );
+
+        for( uint64_t i = 0; i < count && Good( ); i++ )
+        {
+            Read( value );
+            values.push_back( value );
+        }
+    }
+
+    template<typename T> void ReadSequence( std::set<T>& values )
+    {
+        uint64_t count = 0;
+        T value;
+
+        Read( count );
+        values.clear( );
+
+        for( uint64_t i = 0; i < count && Good( ); i++ )
+        {
+            Read( value );
+            values.insert( value );
+        }
+    }
+
+    template<typename K, typename V> void WriteMap( const std::map<K, V>& values )
+    {
+        Write( static_cast<uint64_t>( values.size( ) ) );
+
+        for( typename std::map<K, V>::const_iterator it = values.begin( ); 
+             it != values.end( ); ++it )
+        {
+            Write( it->first );
+            Write( it->second );
+        }
+    }
+
+    template<typename K, typename V> void ReadMap( std::map<K, V>& values )
+    {
+        uint64_t count = 0;
+        K key;
+        V value;
+
+        Read( count );
+        values.clear( );
+
+        for( uint64_t i = 0; i < count && Good( ); i++ )
+        {
+            Read( key );
+            Read( value );
+            values.insert( values.end( ), std::make_pair( key, value ) );
+        }
+    }
+
+  private:
+    std::fstream stream;
+    std::string fileName;
+};
+
+};
+
+
+#endif
@@ -47,6 +47,7 @@ Config::Config( )
 {
     simPtr = NULL;
     useDebugLog = false;
+    warnUnset = true;
 }
 
 
@@ -66,6 +67,7 @@ Config::Config(const Config& conf)
 
     fileName = conf.fileName;
     simPtr = conf.simPtr;
+    warnUnset = conf.warnUnset;
 
     std::vector<std::string> tmpVec(conf.hookList);
     std::vector<std::string>::iterator vit;
@@ -197,7 +199,7 @@ bool Config::KeyExists( std::string key )
 
 void Config::GetString( std::string key, std::string& value )
 {
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( !KeyExists( key ) && warnUnset && !warned.count( key ) )
     {   
         std::cout << "Config: Warning: Key " << key << " is not set. Using '" << value 
                   << "' as the default. Please configure this value if this is wrong." << std::endl;
@@ -223,7 +225,7 @@ std::string Config::GetString( std::string key )
 
     i = values.find( key );
 
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( !KeyExists( key ) && warnUnset && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
@@ -253,7 +255,7 @@ void Config::SetString( std::string key, std::string value )
 
 void Config::GetValueUL( std::string key, uint64_t& value )
 {
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( !KeyExists( key ) && warnUnset && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '" << value
                   << "' as the default. Please configure this value if this is wrong." << std::endl;
@@ -278,7 +280,7 @@ uint64_t Config::GetValueUL( std::string key )
 
     i = values.find( key );
 
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( !KeyExists( key ) && warnUnset && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '-1' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
@@ -301,7 +303,7 @@ uint64_t Config::GetValueUL( std::string key )
 
 void Config::GetValue( std::string key, int& value )
 {
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( !KeyExists( key ) && warnUnset && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '" << value
                   << "' as the default. Please configure this value if this is wrong." << std::endl;
@@ -326,7 +328,7 @@ int Config::GetValue( std::string key )
 
     i = values.find( key );
 
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( !KeyExists( key ) && warnUnset && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '-1' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
@@ -361,7 +363,7 @@ void Config::SetValue( std::string key, std::string value )
 
 void Config::GetEnergy( std::string key, double& value )
 {
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( !KeyExists( key ) && warnUnset && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '" << value
                   << "' as the default. Please configure this value if this is wrong." << std::endl;
@@ -386,7 +388,7 @@ double Config::GetEnergy( std::string key )
 
     i = values.find( key );
 
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( !KeyExists( key ) && warnUnset && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using '-1.0' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
@@ -414,7 +416,7 @@ void Config::SetEnergy( std::string key, std::string energy )
 
 void Config::GetBool( std::string key, bool& value )
 {
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( !KeyExists( key ) && warnUnset && !warned.count( key ) )
     {
         std::string defaultValue = (value ? "true" : "false");
         std::cout << "Config: Warning: Key " << key << " is not set. Using '" << defaultValue
@@ -431,7 +433,7 @@ bool Config::GetBool( std::string key )
 {
     bool rv = false;
 
-    if( !KeyExists( key ) && !warned.count( key ) )
+    if( !KeyExists( key ) && warnUnset && !warned.count( key ) )
     {
         std::cout << "Config: Warning: Key " << key << " is not set. Using 'false' as the default. Please configure this value if this is wrong." << std::endl;
         warned.insert( key );
@@ -477,6 +479,16 @@ SimInterface *Config::GetSimInterface( )
     return simPtr;
 }
 
+/* 
+ *  Whether getters print a warning the first time an unset key is read. A
+ *  partial config, e.g., one only holding overrides, would warn for every
+ *  key it does not have.
+ */
+void Config::SetWarnings( bool warn )
+{
+    warnUnset = warn;
+}
+
 void Config::SetDebugLog( )
 {
     if( this->KeyExists( "DebugLog" ) )
@@ -77,6 +77,8 @@ class Config
 
     std::vector<std::string>& GetHooks( );
 
+    void SetWarnings( bool warn );
+
     void Print( );
 
     /*
@@ -97,6 +99,7 @@ class Config
     SimInterface *simPtr;
     std::ofstream debugLogFile;
     bool useDebugLog;
+    bool warnUnset;
 
 };
 
@@ -65,6 +65,18 @@ ncycle_t DataEncoder::Write( NVMainRequest* /*request*/ )
 }
 
 
+void DataEncoder::WriteCheckpoint( Checkpoint& /*cpt*/ )
+{
+
+}
+
+
+void DataEncoder::ReadCheckpoint( Checkpoint& /*cpt*/ )
+{
+
+}
+
+
 void DataEncoder::Cycle( ncycle_t /*steps*/ )
 {
 
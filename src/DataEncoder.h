@@ -43,6 +43,7 @@ namespace NVM {
 
 class Config;
 class NVMainRequest;
+class Checkpoint;
 
 class DataEncoder : public NVMObject
 {
@@ -57,6 +58,10 @@ class DataEncoder : public NVMObject
 
     virtual void PrintStats( ) { }
 
+    /* Saved in the checkpoint file of the sub-array owning the encoder. */
+    virtual void WriteCheckpoint( Checkpoint& cpt );
+    virtual void ReadCheckpoint( Checkpoint& cpt );
+
     virtual void Cycle( ncycle_t steps );
 
 };
@@ -34,6 +34,7 @@
 #include "src/EnduranceModel.h"
 #include "Endurance/EnduranceDistributionFactory.h"
 #include "src/FaultModel.h"
+#include "src/Checkpoint.h"
 #include <iostream>
 #include <limits>
 
@@ -144,6 +145,16 @@ uint64_t EnduranceModel::GetGranularity( )
 }
 
 
+void EnduranceModel::WriteCheckpoint( Checkpoint& cpt )
+{
+    cpt.WriteMap( life );
+}
+
+void EnduranceModel::ReadCheckpoint( Checkpoint& cpt )
+{
+    cpt.ReadMap( life );
+}
+
 void EnduranceModel::Cycle( ncycle_t )
 {
 }
@@ -48,6 +48,7 @@
 namespace NVM {
 
 class FaultModel;
+class Checkpoint;
 
 class EnduranceModel : public NVMObject
 {
@@ -67,6 +68,10 @@ class EnduranceModel : public NVMObject
 
     virtual void PrintStats( ) { }
 
+    /* Saved in the checkpoint file of the sub-array owning the model. */
+    virtual void WriteCheckpoint( Checkpoint& cpt );
+    virtual void ReadCheckpoint( Checkpoint& cpt );
+
     void Cycle( ncycle_t steps );
 
   protected:
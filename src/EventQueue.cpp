@@ -34,96 +34,473 @@
 #include "src/EventQueue.h"
 #include "src/NVMObject.h"
 #include "src/Config.h"
+#include "src/StatSampler.h"
 #include "NVM/nvmain.h"
 
+#include <algorithm>
 #include <limits>
 #include <assert.h>
 
 using namespace NVM;
 
+/* Number of events allocated at once when the event pool is empty. */
+const ncounter_t eventSlabSize = 1024;
+
+/* Initial number of FindEvent index buckets (power of two). */
+const ncounter_t eventIndexSize = 1024;
+
 void Event::SetRecipient( NVMObject *r )
 {
-    std::vector<NVMObject_hook *>& children = r->GetParent( )->GetTrampoline( )->GetChildren( );
-    std::vector<NVMObject_hook *>::iterator it;
-    NVMObject_hook *hook = NULL;
+    recipient = r->GetSelfHook( );
+}
 
-    for( it = children.begin(); it != children.end(); it++ )
+void EventList::Insert( Event *event, int priority )
+{
+    Event *prev = NULL;
+    Event *cur = head;
+
+    /* Place the event after all events with a priority <= the given one. */
+    if( priority < maxPriority )
     {
-        if( (*it)->GetTrampoline() == r )
+        while( cur != NULL && cur->GetPriority( ) <= priority )
         {
-            hook = (*it);
-            break;
+            prev = cur;
+            cur = cur->GetNext( );
         }
     }
+    else
+    {
+        prev = tail;
+        cur = NULL;
+    }
+
+    event->SetNext( cur );
+
+    if( prev == NULL )
+        head = event;
+    else
+        prev->SetNext( event );
+
+    if( cur == NULL )
+        tail = event;
+
+    if( event->GetPriority( ) > maxPriority )
+        maxPriority = event->GetPriority( );
+}
+
+bool EventList::Remove( Event *event )
+{
+    Event *prev = NULL;
+    Event *cur = head;
+
+    while( cur != NULL && cur != event )
+    {
+        prev = cur;
+        cur = cur->GetNext( );
+    }
+
+    if( cur == NULL )
+        return false;
+
+    if( prev == NULL )
+        head = cur->GetNext( );
+    else
+        prev->SetNext( cur->GetNext( ) );
+
+    if( tail == cur )
+        tail = prev;
+
+    cur->SetNext( NULL );
+
+    return true;
+}
+
+Event *EventList::PopFront( )
+{
+    Event *event = head;
+
+    if( event != NULL )
+    {
+        head = event->GetNext( );
+
+        if( head == NULL )
+            tail = NULL;
+
+        event->SetNext( NULL );
+    }
+
+    return event;
+}
+
+void EventList::Swap( EventList& other )
+{
+    std::swap( head, other.head );
+    std::swap( tail, other.tail );
+    std::swap( maxPriority, other.maxPriority );
+}
+
+void EventList::Clear( )
+{
+    head = tail = NULL;
+    maxPriority = INT_MIN;
+}
+
+EventList& MapEventBackend::GetList( ncycle_t when )
+{
+    return eventMap[when];
+}
+
+const EventList *MapEventBackend::FindList( ncycle_t when ) const
+{
+    std::map<ncycle_t, EventList>::const_iterator it = eventMap.find( when );
+
+    return (it == eventMap.end( )) ? NULL : &(it->second);
+}
+
+void MapEventBackend::EraseList( ncycle_t when )
+{
+    eventMap.erase( when );
+}
+
+bool MapEventBackend::Empty( ) const
+{
+    return eventMap.empty( );
+}
+
+ncycle_t MapEventBackend::GetNextCycle( ) const
+{
+    if( eventMap.empty( ) )
+        return std::numeric_limits<ncycle_t>::max( );
+
+    /* map is sorted by keys, so this works out. */
+    return eventMap.begin( )->first;
+}
+
+CalendarEventBackend::CalendarEventBackend( ncounter_t buckets )
+{
+    /* Round up to a power of two (at least one occupancy word). */
+    bucketCount = 64;
+    while( bucketCount < buckets )
+        bucketCount <<= 1;
+
+    bucketMask = bucketCount - 1;
+    windowStart = 0;
+    usedBuckets = 0;
+
+    this->buckets.resize( bucketCount );
+    occupied.assign( bucketCount / 64, 0 );
+}
+
+bool CalendarEventBackend::InWindow( ncycle_t when ) const
+{
+    return (when >= windowStart && when - windowStart < bucketCount);
+}
+
+EventList& CalendarEventBackend::GetList( ncycle_t when )
+{
+    if( !InWindow( when ) )
+        return overflow[when];
+
+    ncycle_t bucket = when & bucketMask;
+
+    if( !(occupied[bucket / 64] & (1ULL << (bucket % 64))) )
+    {
+        occupied[bucket / 64] |= (1ULL << (bucket % 64));
+        usedBuckets++;
+    }
+
+    return buckets[bucket];
+}
+
+const EventList *CalendarEventBackend::FindList( ncycle_t when ) const
+{
+    if( !InWindow( when ) )
+    {
+        std::map<ncycle_t, EventList>::const_iterator it = overflow.find( when );
+
+        return (it == overflow.end( )) ? NULL : &(it->second);
+    }
+
+    ncycle_t bucket = when & bucketMask;
 
-    assert( hook != NULL );
+    if( !(occupied[bucket / 64] & (1ULL << (bucket % 64))) )
+        return NULL;
 
-    recipient = hook;
+    return &buckets[bucket];
+}
+
+void CalendarEventBackend::EraseList( ncycle_t when )
+{
+    if( !InWindow( when ) )
+    {
+        overflow.erase( when );
+        return;
+    }
+
+    ncycle_t bucket = when & bucketMask;
+
+    if( occupied[bucket / 64] & (1ULL << (bucket % 64)) )
+    {
+        occupied[bucket / 64] &= ~(1ULL << (bucket % 64));
+        usedBuckets--;
+        buckets[bucket].Clear( );
+    }
+}
+
+void CalendarEventBackend::Advance( ncycle_t when )
+{
+    /* 
+     *  Events are always processed in cycle order, so every bucket before
+     *  when is empty and can be reused for the cycles entering the window.
+     */
+    if( when <= windowStart )
+        return;
+
+    windowStart = when;
+
+    std::map<ncycle_t, EventList>::iterator it = overflow.lower_bound( when );
+
+    while( it != overflow.end( ) && InWindow( it->first ) )
+    {
+        ncycle_t bucket = it->first & bucketMask;
+
+        assert( buckets[bucket].Empty( ) );
+
+        buckets[bucket].Swap( it->second );
+        occupied[bucket / 64] |= (1ULL << (bucket % 64));
+        usedBuckets++;
+
+        overflow.erase( it++ );
+    }
+}
+
+bool CalendarEventBackend::Empty( ) const
+{
+    return (usedBuckets == 0 && overflow.empty( ));
+}
+
+ncycle_t CalendarEventBackend::GetNextCycle( ) const
+{
+    ncycle_t nextCycle = std::numeric_limits<ncycle_t>::max( );
+
+    /* Overflow may hold events before the window if they were late. */
+    if( !overflow.empty( ) )
+        nextCycle = overflow.begin( )->first;
+
+    if( usedBuckets == 0 || nextCycle < windowStart )
+        return nextCycle;
+
+    /* Scan the occupancy bitmap starting at the window start, wrapping once. */
+    ncycle_t start = windowStart & bucketMask;
+    ncounter_t words = bucketCount / 64;
+
+    for( ncounter_t i = 0; i <= words; i++ )
+    {
+        ncounter_t word = ((start / 64) + i) % words;
+        uint64_t bits = occupied[word];
+
+        /* Mask off buckets before the window start in the first word. */
+        if( i == 0 )
+            bits &= ~0ULL << (start % 64);
+
+        if( bits != 0 )
+        {
+            ncycle_t bucket = word * 64 + __builtin_ctzll( bits );
+            ncycle_t bucketCycle = windowStart + ((bucket - start) & bucketMask);
+
+            return (bucketCycle < nextCycle) ? bucketCycle : nextCycle;
+        }
+    }
+
+    return nextCycle;
 }
 
 EventQueue::EventQueue( )
 {
-    eventMap.clear( );
+    eventBackend = new MapEventBackend( );
+    freeEvents = NULL;
+    indexedEvents = 0;
+    eventIndex.assign( eventIndexSize, NULL );
     lastEventCycle = 0;
     nextEventCycle = std::numeric_limits<ncycle_t>::max();
     currentCycle = 0;
+    globalEventQueue = NULL;
+    clockDomain = 0;
+    syncedGlobalCycle = 0;
 }
 
 EventQueue::~EventQueue( )
 {
+    delete eventBackend;
+
+    /* Pending events are freed along with the slabs. */
+    std::vector<Event *>::iterator it;
+
+    for( it = eventSlabs.begin(); it != eventSlabs.end(); it++ )
+        delete [] (*it);
 }
 
-void EventQueue::InsertEvent( EventType type, NVMObject *recipient, ncycle_t when, void *data, int priority )
+Event *EventQueue::AllocateEvent( )
 {
-    /* The parent has our hook in the children list, we need to find this. */
-    std::vector<NVMObject_hook *>& children = recipient->GetParent( )->GetTrampoline( )->GetChildren( );
-    std::vector<NVMObject_hook *>::iterator it;
-    NVMObject_hook *hook = NULL;
-
-    for( it = children.begin(); it != children.end(); it++ )
+    /* Refill the free list with a new slab of events. */
+    if( freeEvents == NULL )
     {
-        if( (*it)->GetTrampoline() == recipient )
-        {
-            hook = (*it);
-            break;
-        }
+        Event *slab = new Event[eventSlabSize];
+
+        for( ncounter_t i = 0; i < eventSlabSize - 1; i++ )
+            slab[i].SetNext( &slab[i+1] );
+
+        freeEvents = slab;
+        eventSlabs.push_back( slab );
     }
 
-    assert( hook != NULL );
+    Event *event = freeEvents;
+    ncounter_t generation = event->GetGeneration( );
+    freeEvents = event->GetNext( );
 
-    InsertEvent( type, hook, NULL, when, data, priority );
+    /* Keep the generation so handles to the previous use stay stale. */
+    *event = Event( );
+    event->SetGeneration( generation );
+
+    return event;
+}
+
+void EventQueue::FreeEvent( Event *event )
+{
+    event->SetNext( freeEvents );
+    freeEvents = event;
 }
 
-void EventQueue::InsertEvent( EventType type, NVMObject_hook *recipient, ncycle_t when, void *data, int priority )
+ncounter_t EventQueue::IndexBucket( ncycle_t when, NVMObject *recipient, EventType type ) const
 {
-    InsertEvent( type, recipient, NULL, when, data, priority );
+    uint64_t key = when * 0x9E3779B97F4A7C15ULL;
+
+    key ^= reinterpret_cast<uintptr_t>( recipient ) + static_cast<uint64_t>( type );
+    key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 31;
+
+    return static_cast<ncounter_t>( key & (eventIndex.size( ) - 1) );
 }
 
-void EventQueue::InsertEvent( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when, void *data, int priority )
+void EventQueue::IndexEvent( Event *event )
 {
-    /* The parent has our hook in the children list, we need to find this. */
-    std::vector<NVMObject_hook *>& children = recipient->GetParent( )->GetTrampoline( )->GetChildren( );
-    std::vector<NVMObject_hook *>::iterator it;
-    NVMObject_hook *hook = NULL;
+    /* Keep the load factor at or below one. */
+    if( indexedEvents >= eventIndex.size( ) )
+        ResizeIndex( eventIndex.size( ) * 2 );
 
-    for( it = children.begin(); it != children.end(); it++ )
+    NVMObject *recipient = event->GetRecipient( )->GetTrampoline( );
+    ncounter_t bucket = IndexBucket( event->GetCycle( ), recipient, event->GetType( ) );
+
+    event->SetHashNext( eventIndex[bucket] );
+    eventIndex[bucket] = event;
+    indexedEvents++;
+}
+
+void EventQueue::UnindexEvent( Event *event )
+{
+    NVMObject *recipient = event->GetRecipient( )->GetTrampoline( );
+    ncounter_t bucket = IndexBucket( event->GetCycle( ), recipient, event->GetType( ) );
+    Event *prev = NULL;
+    Event *cur = eventIndex[bucket];
+
+    while( cur != NULL && cur != event )
     {
-        if( (*it)->GetTrampoline() == recipient )
+        prev = cur;
+        cur = cur->GetHashNext( );
+    }
+
+    assert( cur == event );
+
+    if( prev == NULL )
+        eventIndex[bucket] = event->GetHashNext( );
+    else
+        prev->SetHashNext( event->GetHashNext( ) );
+
+    event->SetHashNext( NULL );
+    indexedEvents--;
+}
+
+void EventQueue::ResizeIndex( ncounter_t buckets )
+{
+    std::vector<Event *> oldIndex( buckets, NULL );
+
+    oldIndex.swap( eventIndex );
+    indexedEvents = 0;
+
+    for( size_t i = 0; i < oldIndex.size( ); i++ )
+    {
+        Event *event = oldIndex[i];
+
+        while( event != NULL )
         {
-            hook = (*it);
-            break;
+            Event *nextEvent = event->GetHashNext( );
+
+            IndexEvent( event );
+            event = nextEvent;
         }
     }
+}
+
+void EventQueue::SetConfig( Config *conf )
+{
+    std::string backend = "Map";
+    ncounter_t buckets = 4096;
 
-    assert( hook != NULL );
+    if( conf->KeyExists( "EventQueueBackend" ) )
+        backend = conf->GetString( "EventQueueBackend" );
 
-    InsertEvent( type, hook, req, when, data, priority );
+    if( conf->KeyExists( "CalendarBuckets" ) )
+        buckets = static_cast<ncounter_t>( conf->GetValue( "CalendarBuckets" ) );
+
+    if( !eventBackend->Empty( ) )
+    {
+        std::cout << "NVMain: EventQueue: Events are pending, ignoring EventQueueBackend "
+                  << backend << "." << std::endl;
+        return;
+    }
+
+    if( backend == "Map" )
+    {
+        delete eventBackend;
+        eventBackend = new MapEventBackend( );
+    }
+    else if( backend == "Calendar" )
+    {
+        delete eventBackend;
+        eventBackend = new CalendarEventBackend( buckets );
+    }
+    else
+    {
+        std::cout << "NVMain: EventQueue: Unknown EventQueueBackend `" << backend 
+                  << "'. Using Map." << std::endl;
+    }
 }
 
-void EventQueue::InsertEvent( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when, void *data, int priority )
+EventHandle EventQueue::InsertEvent( EventType type, NVMObject *recipient, ncycle_t when, void *data, int priority )
+{
+    /* The parent has our hook in the children list. */
+    NVMObject_hook *hook = recipient->GetSelfHook( );
+
+    return InsertEvent( type, hook, NULL, when, data, priority );
+}
+
+EventHandle EventQueue::InsertEvent( EventType type, NVMObject_hook *recipient, ncycle_t when, void *data, int priority )
+{
+    return InsertEvent( type, recipient, NULL, when, data, priority );
+}
+
+EventHandle EventQueue::InsertEvent( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when, void *data, int priority )
+{
+    /* The parent has our hook in the children list. */
+    NVMObject_hook *hook = recipient->GetSelfHook( );
+
+    return InsertEvent( type, hook, req, when, data, priority );
+}
+
+EventHandle EventQueue::InsertEvent( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when, void *data, int priority )
 {
     /* Create our event */
-    Event *event = new Event( );
+    Event *event = AllocateEvent( );
 
     event->SetType( type );
     event->SetRecipient( recipient );
@@ -131,10 +508,10 @@ void EventQueue::InsertEvent( EventType type, NVMObject_hook *recipient, NVMainR
     event->SetCycle( when );
     event->SetData( data );
 
-    InsertEvent( event, when, priority );
+    return InsertEvent( event, when, priority );
 }
 
-void EventQueue::InsertEvent( Event *event, ncycle_t when, int priority )
+EventHandle EventQueue::InsertEvent( Event *event, ncycle_t when, int priority )
 {
     event->SetCycle( when );
 
@@ -142,47 +519,24 @@ void EventQueue::InsertEvent( Event *event, ncycle_t when, int priority )
     if( when < nextEventCycle )
     {
         nextEventCycle = when;
-    }
-
-    /* If there are no events at this time, create a new mapping. */ 
-    if( eventMap.count( when ) == 0 )
-    {
-        EventList eventList;
-
-        eventList.push_back( event );
 
-        eventMap.insert( std::pair<ncycle_t, EventList>( when, eventList ) );
+        if( globalEventQueue != NULL )
+            globalEventQueue->UpdateNextEvent( clockDomain );
     }
-    /* Otherwise append this event to the event list for this cycle. */
-    else
-    {
-        EventList& eventList = eventMap[when];
 
-        EventList::iterator it;
-        bool inserted = false;
+    /* Add the event to the list for this cycle in priority order. */ 
+    eventBackend->GetList( when ).Insert( event, priority );
 
-        for( it = eventList.begin(); it != eventList.end(); it++ )
-        {
-            if( (*it)->GetPriority( ) > priority )
-            {
-                eventList.insert( it, event );
-                inserted = true;
-                break;
-            }
-        }
+    IndexEvent( event );
 
-        if( !inserted )
-        {
-            eventList.push_back( event );
-        }
-    }
+    return EventHandle( event );
 }
 
 
-void EventQueue::InsertCallback( NVMObject *recipient, CallbackPtr method,
+EventHandle EventQueue::InsertCallback( NVMObject *recipient, CallbackPtr method,
                                  ncycle_t when, void *data, int priority )
 {
-    Event *event = new Event( );
+    Event *event = AllocateEvent( );
 
     event->SetType( EventCallback );
     event->SetRecipient( recipient );
@@ -191,70 +545,32 @@ void EventQueue::InsertCallback( NVMObject *recipient, CallbackPtr method,
     event->SetPriority( priority );
     event->SetCallback( method );
 
-    InsertEvent( event, when, priority );
+    return InsertEvent( event, when, priority );
 }
 
 
-bool EventQueue::RemoveEvent( Event *event, ncycle_t when )
+/*
+ *  Cancelled events are left in their list as tombstones and are freed when
+ *  their cycle is processed, so removal does not need to search the list.
+ */
+bool EventQueue::RemoveEvent( EventHandle handle )
 {
-    bool rv = false;
-
-    if( eventMap.count( when ) == 0 )
-    {
-        rv = false;
-    }
-    else
-    {
-        EventList& eventList = eventMap[when];
+    if( !handle.IsPending( ) )
+        return false;
 
-        EventList::iterator it;
-        for( it = eventList.begin(); it != eventList.end(); it++ )
-        {
-            if( (*it) == event )
-            {
-                eventList.erase( it );
-
-                rv = true;
+    Event *event = handle.GetEvent( );
 
-                /* If the list is empty now, we can also erase the map entry. */
-                if( eventList.empty() )
-                    eventMap.erase( when );
+    event->Cancel( );
+    UnindexEvent( event );
 
-                break;
-            }
-        }
-
-        if( eventMap.empty() )
-        {
-            nextEventCycle = std::numeric_limits<uint64_t>::max( );
-        }
-        else
-        {
-            nextEventCycle = eventMap.begin()->first;
-        }
-    }
-
-    return rv;
+    return true;
 }
 
 
 Event *EventQueue::FindEvent( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when ) const
 {
-    /* The parent has our hook in the children list, we need to find this. */
-    std::vector<NVMObject_hook *>& children = recipient->GetParent( )->GetTrampoline( )->GetChildren( );
-    std::vector<NVMObject_hook *>::iterator it;
-    NVMObject_hook *hook = NULL;
-
-    for( it = children.begin(); it != children.end(); it++ )
-    {
-        if( (*it)->GetTrampoline() == recipient )
-        {
-            hook = (*it);
-            break;
-        }
-    }
-
-    assert( hook != NULL );
+    /* The parent has our hook in the children list. */
+    NVMObject_hook *hook = recipient->GetSelfHook( );
 
     return FindEvent( type, hook, req, when );
 }
@@ -263,45 +579,37 @@ Event *EventQueue::FindEvent( EventType type, NVMObject *recipient, NVMainReques
 Event *EventQueue::FindEvent( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when ) const
 {
     Event *rv = NULL;
+    Event *it = eventIndex[IndexBucket( when, recipient->GetTrampoline( ), type )];
 
-    if (eventMap.count(when) == 0) {
-        return rv;
-    } else {
-        const EventList& eventList = eventMap.find(when)->second;
-
-        EventList::const_iterator it;
-        for( it = eventList.begin(); it != eventList.end(); it++ )
+    for( ; it != NULL; it = it->GetHashNext() )
+    {
+        if( it->GetCycle( ) == when && it->GetType( ) == type 
+            && it->GetRecipient( ) == recipient && it->GetRequest( ) == req )
         {
-            if( (*it)->GetType( ) == type && (*it)->GetRecipient( ) == recipient
-                && (*it)->GetRequest( ) == req )
-            {
-                rv = (*it);
-            }
+            rv = it;
+            break;
         }
-        return rv;
     }
+
+    return rv;
 }
 
 
 Event *EventQueue::FindCallback( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data, int priority ) const
 {
     Event *rv = NULL;
+    Event *it = eventIndex[IndexBucket( when, recipient, EventCallback )];
 
-    if( eventMap.count(when) != 0 )
+    for( ; it != NULL; it = it->GetHashNext() )
     {
-        const EventList& eventList = eventMap.find(when)->second;
-
-        EventList::const_iterator it;
-        for( it = eventList.begin(); it != eventList.end(); it++ )
+        if( it->GetCycle( ) == when && it->GetType( ) == EventCallback
+            && it->GetRecipient()->GetTrampoline() == recipient
+            && it->GetCallback() == method
+            && it->GetData() == data 
+            && it->GetPriority() == priority )
         {
-            if( (*it)->GetRecipient()->GetTrampoline() == recipient
-                && (*it)->GetCallback() == method
-                && (*it)->GetData() == data 
-                && (*it)->GetPriority() == priority )
-            {
-                rv = (*it);
-                break;
-            }
+            rv = it;
+            break;
         }
     }
 
@@ -358,17 +666,35 @@ void EventQueue::Loop( ncycle_t steps )
 void EventQueue::Process( )
 {
     /* Process all the events at the next cycle, and figure out the next next cycle. */
-    assert( eventMap.count( nextEventCycle ) );
+    assert( eventBackend->FindList( nextEventCycle ) );
 
-    EventList& eventList = eventMap[nextEventCycle];
-    EventList::iterator it;
+    eventBackend->Advance( nextEventCycle );
 
-    for( it = eventList.begin( ); it != eventList.end( ); it++ )
+    /* 
+     *  Events are unlinked before their handler runs, so handlers may safely
+     *  schedule more events for this cycle. Processed events stay in the
+     *  index until the whole cycle is done so FindEvent still sees them.
+     */
+    EventList& eventList = eventBackend->GetList( nextEventCycle );
+    Event *it;
+    Event *retired = NULL;
+    bool processed = false;
+
+    while( (it = eventList.PopFront( )) != NULL )
     {
-        switch( (*it)->GetType( ) )
+        /* Cancelled events were already unindexed by RemoveEvent. */
+        if( it->IsCancelled( ) )
+        {
+            FreeEvent( it );
+            continue;
+        }
+
+        it->Retire( );
+
+        switch( it->GetType( ) )
         {
             case EventCycle:
-                (*it)->GetRecipient( )->Cycle( nextEventCycle - lastEventCycle );
+                it->GetRecipient( )->Cycle( nextEventCycle - lastEventCycle );
                 break;
 
             case EventIdle:
@@ -380,14 +706,14 @@ void EventQueue::Process( )
                 break;
 
             case EventResponse:
-                (*it)->GetRecipient( )->RequestComplete( (*it)->GetRequest( ) );
+                it->GetRecipient( )->RequestComplete( it->GetRequest( ) );
                 break;
 
             case EventCallback:
             {
-                CallbackPtr cb = (*it)->GetCallback( );
-                NVMObject *thisPtr = (*it)->GetRecipient( )->GetTrampoline( );
-                (*thisPtr.*cb)( (*it)->GetData() );
+                CallbackPtr cb = it->GetCallback( );
+                NVMObject *thisPtr = it->GetRecipient( )->GetTrampoline( );
+                (*thisPtr.*cb)( it->GetData() );
                 break;
             }
 
@@ -397,24 +723,35 @@ void EventQueue::Process( )
                 break;
         }
 
-        /* Free event data */
-        delete (*it);
+        it->SetNext( retired );
+        retired = it;
+        processed = true;
     }
 
-    eventMap.erase( nextEventCycle );
-
-    /* Figure out the next cycle. */
-    if( eventMap.empty( ) )
+    /* Return the processed events to the pool. */
+    while( retired != NULL )
     {
-        lastEventCycle = nextEventCycle;
-        nextEventCycle = std::numeric_limits<ncycle_t>::max();
+        it = retired;
+        retired = it->GetNext( );
+
+        UnindexEvent( it );
+        FreeEvent( it );
     }
-    else
-    {
+
+    eventBackend->EraseList( nextEventCycle );
+
+    /* 
+     *  A cycle holding only cancelled events did not cycle anyone, so the
+     *  next EventCycle step still counts from the last live cycle.
+     */
+    if( processed )
         lastEventCycle = nextEventCycle;
-        /* map is sorted by keys, so this works out. */
-        nextEventCycle = eventMap.begin()->first; 
-    }
+
+    /* Figure out the next cycle. */
+    nextEventCycle = eventBackend->GetNextCycle( );
+
+    if( globalEventQueue != NULL )
+        globalEventQueue->UpdateNextEvent( clockDomain );
 }
 
 void EventQueue::SetFrequency( double freq )
@@ -432,8 +769,25 @@ ncycle_t EventQueue::GetNextEvent( )
     return nextEventCycle;
 }
 
+/*
+ *  A queue in a GlobalEventQueue clock domain is not stepped along with the
+ *  global clock. It catches up here, once per global cycle it is asked in.
+ *  No events are skipped: the global queue processes every event before
+ *  the global cycle passes it.
+ */
 ncycle_t EventQueue::GetCurrentCycle( )
 {
+    if( globalEventQueue != NULL 
+        && globalEventQueue->GetDomainCycle( clockDomain ) != syncedGlobalCycle )
+    {
+        ncycle_t localCycle = globalEventQueue->GetLocalCycle( clockDomain );
+
+        syncedGlobalCycle = globalEventQueue->GetDomainCycle( clockDomain );
+
+        if( localCycle > currentCycle )
+            currentCycle = localCycle;
+    }
+
     return currentCycle;
 }
 
@@ -442,10 +796,76 @@ void EventQueue::SetCurrentCycle( ncycle_t curCycle )
     currentCycle = curCycle;
 }
 
+ncycle_t EventQueue::GetLastEventCycle( )
+{
+    return lastEventCycle;
+}
+
+/*
+ *  Pending events are not saved by the queue. A checkpoint can only be taken
+ *  once every pending event is one its recipient saves and schedules again.
+ */
+bool EventQueue::CanCheckpoint( )
+{
+    for( size_t bucket = 0; bucket < eventIndex.size( ); bucket++ )
+    {
+        for( Event *it = eventIndex[bucket]; it != NULL; it = it->GetHashNext( ) )
+        {
+            if( !it->GetRecipient( )->GetTrampoline( )->CheckpointsEvent( it ) )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ *  Move the queue to the cycles of a checkpoint after its objects were
+ *  restored. Events cancelled by the restore are dropped; every other
+ *  pending event must be at or after curCycle.
+ */
+void EventQueue::RestoreCycles( ncycle_t curCycle, ncycle_t lastCycle )
+{
+    while( nextEventCycle < curCycle )
+    {
+        EventList& eventList = eventBackend->GetList( nextEventCycle );
+        Event *it;
+
+        while( (it = eventList.PopFront( )) != NULL )
+        {
+            assert( it->IsCancelled( ) );
+
+            FreeEvent( it );
+        }
+
+        eventBackend->EraseList( nextEventCycle );
+        nextEventCycle = eventBackend->GetNextCycle( );
+    }
+
+    eventBackend->Advance( curCycle );
+
+    currentCycle = curCycle;
+    lastEventCycle = lastCycle;
+
+    if( globalEventQueue != NULL )
+        globalEventQueue->UpdateNextEvent( clockDomain );
+}
+
+void EventQueue::SetGlobalEventQueue( GlobalEventQueue *geq, ncounter_t domain )
+{
+    globalEventQueue = geq;
+    clockDomain = domain;
+    syncedGlobalCycle = std::numeric_limits<ncycle_t>::max( );
+}
+
 
 GlobalEventQueue::GlobalEventQueue( )
 {
     currentCycle = 0;
+    frequency = 0.0;
+    statSampler = NULL;
+    lastCycle = 0;
+    syncedDomains = 0;
 }
 
 GlobalEventQueue::~GlobalEventQueue( )
@@ -453,6 +873,24 @@ GlobalEventQueue::~GlobalEventQueue( )
 
 }
 
+static ncycle_t GreatestCommonDivisor( ncycle_t a, ncycle_t b )
+{
+    while( b != 0 )
+    {
+        ncycle_t r = a % b;
+        a = b;
+        b = r;
+    }
+
+    return a;
+}
+
+/* Computes floor( cycles * mul / div ) without overflowing the product. */
+static ncycle_t ScaleCycles( ncycle_t cycles, ncycle_t mul, ncycle_t div )
+{
+    return (cycles / div) * mul + ((cycles % div) * mul) / div;
+}
+
 void GlobalEventQueue::AddSystem( NVMain *subSystem, Config *config )
 {
     double subSystemFrequency = config->GetEnergy( "CLK" ) * 1000000.0;
@@ -465,14 +903,33 @@ void GlobalEventQueue::AddSystem( NVMain *subSystem, Config *config )
      *  We aren't doing and checks here to make sure the input side (i.e. CPUFreq) is
      *  corrent since we don't know what it should be.
      */
-    eventQueues.insert( std::pair<EventQueue*, double>(queue, subSystemFrequency) );
+    ClockDomain domain;
+
+    domain.queue = queue;
+    domain.frequency = static_cast<ncounter_t>( subSystemFrequency + 0.5 );
+    domain.heapIndex = domainHeap.size( );
+    SetClockRatio( domain );
+
+    clockDomains.push_back( domain );
+    domainHeap.push_back( clockDomains.size( ) - 1 );
+
     queue->SetFrequency( subSystemFrequency );
+    queue->SetConfig( config );
+    queue->SetGlobalEventQueue( this, clockDomains.size( ) - 1 );
+
+    UpdateNextEvent( clockDomains.size( ) - 1 );
 
     std::cout << "NVMain: GlobalEventQueue: Added a memory subsystem running at "
               << config->GetEnergy( "CLK" ) << "MHz. My frequency is "
               << (frequency / 1000000.0) << "MHz." << std::endl;
 }
 
+/*
+ *  Each step finds the next event in the heap of clock domains and runs
+ *  that queue. The other queues are not stepped; they derive their cycle
+ *  from the global one when asked. A step is O(log domains) plus the
+ *  domains whose events are due in the same global cycle.
+ */
 void GlobalEventQueue::Cycle( ncycle_t steps )
 {
     EventQueue *nextEventQueue;
@@ -491,18 +948,26 @@ void GlobalEventQueue::Cycle( ncycle_t steps )
         /* Next event occurs after the current number of steps. */
         if( globalQueueSteps > (steps - iterationSteps))
         {
+            /* No queue has an event before the new cycle. */
             currentCycle += steps - iterationSteps;
-            Sync( );
+            lastCycle = currentCycle;
+
+            if( statSampler != NULL )
+                statSampler->Advance( currentCycle + 1 );
             break;
         }
 
+        if( statSampler != NULL )
+            statSampler->Advance( nextEvent );
+
         ncycle_t localQueueSteps = nextEventQueue->GetNextEvent( ) - nextEventQueue->GetCurrentCycle( );
         nextEventQueue->Loop( localQueueSteps );
 
         currentCycle += globalQueueSteps;
         iterationSteps += globalQueueSteps;
 
-        Sync( );
+        if( globalQueueSteps > 0 )
+            SyncDueDomains( );
     }
 }
 
@@ -510,6 +975,12 @@ void GlobalEventQueue::Cycle( ncycle_t steps )
 void GlobalEventQueue::SetFrequency( double freq )
 {
     frequency = freq;
+
+    for( size_t i = 0; i < clockDomains.size( ); i++ )
+    {
+        SetClockRatio( clockDomains[i] );
+        UpdateNextEvent( i );
+    }
 }
 
 double GlobalEventQueue::GetFrequency( )
@@ -517,31 +988,118 @@ double GlobalEventQueue::GetFrequency( )
     return frequency;
 }
 
+void GlobalEventQueue::SetClockRatio( ClockDomain& domain )
+{
+    ncycle_t globalFrequency = static_cast<ncycle_t>( frequency + 0.5 );
+    ncycle_t divisor = GreatestCommonDivisor( globalFrequency, domain.frequency );
+
+    if( divisor == 0 )
+        divisor = 1;
+
+    domain.globalCycles = globalFrequency / divisor;
+    domain.localCycles = domain.frequency / divisor;
+}
+
+ncycle_t GlobalEventQueue::ToGlobalCycle( const ClockDomain& domain, ncycle_t localCycle ) const
+{
+    return ScaleCycles( localCycle, domain.globalCycles, domain.localCycles );
+}
+
+ncycle_t GlobalEventQueue::ToLocalCycle( const ClockDomain& domain, ncycle_t globalCycle ) const
+{
+    return ScaleCycles( globalCycle, domain.localCycles, domain.globalCycles );
+}
+
+/* Ties go to the domain added first. */
+bool GlobalEventQueue::HeapBefore( ncounter_t a, ncounter_t b ) const
+{
+    const ClockDomain& da = clockDomains[domainHeap[a]];
+    const ClockDomain& db = clockDomains[domainHeap[b]];
+
+    if( da.nextEvent != db.nextEvent )
+        return da.nextEvent < db.nextEvent;
+
+    return domainHeap[a] < domainHeap[b];
+}
+
+void GlobalEventQueue::HeapSwap( ncounter_t a, ncounter_t b )
+{
+    std::swap( domainHeap[a], domainHeap[b] );
+
+    clockDomains[domainHeap[a]].heapIndex = a;
+    clockDomains[domainHeap[b]].heapIndex = b;
+}
+
+void GlobalEventQueue::SiftUp( ncounter_t pos )
+{
+    while( pos > 0 )
+    {
+        ncounter_t parent = (pos - 1) / 2;
+
+        if( !HeapBefore( pos, parent ) )
+            break;
+
+        HeapSwap( pos, parent );
+        pos = parent;
+    }
+}
+
+void GlobalEventQueue::SiftDown( ncounter_t pos )
+{
+    for( ;; )
+    {
+        ncounter_t first = pos;
+        ncounter_t left = 2 * pos + 1;
+        ncounter_t right = left + 1;
+
+        if( left < domainHeap.size( ) && HeapBefore( left, first ) )
+            first = left;
+        if( right < domainHeap.size( ) && HeapBefore( right, first ) )
+            first = right;
+
+        if( first == pos )
+            break;
+
+        HeapSwap( pos, first );
+        pos = first;
+    }
+}
+
+/* Called by a subsystem queue whenever its next event cycle changes. */
+void GlobalEventQueue::UpdateNextEvent( ncounter_t domain )
+{
+    ClockDomain& clockDomain = clockDomains[domain];
+    ncycle_t nextEvent = clockDomain.queue->GetNextEvent( );
+
+    /* 
+     *  If there is no event, we must skip frequency alignment to prevent
+     *  overflow causing an invalid nextEventCycle.
+     */
+    if( nextEvent != std::numeric_limits<ncycle_t>::max( ) )
+        nextEvent = ToGlobalCycle( clockDomain, nextEvent );
+
+    clockDomain.nextEvent = nextEvent;
+
+    SiftUp( clockDomain.heapIndex );
+    SiftDown( clockDomain.heapIndex );
+}
+
 ncycle_t GlobalEventQueue::GetNextEvent( EventQueue **eq )
 {
-    std::map<EventQueue *, double>::const_iterator iter;
     ncycle_t nextEventCycle = std::numeric_limits<ncycle_t>::max( );
 
     if( eq != NULL )
         *eq = NULL;
 
-    for( iter = eventQueues.begin( ); iter != eventQueues.end( ); iter++ )
+    if( !domainHeap.empty( ) )
     {
-        /* 
-         *  If there is no event, we must skip frequency alignment to prevent
-         *  underflow causing an invalid nextEventCycle.
-         */
-        if( iter->first->GetNextEvent( ) == std::numeric_limits<ncycle_t>::max( ) )
-            continue;
-
-        double frequencyMultiplier = frequency / iter->second;
-        double globalEventCycle = iter->first->GetNextEvent( ) * frequencyMultiplier;
+        const ClockDomain& next = clockDomains[domainHeap[0]];
 
-        if( static_cast<ncycle_t>(globalEventCycle) < nextEventCycle )
+        if( next.nextEvent != std::numeric_limits<ncycle_t>::max( ) )
         {
-            nextEventCycle = static_cast<ncycle_t>(globalEventCycle);
+            nextEventCycle = next.nextEvent;
             if( eq != NULL )
-                *eq = iter->first;
+                *eq = next.queue;
         }
     }
 
@@ -553,20 +1111,118 @@ ncycle_t GlobalEventQueue::GetCurrentCycle( )
     return currentCycle;
 }
 
-void GlobalEventQueue::Sync( )
+/* Only used to restore a checkpoint; the subsystem queues set their own. */
+void GlobalEventQueue::SetCurrentCycle( ncycle_t curCycle )
 {
-    std::map<EventQueue *, double>::const_iterator iter;
-    for( iter = eventQueues.begin( ); iter != eventQueues.end( ); iter++ )
+    currentCycle = curCycle;
+    lastCycle = curCycle;
+}
+
+bool GlobalEventQueue::CanCheckpoint( )
+{
+    std::vector<ClockDomain>::iterator iter;
+
+    for( iter = clockDomains.begin( ); iter != clockDomains.end( ); iter++ )
     {
-        double frequencyMultiplier = frequency / iter->second;
-        double setCycle = static_cast<double>(currentCycle) / frequencyMultiplier;
-        ncycle_t stepCount = static_cast<ncycle_t>(setCycle) - iter->first->GetCurrentCycle( );
+        if( !iter->queue->CanCheckpoint( ) )
+            return false;
+    }
 
-        if( static_cast<ncycle_t>(setCycle) > iter->first->GetCurrentCycle( ) )
+    return true;
+}
+
+/*
+ *  First global cycle at which the given subsystem queue has reached
+ *  localCycle, i.e. the cycle a caller must advance to before that queue's
+ *  state at localCycle is visible.
+ */
+ncycle_t GlobalEventQueue::GetWakeupCycle( EventQueue *queue, ncycle_t localCycle )
+{
+    std::vector<ClockDomain>::const_iterator iter;
+
+    if( localCycle == std::numeric_limits<ncycle_t>::max( ) )
+        return localCycle;
+
+    for( iter = clockDomains.begin( ); iter != clockDomains.end( ); iter++ )
+    {
+        if( iter->queue == queue )
         {
-            iter->first->Loop( stepCount );
+            ncycle_t wakeup = ToGlobalCycle( *iter, localCycle );
+
+            if( ToLocalCycle( *iter, wakeup ) < localCycle )
+                wakeup++;
+
+            return wakeup;
         }
     }
+
+    return std::numeric_limits<ncycle_t>::max( );
 }
 
+ncycle_t GlobalEventQueue::GetLocalCycle( ncounter_t domain )
+{
+    return ToLocalCycle( clockDomains[domain], GetDomainCycle( domain ) );
+}
 
+/* Lowest domain from firstDomain on whose next event is due, if any. */
+ncounter_t GlobalEventQueue::FindDueDomain( ncounter_t firstDomain )
+{
+    ncounter_t rv = clockDomains.size( );
+
+    dueStack.clear( );
+    if( !domainHeap.empty( ) )
+        dueStack.push_back( 0 );
+
+    /* Only the subtrees whose root is due can hold due domains. */
+    while( !dueStack.empty( ) )
+    {
+        ncounter_t pos = dueStack.back( );
+        ncounter_t domain = domainHeap[pos];
+
+        dueStack.pop_back( );
+
+        if( clockDomains[domain].nextEvent > currentCycle )
+            continue;
+
+        if( domain >= firstDomain && domain < rv )
+            rv = domain;
+
+        if( 2 * pos + 1 < domainHeap.size( ) )
+            dueStack.push_back( 2 * pos + 1 );
+        if( 2 * pos + 2 < domainHeap.size( ) )
+            dueStack.push_back( 2 * pos + 2 );
+    }
+
+    return rv;
+}
+
+/*
+ *  After the global cycle advances, run every queue with events up to the
+ *  new cycle in domain order, as if every queue was stepped in turn. The
+ *  queues without due events only catch up when they are asked for their
+ *  cycle, so they are not visited.
+ */
+void GlobalEventQueue::SyncDueDomains( )
+{
+    ncounter_t domain;
+
+    syncedDomains = 0;
+
+    while( (domain = FindDueDomain( syncedDomains )) < clockDomains.size( ) )
+    {
+        ClockDomain& clockDomain = clockDomains[domain];
+        ncycle_t setCycle = ToLocalCycle( clockDomain, currentCycle );
+
+        syncedDomains = domain;
+
+        ncycle_t queueCycle = clockDomain.queue->GetCurrentCycle( );
+
+        if( setCycle > queueCycle )
+            clockDomain.queue->Loop( setCycle - queueCycle );
+
+        syncedDomains = domain + 1;
+    }
+
+    syncedDomains = clockDomains.size( );
+    lastCycle = currentCycle;
+}
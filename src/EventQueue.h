@@ -35,7 +35,8 @@
 #define __NVMAIN_EVENTQUEUE_H__
 
 #include <map>
-#include <list>
+#include <vector>
+#include <climits>
 #include "include/NVMTypes.h"
 #include "include/NVMainRequest.h"
 
@@ -45,8 +46,9 @@ class Event;
 class NVMObject_hook;
 class Config;
 class NVMain;
+class GlobalEventQueue;
+class StatSampler;
 
-typedef std::list<Event *> EventList;
 typedef void (NVMObject::*CallbackPtr)(void*);
 
 enum EventType { EventUnknown,
@@ -60,7 +62,7 @@ enum EventType { EventUnknown,
 class Event
 {
   public:
-    Event() : type(EventUnknown), recipient(NULL), request(NULL), data(NULL), cycle(0), priority(0) {}
+    Event() : type(EventUnknown), recipient(NULL), request(NULL), data(NULL), cycle(0), priority(0), method(NULL), next(NULL), hashNext(NULL), generation(0), cancelled(false) {}
     ~Event() {}
 
     void SetType( EventType e ) { type = e; }
@@ -71,6 +73,8 @@ class Event
     void SetCycle( ncycle_t c ) { cycle = c; }
     void SetPriority( int p ) { priority = p; }
     void SetCallback( CallbackPtr m ) { method = m; }
+    void SetNext( Event *n ) { next = n; }
+    void SetHashNext( Event *n ) { hashNext = n; }
 
     EventType GetType( ) { return type; }
     NVMObject_hook *GetRecipient( ) { return recipient; }
@@ -79,6 +83,15 @@ class Event
     ncycle_t GetCycle( ) { return cycle; }
     int GetPriority( ) { return priority; }
     CallbackPtr GetCallback( ) { return method; }
+    Event *GetNext( ) { return next; }
+    Event *GetHashNext( ) { return hashNext; }
+
+    /* Called when the event stops being pending; invalidates its handles. */
+    void Retire( ) { generation++; }
+    void Cancel( ) { cancelled = true; generation++; }
+    bool IsCancelled( ) { return cancelled; }
+    ncounter_t GetGeneration( ) { return generation; }
+    void SetGeneration( ncounter_t g ) { generation = g; }
 
  private:
     EventType type;              /* Type of event (which callback to invoke). */
@@ -88,6 +101,133 @@ class Event
     ncycle_t cycle;
     int priority;
     CallbackPtr method;
+    Event *next;                 /* Next event in the cycle's list or free list. */
+    Event *hashNext;             /* Next event in the same FindEvent index bucket. */
+    ncounter_t generation;       /* Bumped each time the event is retired. */
+    bool cancelled;              /* Tombstone; skipped when processed. */
+};
+
+/*
+ *  Reference to a scheduled event. The handle goes stale once the event is
+ *  processed or cancelled, even if the pool has since reused the event.
+ */
+class EventHandle
+{
+  public:
+    EventHandle( ) : event(NULL), generation(0) { }
+    EventHandle( Event *e ) : event(e), generation(e->GetGeneration( )) { }
+
+    bool IsPending( ) const { return (event != NULL && event->GetGeneration( ) == generation); }
+    Event *GetEvent( ) const { return event; }
+
+  private:
+    Event *event;
+    ncounter_t generation;
+};
+
+/*
+ *  Intrusive list of the events scheduled for one cycle, linked through
+ *  Event::next so that no list nodes need to be allocated.
+ */
+class EventList
+{
+  public:
+    EventList( ) : head(NULL), tail(NULL), maxPriority(INT_MIN) { }
+
+    bool Empty( ) const { return head == NULL; }
+    Event *Front( ) const { return head; }
+
+    void Insert( Event *event, int priority );
+    bool Remove( Event *event );
+    Event *PopFront( );
+
+    void Swap( EventList& other );
+    void Clear( );
+
+  private:
+    Event *head;
+    Event *tail;
+    int maxPriority;             /* Upper bound on the priorities in the list. */
+};
+
+
+/*
+ *  Storage for the per-cycle event lists. The event queue only needs to find
+ *  the list for a given cycle and the earliest cycle with pending events, so
+ *  the container can be selected with the EventQueueBackend config key.
+ */
+class EventBackend
+{
+  public:
+    EventBackend( ) { }
+    virtual ~EventBackend( ) { }
+
+    /* Return the event list for cycle when, creating it if needed. */
+    virtual EventList& GetList( ncycle_t when ) = 0;
+    /* Return the event list for cycle when, or NULL if there is none. */
+    virtual const EventList *FindList( ncycle_t when ) const = 0;
+    virtual void EraseList( ncycle_t when ) = 0;
+
+    /* Called before the events at cycle when are processed. */
+    virtual void Advance( ncycle_t /*when*/ ) { }
+
+    virtual bool Empty( ) const = 0;
+    virtual ncycle_t GetNextCycle( ) const = 0;
+};
+
+/*
+ *  Default backend: one ordered map entry per cycle with pending events.
+ */
+class MapEventBackend : public EventBackend
+{
+  public:
+    MapEventBackend( ) { }
+    ~MapEventBackend( ) { }
+
+    EventList& GetList( ncycle_t when );
+    const EventList *FindList( ncycle_t when ) const;
+    void EraseList( ncycle_t when );
+
+    bool Empty( ) const;
+    ncycle_t GetNextCycle( ) const;
+
+  private:
+    std::map<ncycle_t, EventList> eventMap;
+};
+
+/*
+ *  Calendar queue (single-level timing wheel). Cycles within bucketCount
+ *  cycles of the cycle being processed map directly to a bucket, and an
+ *  occupancy bitmap is used to find the next non-empty bucket. Events
+ *  further in the future are kept in an overflow map and moved into the
+ *  wheel as the window advances.
+ */
+class CalendarEventBackend : public EventBackend
+{
+  public:
+    CalendarEventBackend( ncounter_t buckets );
+    ~CalendarEventBackend( ) { }
+
+    EventList& GetList( ncycle_t when );
+    const EventList *FindList( ncycle_t when ) const;
+    void EraseList( ncycle_t when );
+
+    void Advance( ncycle_t when );
+
+    bool Empty( ) const;
+    ncycle_t GetNextCycle( ) const;
+
+  private:
+    ncounter_t bucketCount;
+    ncycle_t bucketMask;
+    ncycle_t windowStart;
+    ncounter_t usedBuckets;
+
+    std::vector<EventList> buckets;
+    std::vector<uint64_t> occupied;
+    std::map<ncycle_t, EventList> overflow;
+
+    bool InWindow( ncycle_t when ) const;
 };
 
 
@@ -97,20 +237,25 @@ class EventQueue
     EventQueue();
     ~EventQueue();
 
-    void InsertEvent( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when, void *data = NULL, int priority = 0 );
-    void InsertEvent( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when, void *data = NULL, int priority = 0 );
-    void InsertEvent( EventType type, NVMObject_hook *recipient, ncycle_t when, void *data = NULL, int priority = 0 );
-    void InsertEvent( EventType type, NVMObject *recipient, ncycle_t when, void *data = NULL, int priority = 0 );
-    void InsertEvent( Event *event, ncycle_t when, int priority = 0 );
+    void SetConfig( Config *conf );
+
+    EventHandle InsertEvent( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when, void *data = NULL, int priority = 0 );
+    EventHandle InsertEvent( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when, void *data = NULL, int priority = 0 );
+    EventHandle InsertEvent( EventType type, NVMObject_hook *recipient, ncycle_t when, void *data = NULL, int priority = 0 );
+    EventHandle InsertEvent( EventType type, NVMObject *recipient, ncycle_t when, void *data = NULL, int priority = 0 );
+    EventHandle InsertEvent( Event *event, ncycle_t when, int priority = 0 );
 
-    void InsertCallback( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data = NULL, int priority = 0 );
+    EventHandle InsertCallback( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data = NULL, int priority = 0 );
+
+    Event *AllocateEvent( );
+    void FreeEvent( Event *event );
 
     Event *FindEvent( EventType type, NVMObject *recipient, NVMainRequest *req, ncycle_t when ) const;
     Event *FindEvent( EventType type, NVMObject_hook *recipient, NVMainRequest *req, ncycle_t when ) const;
 
     Event *FindCallback( NVMObject *recipient, CallbackPtr method, ncycle_t when, void *data = NULL, int priority = 0 ) const;
 
-    bool RemoveEvent( Event *event, ncycle_t when );
+    bool RemoveEvent( EventHandle handle );
 
     void Process( );
     void Loop( );
@@ -122,6 +267,12 @@ class EventQueue
     ncycle_t GetNextEvent( );
     ncycle_t GetCurrentCycle( );
     void SetCurrentCycle( ncycle_t curCycle );
+    ncycle_t GetLastEventCycle( );
+
+    bool CanCheckpoint( );
+    void RestoreCycles( ncycle_t curCycle, ncycle_t lastCycle );
+
+    void SetGlobalEventQueue( GlobalEventQueue *geq, ncounter_t domain );
 
   private:
     ncycle_t nextEventCycle;
@@ -129,7 +280,27 @@ class EventQueue
     ncycle_t currentCycle; 
     double frequency;
 
-    std::map< ncycle_t, EventList> eventMap; 
+    /* Told when nextEventCycle changes so it can reorder its clock domains. */
+    GlobalEventQueue *globalEventQueue;
+    ncounter_t clockDomain;
+    ncycle_t syncedGlobalCycle;   /* Global cycle currentCycle was caught up to. */
+
+    EventBackend *eventBackend;
+
+    Event *freeEvents;
+    std::vector<Event *> eventSlabs;
+
+    /* 
+     *  Hash index of pending events keyed by (cycle, recipient, type) so
+     *  that FindEvent and FindCallback do not scan the cycle's event list.
+     */
+    std::vector<Event *> eventIndex;
+    ncounter_t indexedEvents;
+
+    ncounter_t IndexBucket( ncycle_t when, NVMObject *recipient, EventType type ) const;
+    void IndexEvent( Event *event );
+    void UnindexEvent( Event *event );
+    void ResizeIndex( ncounter_t buckets );
 };
 
 
@@ -147,14 +318,64 @@ class GlobalEventQueue
 
     ncycle_t GetNextEvent( EventQueue **eq = NULL );
     ncycle_t GetCurrentCycle( );
+    void SetCurrentCycle( ncycle_t curCycle );
+    ncycle_t GetWakeupCycle( EventQueue *queue, ncycle_t localCycle );
+
+    /* Global cycle a domain's queue has reached, see SyncDueDomains. */
+    ncycle_t GetDomainCycle( ncounter_t domain ) 
+    { 
+        return (domain < syncedDomains) ? currentCycle : lastCycle; 
+    }
+    ncycle_t GetLocalCycle( ncounter_t domain );
+
+    bool CanCheckpoint( );
+
+    void UpdateNextEvent( ncounter_t domain );
+
+    /* Sampled before each event, so samples never see later events. */
+    void SetStatSampler( StatSampler *sampler ) { statSampler = sampler; }
 
   private:
+    /*
+     *  A subsystem clock is kept as an exact ratio to the global clock:
+     *  localCycles subsystem cycles elapse every globalCycles global cycles.
+     */
+    struct ClockDomain
+    {
+        EventQueue *queue;
+        ncounter_t frequency;   /* Subsystem frequency in Hz. */
+        ncycle_t globalCycles;
+        ncycle_t localCycles;
+        ncycle_t nextEvent;     /* Global cycle of the queue's next event. */
+        ncounter_t heapIndex;
+    };
+
     ncycle_t currentCycle;
     double frequency;
-
-    std::map<EventQueue *, double> eventQueues;
-
-    void Sync( );
+    StatSampler *statSampler;
+
+    /* 
+     *  While stepping to currentCycle, the domains before syncedDomains
+     *  are at currentCycle and the others are still at lastCycle.
+     */
+    ncycle_t lastCycle;
+    ncounter_t syncedDomains;
+    std::vector<ncounter_t> dueStack;
+
+    std::vector<ClockDomain> clockDomains;
+    std::vector<ncounter_t> domainHeap;
+
+    void SetClockRatio( ClockDomain& domain );
+    ncycle_t ToGlobalCycle( const ClockDomain& domain, ncycle_t localCycle ) const;
+    ncycle_t ToLocalCycle( const ClockDomain& domain, ncycle_t globalCycle ) const;
+
+    bool HeapBefore( ncounter_t a, ncounter_t b ) const;
+    void HeapSwap( ncounter_t a, ncounter_t b );
+    void SiftUp( ncounter_t pos );
+    void SiftDown( ncounter_t pos );
+
+    ncounter_t FindDueDomain( ncounter_t firstDomain );
+    void SyncDueDomains( );
 
 };
 
@@ -36,6 +36,7 @@
 #include "src/MemoryController.h"
 #include "include/NVMainRequest.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 #include "src/Interconnect.h"
 #include "Interconnect/InterconnectFactory.h"
 #include "src/Rank.h"
@@ -70,6 +71,9 @@ MemoryController::MemoryController( )
     subArrayNum = 1;
     starvationCounter = NULL;
     activateQueued = NULL;
+    refreshQueued = NULL;
+    bankNeedRefresh = NULL;
+    rankPowerDown = NULL;
     effectiveRow = NULL;
     effectiveMuxedRow = NULL;
     activeSubArray = NULL;
@@ -329,6 +333,15 @@ bool MemoryController::IsIssuable( NVMainRequest * /*request*/, FailReason * /*f
     return true;
 }
 
+/*
+ *  Atomic requests skip the queues and timing and pass straight to the
+ *  subarray, which updates its functional state (e.g., cell wear).
+ */
+bool MemoryController::IssueAtomic( NVMainRequest *request )
+{
+    return GetChild( )->IssueAtomic( request );
+}
+
 void MemoryController::SetMappingScheme( )
 {
     /* Configure common memory controller parameters. */
@@ -541,11 +554,11 @@ void MemoryController::SetConfig( Config *conf, bool createChildren )
                  * insert refresh pulse, the event queue behaves like a 
                  * refresh countdown timer 
                  */
-                GetEventQueue()->InsertCallback( this, 
+                refreshPulses.push_back( GetEventQueue()->InsertCallback( this, 
                                (CallbackPtr)&MemoryController::RefreshCallback, 
                                GetEventQueue()->GetCurrentCycle()+m_tREFI+offset, 
                                reinterpret_cast<void*>(refreshPulse), 
-                               refreshPriority );
+                               refreshPriority ) );
             }
         }
     }
@@ -562,6 +575,117 @@ void MemoryController::RegisterStats( )
     AddStat(wakeupCount);
 }
 
+/*
+ *  Checkpoints are taken once the transaction and command queues have
+ *  drained, so only the scheduling state and the refresh countdown are
+ *  saved. Stats are saved separately by Stats::CreateCheckpoint.
+ */
+void MemoryController::CreateCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    /* Controllers that do not build the queues (e.g., DRAM caches) have no state here. */
+    if( activateQueued != NULL && cpt.Create( Checkpoint::File( dir, StatName( ) ) ) )
+    {
+        cpt.Write( lastCommandWake );
+        cpt.Write( lastIssueCycle );
+        cpt.Write( curQueue );
+        cpt.Write( handledRefresh );
+        cpt.Write( nextRefreshRank );
+        cpt.Write( nextRefreshBank );
+        cpt.WriteArray( rankPowerDown, p->RANKS );
+
+        for( ncounter_t i = 0; i < p->RANKS; i++ )
+        {
+            cpt.WriteArray( activateQueued[i], p->BANKS );
+            cpt.WriteArray( refreshQueued[i], p->BANKS );
+            cpt.WriteArray( bankNeedRefresh[i], p->BANKS );
+
+            for( ncounter_t j = 0; j < p->BANKS; j++ )
+            {
+                cpt.WriteArray( effectiveRow[i][j], subArrayNum );
+                cpt.WriteArray( effectiveMuxedRow[i][j], subArrayNum );
+                cpt.WriteArray( activeSubArray[i][j], subArrayNum );
+                cpt.WriteArray( starvationCounter[i][j], subArrayNum );
+            }
+
+            if( p->UseRefresh )
+                cpt.WriteArray( delayedRefreshCounter[i], m_refreshBankNum );
+        }
+
+        for( ncounter_t i = 0; i < refreshPulses.size( ); i++ )
+        {
+            assert( refreshPulses[i].IsPending( ) );
+            cpt.Write( refreshPulses[i].GetEvent( )->GetCycle( ) );
+        }
+
+        cpt.Close( );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void MemoryController::RestoreCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( activateQueued != NULL && cpt.Open( Checkpoint::File( dir, StatName( ) ) ) )
+    {
+        cpt.Read( lastCommandWake );
+        cpt.Read( lastIssueCycle );
+        cpt.Read( curQueue );
+        cpt.Read( handledRefresh );
+        cpt.Read( nextRefreshRank );
+        cpt.Read( nextRefreshBank );
+        cpt.ReadArray( rankPowerDown, p->RANKS );
+
+        for( ncounter_t i = 0; i < p->RANKS; i++ )
+        {
+            cpt.ReadArray( activateQueued[i], p->BANKS );
+            cpt.ReadArray( refreshQueued[i], p->BANKS );
+            cpt.ReadArray( bankNeedRefresh[i], p->BANKS );
+
+            for( ncounter_t j = 0; j < p->BANKS; j++ )
+            {
+                cpt.ReadArray( effectiveRow[i][j], subArrayNum );
+                cpt.ReadArray( effectiveMuxedRow[i][j], subArrayNum );
+                cpt.ReadArray( activeSubArray[i][j], subArrayNum );
+                cpt.ReadArray( starvationCounter[i][j], subArrayNum );
+            }
+
+            if( p->UseRefresh )
+                cpt.ReadArray( delayedRefreshCounter[i], m_refreshBankNum );
+        }
+
+        /* Move each refresh pulse from its initial cycle to the saved one. */
+        for( ncounter_t i = 0; i < refreshPulses.size( ); i++ )
+        {
+            ncycle_t pulseCycle = 0;
+            void *refreshPulse = refreshPulses[i].GetEvent( )->GetData( );
+
+            cpt.Read( pulseCycle );
+
+            if( !cpt.Good( ) )
+                break;
+
+            GetEventQueue( )->RemoveEvent( refreshPulses[i] );
+            refreshPulses[i] = GetEventQueue( )->InsertCallback( this, 
+                                   (CallbackPtr)&MemoryController::RefreshCallback, 
+                                   pulseCycle, refreshPulse, refreshPriority );
+        }
+
+        cpt.Close( );
+    }
+
+    NVMObject::RestoreCheckpoint( dir );
+}
+
+bool MemoryController::CheckpointsEvent( Event *event )
+{
+    return (event->GetType( ) == EventCallback 
+            && event->GetCallback( ) == (CallbackPtr)&MemoryController::RefreshCallback);
+}
+
 /* 
  * NeedRefresh() has three functions:
  *  1) it returns false when no refresh is used (p->UseRefresh = false) 
@@ -756,7 +880,8 @@ void MemoryController::ProcessRefreshPulse( NVMainRequest* refresh )
     if( NeedRefresh( bank, rank ) )
         SetRefresh( bank, rank ); 
 
-    GetEventQueue()->InsertCallback( this, 
+    refreshPulses[rank * m_refreshBankNum + bank / p->BanksPerRefresh] = 
+        GetEventQueue()->InsertCallback( this, 
                    (CallbackPtr)&MemoryController::RefreshCallback, 
                    GetEventQueue()->GetCurrentCycle()+m_tREFI, 
                    reinterpret_cast<void*>(refresh), 
@@ -42,6 +42,7 @@
 #include "src/Config.h"
 #include "src/Interconnect.h"
 #include "src/AddressTranslator.h"
+#include "src/EventQueue.h"
 #include "include/NVMainRequest.h"
 #include <deque>
 #include <iostream>
@@ -109,6 +110,7 @@ class MemoryController : public NVMObject
 
     virtual bool RequestComplete( NVMainRequest *request );
     virtual bool IsIssuable( NVMainRequest *request, FailReason *fail );
+    virtual bool IssueAtomic( NVMainRequest *request );
     ncycle_t NextIssuable( NVMainRequest *request );
 
     virtual void RegisterStats( );
@@ -121,6 +123,10 @@ class MemoryController : public NVMObject
 
     virtual void SetConfig( Config *conf, bool createChildren = true );
     void SetMappingScheme( );
+
+    virtual void CreateCheckpoint( std::string dir );
+    virtual void RestoreCheckpoint( std::string dir );
+    bool CheckpointsEvent( Event *event );
     Config *GetConfig( );
 
     void SetID( unsigned int id );
@@ -241,6 +247,9 @@ class MemoryController : public NVMObject
     /* decrement the delayedRefreshCounter in a given bank group */
     void DecrementRefreshCounter(const ncounter_t, const ncounter_t); 
     
+    /* pending refresh pulse of each bank group, indexed rank * m_refreshBankNum + group */
+    std::vector<EventHandle> refreshPulses;
+
     ncycle_t handledRefresh;
     /* next Refresh rank and bank */
     ncounter_t nextRefreshRank, nextRefreshBank; 
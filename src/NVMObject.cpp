@@ -270,6 +270,8 @@ NVMObject *NVMObject_hook::GetTrampoline( )
 NVMObject::NVMObject( )
 {
     parent = NULL;
+    selfHook = NULL;
+    selfHookParent = NULL;
     decoder = NULL;
     children.clear( );
     eventQueue = NULL;
@@ -434,6 +436,13 @@ void NVMObject::AddChild( NVMObject *c )
     }
 
     children.push_back( hook );
+
+    /* Remember the hook so events to the child don't search for it. */
+    if( c->selfHookParent != this )
+    {
+        c->selfHook = hook;
+        c->selfHookParent = this;
+    }
 }
 
 NVMObject *NVMObject::_FindChild( NVMainRequest *req, const char *childClass )
@@ -484,6 +493,35 @@ NVMObject_hook* NVMObject::GetParent( )
     return parent;
 }
 
+NVMObject_hook *NVMObject::GetSelfHook( )
+{
+    NVMObject *parentObject = parent->GetTrampoline( );
+
+    /* The cached hook is only valid for the parent it was found under. */
+    if( selfHookParent != parentObject )
+    {
+        std::vector<NVMObject_hook *>& siblings = parentObject->GetChildren( );
+        std::vector<NVMObject_hook *>::iterator it;
+
+        selfHook = NULL;
+
+        for( it = siblings.begin(); it != siblings.end(); it++ )
+        {
+            if( (*it)->GetTrampoline() == this )
+            {
+                selfHook = (*it);
+                break;
+            }
+        }
+
+        assert( selfHook != NULL );
+
+        selfHookParent = parentObject;
+    }
+
+    return selfHook;
+}
+
 std::vector<NVMObject_hook *>& NVMObject::GetChildren( )
 {
     return children;
@@ -581,6 +619,16 @@ void NVMObject::RestoreCheckpoint( std::string dir )
         GetDecoder( )->RestoreCheckpoint( dir );
 }
 
+/*
+ *  Whether the checkpoint of this object saves the given pending event and
+ *  RestoreCheckpoint schedules it again. Checkpoints are only taken once
+ *  every other event has been processed.
+ */
+bool NVMObject::CheckpointsEvent( Event * /*event*/ )
+{
+    return false;
+}
+
 void NVMObject::PrintHierarchy( int depth )
 {
     std::vector<NVMObject_hook *>::iterator it;
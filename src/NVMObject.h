@@ -87,6 +87,7 @@
 namespace NVM {
 
 class NVMainRequest;
+class Event;
 class EventQueue;
 class GlobalEventQueue;
 class AddressTranslator;
@@ -182,6 +183,7 @@ class NVMObject
     virtual GlobalEventQueue *GetGlobalEventQueue( );
 
     NVMObject_hook *GetParent( );
+    NVMObject_hook *GetSelfHook( );
     std::vector<NVMObject_hook *>& GetChildren( );
     NVMObject_hook *GetChild( NVMainRequest *req );  
     NVMObject_hook *GetChild( ncounter_t child );
@@ -197,6 +199,7 @@ class NVMObject
 
     virtual void CreateCheckpoint( std::string dir );
     virtual void RestoreCheckpoint( std::string dir );
+    virtual bool CheckpointsEvent( Event *event );
 
     void PrintHierarchy( int depth = 0 );
 
@@ -226,6 +229,8 @@ class NVMObject
 
   protected:
     NVMObject_hook *parent;
+    NVMObject_hook *selfHook;          /* Our hook in the parent's children. */
+    NVMObject *selfHookParent;         /* Parent selfHook was found under. */
     AddressTranslator *decoder;
     Stats *stats;
     Params *p;
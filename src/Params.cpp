@@ -175,6 +175,10 @@ Params::Params( )
     MemoryPrefetcher = "none";
     PrefetchBufferSize = 32;
 
+    ParallelChannels = false;
+    ParallelThreads = 0;
+    ParallelLookahead = 0;
+
     programMode = ProgramMode_SRMS;
     MLCLevels = 1;
     WPVariance = 1;
@@ -365,6 +369,10 @@ void Params::SetParams( Config *c )
     c->GetString( "MemoryPrefetcher", MemoryPrefetcher );
     c->GetValueUL( "PrefetchBufferSize", PrefetchBufferSize );
 
+    c->GetBool( "ParallelChannels", ParallelChannels );
+    c->GetValueUL( "ParallelThreads", ParallelThreads );
+    c->GetValueUL( "ParallelLookahead", ParallelLookahead );
+
     if( c->KeyExists( "ProgramMode" ) )
     {
         if( c->GetString( "ProgramMode" ) == "SRMS" )
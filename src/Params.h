@@ -176,6 +176,10 @@ class Params
     std::string MemoryPrefetcher;
     ncounter_t PrefetchBufferSize;
 
+    bool ParallelChannels; // one event queue per channel, run on worker threads
+    ncounter_t ParallelThreads; // worker threads (0 = one per channel)
+    ncycle_t ParallelLookahead; // epoch length (0 = shortest channel read latency)
+
     ProgramMode programMode;
     ncounter_t MLCLevels;
     ncounter_t WPVariance;
@@ -0,0 +1,277 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "src/StatSampler.h"
+#include "src/Config.h"
+
+#include <iostream>
+#include <sstream>
+#include <limits>
+#include <cstdlib>
+
+using namespace NVM;
+
+StatSampler::StatSampler( )
+    : head(0), tail(0), stopping(false), producerWaiting(false), consumerWaiting(false)
+{
+    stats = NULL;
+    interval = 0;
+    globalCycles = memoryCycles = 1;
+    nextBoundary = 0;
+    nextSample = std::numeric_limits<ncycle_t>::max( );
+    rowCount = 0;
+    flushRows = 0;
+    threadStarted = false;
+
+    pthread_mutex_init( &waitLock, NULL );
+    pthread_cond_init( &waitCond, NULL );
+}
+
+StatSampler::~StatSampler( )
+{
+    Close( );
+
+    pthread_cond_destroy( &waitCond );
+    pthread_mutex_destroy( &waitLock );
+}
+
+bool StatSampler::Init( Config *config, Stats *stats, ncycle_t startCycle )
+{
+    std::string statList = "rb_hits";
+    std::string sampleFile = "timeseries.csv";
+
+    this->stats = stats;
+
+    interval = config->GetValueUL( "StatSamplerInterval" );
+    if( interval == 0 )
+        return false;
+
+    if( config->KeyExists( "StatSamplerStats" ) )
+        statList = config->GetString( "StatSamplerStats" );
+
+    if( config->KeyExists( "StatSamplerFile" ) )
+        sampleFile = config->GetString( "StatSamplerFile" );
+
+    rowCount = 4096;
+    config->GetValueUL( "StatSamplerBufferRows", rowCount );
+
+    /* At least one row to fill while another is written. */
+    if( rowCount < 2 )
+        rowCount = 2;
+    flushRows = rowCount / 2;
+
+    std::stringstream statStream( statList );
+    std::string statName;
+
+    while( std::getline( statStream, statName, ',' ) )
+    {
+        std::vector<StatHandle> handles;
+        double numericValue;
+
+        stats->findStatHandles( statName, handles );
+
+        for( size_t handleIdx = 0; handleIdx < handles.size( ); handleIdx++ )
+        {
+            if( stats->getNumericValue( handles[handleIdx], numericValue ) )
+                columns.push_back( handles[handleIdx] );
+        }
+    }
+
+    if( columns.empty( ) )
+    {
+        std::cout << "Warning: StatSamplerStats `" << statList << "' matches no "
+            << "numeric stats. No time series is recorded." << std::endl;
+        return false;
+    }
+
+    output.open( sampleFile.c_str( ), std::ofstream::out | std::ofstream::app );
+
+    if( !output.is_open( ) )
+    {
+        std::cout << "Warning: Could not open StatSamplerFile `" << sampleFile 
+            << "'. No time series is recorded." << std::endl;
+        return false;
+    }
+
+    output.precision( std::numeric_limits<double>::digits10 );
+
+    output << "cycle";
+    for( size_t colIdx = 0; colIdx < columns.size( ); colIdx++ )
+        output << "," << stats->getStatName( columns[colIdx] );
+    output << "\n";
+
+    rowCycles.resize( rowCount );
+    rowValues.resize( rowCount * columns.size( ) );
+
+    /* The global clock runs CPUFreq cycles per CLK memory cycles. */
+    globalCycles = static_cast<ncounter_t>( config->GetValue( "CPUFreq" ) );
+    memoryCycles = static_cast<ncounter_t>( config->GetValue( "CLK" ) );
+
+    if( globalCycles == 0 || memoryCycles == 0 )
+        globalCycles = memoryCycles = 1;
+
+    nextBoundary = 1;
+    while( GetBoundaryCycle( nextBoundary ) < startCycle )
+        nextBoundary++;
+    nextSample = GetBoundaryCycle( nextBoundary );
+
+    if( pthread_create( &thread, NULL, WriterThread, this ) != 0 )
+    {
+        std::cerr << "StatSampler: Could not create writer thread." << std::endl;
+        exit(1);
+    }
+
+    threadStarted = true;
+
+    return true;
+}
+
+ncycle_t StatSampler::GetBoundaryCycle( ncounter_t boundary )
+{
+    return (boundary * interval * globalCycles + memoryCycles - 1) / memoryCycles;
+}
+
+void StatSampler::TakeSamples( ncycle_t cycle )
+{
+    while( nextSample < cycle )
+    {
+        ncounter_t position = tail;
+
+        /* Ring is full, wait for the writer thread. */
+        if( position - head == rowCount )
+        {
+            pthread_mutex_lock( &waitLock );
+            producerWaiting = true;
+
+            while( position - head == rowCount )
+                pthread_cond_wait( &waitCond, &waitLock );
+
+            producerWaiting = false;
+            pthread_mutex_unlock( &waitLock );
+        }
+
+        ncounter_t row = position % rowCount;
+        double *values = &rowValues[row * columns.size( )];
+
+        rowCycles[row] = nextBoundary * interval;
+
+        for( size_t colIdx = 0; colIdx < columns.size( ); colIdx++ )
+        {
+            if( !stats->getNumericValue( columns[colIdx], values[colIdx] ) )
+                values[colIdx] = 0.0;
+        }
+
+        tail = position + 1;
+
+        if( position + 1 - head >= flushRows )
+            Wake( consumerWaiting );
+
+        nextBoundary++;
+        nextSample = GetBoundaryCycle( nextBoundary );
+    }
+}
+
+/* See ReadAheadTraceReader::Wake for why no wakeup is lost. */
+void StatSampler::Wake( std::atomic<bool>& waiting )
+{
+    if( waiting )
+    {
+        pthread_mutex_lock( &waitLock );
+        pthread_cond_broadcast( &waitCond );
+        pthread_mutex_unlock( &waitLock );
+    }
+}
+
+void *StatSampler::WriterThread( void *data )
+{
+    static_cast<StatSampler *>( data )->Consume( );
+
+    return NULL;
+}
+
+void StatSampler::Consume( )
+{
+    while( true )
+    {
+        ncounter_t position = head;
+        ncounter_t available = tail - position;
+
+        /* Write in batches of flushRows until the sampler is closed. */
+        if( available < flushRows && !stopping )
+        {
+            pthread_mutex_lock( &waitLock );
+            consumerWaiting = true;
+
+            while( tail - position < flushRows && !stopping )
+                pthread_cond_wait( &waitCond, &waitLock );
+
+            consumerWaiting = false;
+            pthread_mutex_unlock( &waitLock );
+
+            continue;
+        }
+
+        if( available == 0 )
+            break;
+
+        for( ncounter_t rowIdx = position; rowIdx < position + available; rowIdx++ )
+        {
+            ncounter_t row = rowIdx % rowCount;
+            double *values = &rowValues[row * columns.size( )];
+
+            output << rowCycles[row];
+            for( size_t colIdx = 0; colIdx < columns.size( ); colIdx++ )
+                output << "," << values[colIdx];
+            output << "\n";
+        }
+
+        head = position + available;
+        Wake( producerWaiting );
+    }
+}
+
+void StatSampler::Close( )
+{
+    if( !threadStarted )
+        return;
+
+    pthread_mutex_lock( &waitLock );
+    stopping = true;
+    pthread_cond_broadcast( &waitCond );
+    pthread_mutex_unlock( &waitLock );
+
+    pthread_join( thread, NULL );
+    threadStarted = false;
+
+    output.close( );
+}
@@ -0,0 +1,127 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __SRC_STATSAMPLER_H__
+#define __SRC_STATSAMPLER_H__
+
+#include "include/NVMTypes.h"
+#include "src/Stats.h"
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+namespace NVM {
+
+class Config;
+
+/*
+ *  Records a time series of selected stats. Every StatSamplerInterval
+ *  memory cycles the current values are copied into a ring of rows, which
+ *  a background thread appends to a CSV file. Values are read as they are
+ *  while simulating, so counters such as rb_hits or activeCycles give a
+ *  useful series, while stats computed in CalculateStats (e.g., averages)
+ *  only change when the stats are printed.
+ *
+ *  The ring is lock-free while it is neither full nor empty; the simulation
+ *  only waits for the writer thread when the ring is full.
+ */
+class StatSampler
+{
+  public:
+    StatSampler( );
+    ~StatSampler( );
+
+    /* 
+     *  False if no stats are selected or the file cannot be opened. The 
+     *  first sample is the first interval boundary at or after startCycle.
+     */
+    bool Init( Config *config, Stats *stats, ncycle_t startCycle );
+
+    /* Sample every interval boundary before global cycle. */
+    void Advance( ncycle_t cycle )
+    {
+        if( cycle > nextSample )
+            TakeSamples( cycle );
+    }
+
+    /* Writes the rows still in the ring and stops the writer thread. */
+    void Close( );
+
+    ncounter_t GetSampleCount( ) { return tail; }
+    ncounter_t GetStatCount( ) { return columns.size( ); }
+
+  private:
+    Stats *stats;
+    std::vector<StatHandle> columns;
+
+    /* Boundary k is at memory cycle k * interval. */
+    ncycle_t interval;
+    ncounter_t globalCycles, memoryCycles;
+    ncounter_t nextBoundary;
+    ncycle_t nextSample;
+
+    /* Row r holds its memory cycle and one value per column. */
+    std::vector<ncycle_t> rowCycles;
+    std::vector<double> rowValues;
+    ncounter_t rowCount;
+    ncounter_t flushRows;
+
+    /* Rows are produced at tail and written out from head. */
+    std::atomic<ncounter_t> head;
+    std::atomic<ncounter_t> tail;
+
+    std::ofstream output;
+
+    pthread_t thread;
+    bool threadStarted;
+    std::atomic<bool> stopping;
+
+    pthread_mutex_t waitLock;
+    pthread_cond_t waitCond;
+    std::atomic<bool> producerWaiting;
+    std::atomic<bool> consumerWaiting;
+
+    ncycle_t GetBoundaryCycle( ncounter_t boundary );
+    void TakeSamples( ncycle_t cycle );
+    void Wake( std::atomic<bool>& waiting );
+    void Consume( );
+
+    static void *WriterThread( void *data );
+};
+
+};
+
+#endif
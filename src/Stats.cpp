@@ -33,6 +33,14 @@
 
 
 #include "src/Stats.h"
+#include "src/Checkpoint.h"
+#include "src/StatsWriter.h"
+#include "StatsWriters/TextStats/TextStatsWriter.h"
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
 
 
 using namespace NVM;
@@ -41,6 +49,9 @@ using namespace NVM;
 Stats::Stats( )
 {
     psInterval = 0;
+    liveStats = 0;
+    statsWriter = new TextStatsWriter( );
+    sampleCount = 0;
 }
 
 Stats::~Stats( )
@@ -49,104 +60,654 @@ Stats::~Stats( )
 
     for( it = statList.begin(); it != statList.end(); it++ )
     {
+        if( (*it) == NULL )
+            continue;
+
         /* Free reset value memory. */
         uint8_t *rval = static_cast<uint8_t *>((*it)->GetResetValue( ));
         delete[] rval; 
         delete (*it);
     }
+
+    delete statsWriter;
 }
 
-void Stats::addStat( StatType stat, StatType resetValue, std::string statType, size_t typeSize, std::string name, std::string units )
+StatHandle Stats::addStat( StatType stat, StatType resetValue, std::string statType, size_t typeSize, std::string name, std::string units )
 {
     StatBase *sb = new StatBase( );
+    StatHandle handle = statList.size( );
+    NameEntry newEntry = { handle, 0 };
+    std::unordered_map<std::string, NameEntry>::iterator entry;
+
+    entry = nameIndex.insert( std::make_pair( name, newEntry ) ).first;
 
-    sb->SetName( name );
+    /* getStat( name ) finds the first stat registered with a name. */
+    if( entry->second.count == 0 )
+        entry->second.handle = handle;
+    entry->second.count++;
+
+    sb->SetName( &(entry->first) );
     sb->SetValue( stat );
     sb->SetResetValue( resetValue );
     sb->SetStatType( statType, typeSize );
     sb->SetUnits( units );
 
     statList.push_back( sb );
+    valueIndex.insert( std::make_pair( stat, handle ) );
+    liveStats++;
+
+    return handle;
 }
 
 void Stats::removeStat( StatType stat )
 {
-    std::vector<StatBase *>::iterator it;
+    std::unordered_map<StatType, StatHandle>::iterator it = valueIndex.find( stat );
 
-    for( it = statList.begin(); it != statList.end(); it++ )
+    if( it == valueIndex.end( ) )
+        return;
+
+    StatHandle handle = it->second;
+    StatBase *sb = statList[handle];
+    NameEntry& entry = nameIndex[sb->GetName( )];
+
+    valueIndex.erase( it );
+    statList[handle] = NULL;
+    liveStats--;
+
+    /* Only a name shared by several stats needs a search for the next one. */
+    entry.count--;
+    if( entry.handle == handle )
     {
-        if( (*it)->GetValue( ) == stat )
-        {
-            /* Free reset value memory. */
-            uint8_t *rval = static_cast<uint8_t *>((*it)->GetResetValue( ));
-            delete[] rval; 
+        entry.handle = InvalidStatHandle;
 
-            statList.erase( it );
-            break;
+        for( StatHandle next = handle + 1; entry.count > 0 && next < statList.size( ); next++ )
+        {
+            if( statList[next] != NULL && &(statList[next]->GetName( )) == &(sb->GetName( )) )
+            {
+                entry.handle = next;
+                break;
+            }
         }
     }
+
+    /* Free reset value memory. */
+    uint8_t *rval = static_cast<uint8_t *>(sb->GetResetValue( ));
+    delete[] rval; 
+    delete sb;
 }
 
 StatType Stats::getStat( std::string name )
+{
+    return getStat( getStatHandle( name ) );
+}
+
+StatHandle Stats::getStatHandle( const std::string& name )
+{
+    StatHandle rv = InvalidStatHandle;
+    std::unordered_map<std::string, NameEntry>::iterator it = nameIndex.find( name );
+
+    if( it != nameIndex.end( ) )
+        rv = it->second.handle;
+
+    return rv;
+}
+
+StatType Stats::getStat( StatHandle handle )
 {
     StatType rv = NULL;
-    std::vector<StatBase *>::iterator it;
 
-    for( it = statList.begin(); it != statList.end(); it++ )
+    if( handle < statList.size( ) && statList[handle] != NULL )
+        rv = statList[handle]->GetValue( );
+
+    return rv;
+}
+
+void Stats::findStatHandles( const std::string& name, std::vector<StatHandle>& handles )
+{
+    std::string suffix = "." + name;
+
+    for( StatHandle handle = 0; handle < statList.size( ); handle++ )
     {
-        if( (*it)->GetName( ) == name )
-        {
-            rv = (*it)->GetValue( );
-            break;
-        }
+        if( statList[handle] == NULL )
+            continue;
+
+        const std::string& statName = statList[handle]->GetName( );
+
+        if( statName == name || (statName.size( ) > suffix.size( ) 
+            && statName.compare( statName.size( ) - suffix.size( ), suffix.size( ), suffix ) == 0) )
+            handles.push_back( handle );
     }
+}
+
+bool Stats::getNumericValue( StatHandle handle, double& numericValue )
+{
+    bool rv = false;
+
+    if( handle < statList.size( ) && statList[handle] != NULL )
+        rv = statList[handle]->GetNumericValue( numericValue );
+
+    return rv;
+}
+
+std::string Stats::getStatName( StatHandle handle )
+{
+    std::string rv;
+
+    if( handle < statList.size( ) && statList[handle] != NULL )
+        rv = statList[handle]->GetName( );
 
     return rv;
 }
 
 void Stats::PrintAll( std::ostream& stream )
+{
+    statsWriter->Write( stream, statList, psInterval );
+    stream.flush( );
+
+    psInterval++;
+}
+
+void Stats::SetWriter( StatsWriter *writer )
+{
+    if( writer == NULL )
+        return;
+
+    delete statsWriter;
+    statsWriter = writer;
+}
+
+void Stats::ResetAll( )
 {
     std::vector<StatBase *>::iterator it;
 
     for( it = statList.begin(); it != statList.end(); it++ )
     {
-        (*it)->Print( stream, psInterval );
+        if( (*it) != NULL )
+            (*it)->Reset( );
     }
+}
 
-    psInterval++;
+void Stats::AddSample( )
+{
+    double numericValue;
+
+    sampleSums.resize( statList.size( ), 0.0 );
+    sampleSquares.resize( statList.size( ), 0.0 );
+
+    for( size_t statIdx = 0; statIdx < statList.size( ); statIdx++ )
+    {
+        if( statList[statIdx] != NULL && statList[statIdx]->GetNumericValue( numericValue ) )
+        {
+            sampleSums[statIdx] += numericValue;
+            sampleSquares[statIdx] += numericValue * numericValue;
+        }
+    }
+
+    sampleCount++;
 }
 
-void Stats::ResetAll( )
+ncounter_t Stats::GetSampleCount( )
+{
+    return sampleCount;
+}
+
+/* 
+ *  Half width of the confidence interval of the mean of a stat. The z value
+ *  of the confidence level is found by bisection on the normal CDF.
+ */
+double Stats::GetHalfWidth( size_t statIdx, double confidence )
+{
+    double zLow = 0.0, zHigh = 10.0;
+
+    if( sampleCount < 2 )
+        return 0.0;
+
+    for( int iteration = 0; iteration < 64; iteration++ )
+    {
+        double z = (zLow + zHigh) / 2.0;
+
+        if( std::erf( z / std::sqrt( 2.0 ) ) < confidence )
+            zLow = z;
+        else
+            zHigh = z;
+    }
+
+    double n = static_cast<double>( sampleCount );
+    double mean = sampleSums[statIdx] / n;
+    double variance = (sampleSquares[statIdx] - n * mean * mean) / (n - 1.0);
+
+    if( variance < 0.0 )
+        variance = 0.0;
+
+    return zHigh * std::sqrt( variance / n );
+}
+
+/*
+ *  Largest confidence interval half width relative to the mean of the stats
+ *  named name, or ending in "." + name. Stats with a mean of zero are
+ *  skipped. Returns -1 if no stat matches.
+ */
+double Stats::GetSampleError( std::string name, double confidence )
+{
+    double error = -1.0;
+    std::vector<StatHandle> handles;
+
+    findStatHandles( name, handles );
+
+    for( size_t handleIdx = 0; handleIdx < handles.size( ); handleIdx++ )
+    {
+        StatHandle statIdx = handles[handleIdx];
+
+        /* Stats registered after the last sample have no samples. */
+        if( statIdx >= sampleSums.size( ) )
+            continue;
+
+        double mean = sampleSums[statIdx] / static_cast<double>( sampleCount );
+
+        if( mean == 0.0 )
+            continue;
+
+        double relativeError = GetHalfWidth( statIdx, confidence ) / std::fabs( mean );
+
+        if( relativeError > error )
+            error = relativeError;
+    }
+
+    return error;
+}
+
+/* Prints the mean of each numeric stat followed by +- the half width. */
+void Stats::PrintSamples( std::ostream& stream, double confidence )
 {
+    stream << "samples " << sampleCount << std::endl;
+    stream << "confidence " << confidence << std::endl;
+
+    for( size_t statIdx = 0; statIdx < sampleSums.size( ); statIdx++ )
+    {
+        double numericValue;
+
+        if( sampleCount == 0 || statList[statIdx] == NULL 
+            || !statList[statIdx]->GetNumericValue( numericValue ) )
+            continue;
+
+        stream << "s." << statList[statIdx]->GetName( ) << " " 
+               << sampleSums[statIdx] / static_cast<double>( sampleCount )
+               << statList[statIdx]->GetUnits( ) << " +- " 
+               << GetHalfWidth( statIdx, confidence ) << std::endl;
+    }
+}
+
+ncounter_t Stats::GetLiveStatCount( )
+{
+    return liveStats;
+}
+
+/*
+ *  Stats are matched by position and then by name, since the same
+ *  configuration registers them in the same order. Like Reset( ), every
+ *  type other than std::string is copied as plain bytes.
+ */
+void Stats::CreateCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
     std::vector<StatBase *>::iterator it;
 
+    if( !cpt.Create( Checkpoint::File( dir, "stats" ) ) )
+        return;
+
+    cpt.Write( psInterval );
+    cpt.Write( static_cast<uint64_t>( GetLiveStatCount( ) ) );
+
     for( it = statList.begin(); it != statList.end(); it++ )
     {
-        (*it)->Reset( );
+        if( (*it) == NULL )
+            continue;
+
+        cpt.WriteString( (*it)->GetName( ) );
+        cpt.WriteString( (*it)->GetTypeName( ) );
+
+        if( (*it)->GetValueType( ) == STAT_TYPE_STRING )
+        {
+            cpt.WriteString( *(static_cast<std::string *>((*it)->GetValue( ))) );
+        }
+        else if( (*it)->GetValueType( ) == STAT_TYPE_HISTOGRAM )
+        {
+            static_cast<Histogram *>((*it)->GetValue( ))->CreateCheckpoint( cpt );
+        }
+        else
+        {
+            cpt.Write( static_cast<uint64_t>( (*it)->GetTypeSize( ) ) );
+            cpt.WriteArray( static_cast<uint8_t *>((*it)->GetValue( )), (*it)->GetTypeSize( ) );
+        }
     }
+
+    cpt.Close( );
 }
 
+void Stats::RestoreCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+    uint64_t statCount = 0;
+    ncounter_t unmatched = 0;
+
+    if( !cpt.Open( Checkpoint::File( dir, "stats" ) ) )
+        return;
+
+    cpt.Read( psInterval );
+    cpt.Read( statCount );
+
+    for( uint64_t statIdx = 0; statIdx < statCount && cpt.Good( ); statIdx++ )
+    {
+        std::string name, statType;
+        StatBase *stat = NULL;
+
+        cpt.ReadString( name );
+        cpt.ReadString( statType );
+
+        if( statIdx < statList.size( ) && statList[statIdx] != NULL 
+            && statList[statIdx]->GetName( ) == name )
+        {
+            stat = statList[statIdx];
+        }
+        else
+        {
+            StatHandle handle = getStatHandle( name );
+
+            if( handle != InvalidStatHandle )
+                stat = statList[handle];
+        }
+
+        if( stat != NULL && stat->GetTypeName( ) != statType )
+            stat = NULL;
+
+        if( statType == typeid(std::string).name() )
+        {
+            std::string value;
+
+            cpt.ReadString( value );
+
+            if( stat != NULL )
+                *(static_cast<std::string *>(stat->GetValue( ))) = value;
+        }
+        else if( statType == typeid(Histogram).name() )
+        {
+            /* Read into a scratch histogram when the stat is missing. */
+            Histogram unmatchedHistogram;
+            Histogram *histogram = &unmatchedHistogram;
+
+            if( stat != NULL )
+                histogram = static_cast<Histogram *>(stat->GetValue( ));
+
+            if( !histogram->RestoreCheckpoint( cpt ) )
+                stat = NULL;
+        }
+        else
+        {
+            uint64_t typeSize = 0;
+
+            cpt.Read( typeSize );
+
+            std::vector<uint8_t> value( typeSize );
+
+            if( typeSize > 0 )
+                cpt.ReadArray( &value[0], typeSize );
+
+            if( stat != NULL && stat->GetTypeSize( ) != typeSize )
+                stat = NULL;
+
+            if( stat != NULL && typeSize > 0 )
+                memcpy( stat->GetValue( ), &value[0], typeSize );
+        }
+
+        if( stat == NULL )
+            unmatched++;
+    }
+
+    if( cpt.Close( ) && (unmatched > 0 || statCount != GetLiveStatCount( )) )
+    {
+        std::cout << "NVMain: Warning: The checkpoint has " << statCount << " stats and " 
+                  << unmatched << " of them were not restored. This configuration has " 
+                  << GetLiveStatCount( ) << " stats." << std::endl;
+    }
+}
+
+
+void StatBase::SetStatType( std::string st, size_t ts )
+{
+    statType = st; 
+    typeSize = ts;
+
+    /* ncycle_t and ncycles_t are the same types as the counters. */
+    if( statType == typeid(int).name() ) valueType = STAT_TYPE_INT;
+    else if( statType == typeid(float).name() ) valueType = STAT_TYPE_FLOAT;
+    else if( statType == typeid(double).name() ) valueType = STAT_TYPE_DOUBLE;
+    else if( statType == typeid(ncounter_t).name() ) valueType = STAT_TYPE_UINT64;
+    else if( statType == typeid(ncounters_t).name() ) valueType = STAT_TYPE_INT64;
+    else if( statType == typeid(std::string).name() ) valueType = STAT_TYPE_STRING;
+    else if( statType == typeid(Histogram).name() ) valueType = STAT_TYPE_HISTOGRAM;
+    else valueType = STAT_TYPE_UNKNOWN;
+}
 
 void StatBase::Reset( )
 {
-    std::memcpy( value, resetValue, typeSize );
+    /* The bytes of a std::string are not a copy of it, so it is cleared. */
+    if( valueType == STAT_TYPE_STRING )
+        static_cast<std::string *>(value)->clear( );
+    else if( valueType == STAT_TYPE_HISTOGRAM )
+        static_cast<Histogram *>(value)->Reset( );
+    else
+        std::memcpy( value, resetValue, typeSize );
+}
+
+bool StatBase::GetNumericValue( double& numericValue )
+{
+    bool rv = true;
+
+    switch( valueType )
+    {
+        case STAT_TYPE_INT: numericValue = *(static_cast<int *>(value)); break;
+        case STAT_TYPE_FLOAT: numericValue = *(static_cast<float *>(value)); break;
+        case STAT_TYPE_DOUBLE: numericValue = *(static_cast<double *>(value)); break;
+        case STAT_TYPE_UINT64: numericValue = static_cast<double>(*(static_cast<uint64_t *>(value))); break;
+        case STAT_TYPE_INT64: numericValue = static_cast<double>(*(static_cast<int64_t *>(value))); break;
+        default: rv = false; break;
+    }
+
+    return rv;
+}
+
+void StatBase::PrintValue( std::ostream& stream )
+{
+    switch( valueType )
+    {
+        case STAT_TYPE_INT: stream << *(static_cast<int *>(value)); break;
+        case STAT_TYPE_FLOAT: stream << *(static_cast<float *>(value)); break;
+        case STAT_TYPE_DOUBLE: stream << *(static_cast<double *>(value)); break;
+        case STAT_TYPE_UINT64: stream << *(static_cast<uint64_t *>(value)); break;
+        case STAT_TYPE_INT64: stream << *(static_cast<int64_t *>(value)); break;
+        case STAT_TYPE_STRING: stream << *(static_cast<std::string *>(value)); break;
+        case STAT_TYPE_HISTOGRAM: static_cast<Histogram *>(value)->Print( stream ); break;
+        default: stream << "?????"; break;
+    }
+}
+
+std::string StatBase::GetText( )
+{
+    if( valueType == STAT_TYPE_STRING )
+        return *(static_cast<std::string *>(value));
+
+    std::stringstream text;
+
+    PrintValue( text );
+
+    return text.str( );
 }
 
 void StatBase::Print( std::ostream& stream, ncounter_t psInterval )
 {
-    stream << "i" << psInterval << "." << name << " ";
+    stream << "i" << psInterval << "." << *name << " ";
+    PrintValue( stream );
+    stream << units << "\n";
+}
+
+
+Histogram::Histogram( )
+{
+    SetBuckets( 1.0, 64, 8 );
+}
+
+void Histogram::SetBuckets( double bucketWidth, ncounter_t linearBuckets, ncounter_t logRanges )
+{
+    this->bucketWidth = bucketWidth;
+    this->linearBuckets = (linearBuckets > 0) ? linearBuckets : 1;
+    this->logRanges = (this->linearBuckets >= 2) ? logRanges : 0;
+    rangeBuckets = this->linearBuckets / 2;
 
-    if( statType == typeid(int).name() ) stream << *(static_cast<int *>(value));
-    else if( statType == typeid(float).name() ) stream << *(static_cast<float *>(value));
-    else if( statType == typeid(double).name() ) stream << *(static_cast<double *>(value));
-    else if( statType == typeid(ncounter_t).name() ) stream << *(static_cast<ncounter_t *>(value));
-    else if( statType == typeid(ncounters_t).name() ) stream << *(static_cast<ncounters_t *>(value));
-    else if( statType == typeid(ncycle_t).name() ) stream << *(static_cast<ncycle_t *>(value));
-    else if( statType == typeid(ncycles_t).name() ) stream << *(static_cast<ncycles_t *>(value));
-    else if( statType == typeid(std::string).name() ) stream << *(static_cast<std::string *>(value));
-    else stream << "?????";
+    /* The last bucket counts the overflows. */
+    buckets.assign( this->linearBuckets + this->logRanges * rangeBuckets + 1, 0 );
+    samples = 0;
+}
+
+/*
+ *  Log range r holds [linearBuckets * 2^r, linearBuckets * 2^(r+1)) in 
+ *  units of bucketWidth, in rangeBuckets buckets 2^(r+1) units wide.
+ */
+ncounter_t Histogram::GetBucket( double value )
+{
+    double units = value / bucketWidth;
+    ncounter_t rv;
+
+    /* Also catches NaN. */
+    if( !(units >= 1.0) )
+    {
+        rv = 0;
+    }
+    else if( units < static_cast<double>( linearBuckets ) )
+    {
+        rv = static_cast<ncounter_t>( units );
+    }
+    else
+    {
+        int range = std::ilogb( units / static_cast<double>( linearBuckets ) );
+
+        if( range >= static_cast<int>( logRanges ) )
+        {
+            rv = GetOverflowBucket( );
+        }
+        else
+        {
+            double rangeStart = std::ldexp( static_cast<double>( linearBuckets ), range );
+            ncounter_t offset = static_cast<ncounter_t>( std::ldexp( units - rangeStart, -(range + 1) ) );
+
+            if( offset >= rangeBuckets )
+                offset = rangeBuckets - 1;
+
+            rv = linearBuckets + range * rangeBuckets + offset;
+        }
+    }
+
+    return rv;
+}
+
+double Histogram::GetBucketStart( ncounter_t bucket )
+{
+    double units;
+
+    if( bucket < linearBuckets )
+    {
+        units = static_cast<double>( bucket );
+    }
+    else if( bucket == GetOverflowBucket( ) )
+    {
+        units = std::ldexp( static_cast<double>( linearBuckets ), static_cast<int>( logRanges ) );
+    }
+    else
+    {
+        int range = static_cast<int>( (bucket - linearBuckets) / rangeBuckets );
+        ncounter_t offset = (bucket - linearBuckets) % rangeBuckets;
+
+        units = std::ldexp( static_cast<double>( linearBuckets + 2 * offset ), range );
+    }
 
-    stream << units << std::endl;
+    return units * bucketWidth;
 }
 
+bool Histogram::Merge( const Histogram& other )
+{
+    if( other.bucketWidth != bucketWidth || other.linearBuckets != linearBuckets
+        || other.logRanges != logRanges )
+        return false;
+
+    for( size_t bucketIdx = 0; bucketIdx < buckets.size( ); bucketIdx++ )
+        buckets[bucketIdx] += other.buckets[bucketIdx];
+
+    samples += other.samples;
+
+    return true;
+}
+
+void Histogram::Reset( )
+{
+    std::fill( buckets.begin( ), buckets.end( ), 0 );
+    samples = 0;
+}
+
+void Histogram::Print( std::ostream& stream )
+{
+    bool outputComma = false;
+
+    stream << "{";
+
+    for( ncounter_t bucketIdx = 0; bucketIdx < buckets.size( ); bucketIdx++ )
+    {
+        if( buckets[bucketIdx] == 0 )
+            continue;
+
+        if( outputComma )
+            stream << ", ";
+
+        if( bucketIdx == GetOverflowBucket( ) )
+            stream << "'>=" << GetBucketStart( bucketIdx ) << "': " << buckets[bucketIdx];
+        else
+            stream << GetBucketStart( bucketIdx ) << ": " << buckets[bucketIdx];
 
+        outputComma = true;
+    }
+
+    stream << "}";
+}
+
+void Histogram::CreateCheckpoint( Checkpoint& cpt )
+{
+    cpt.Write( bucketWidth );
+    cpt.Write( linearBuckets );
+    cpt.Write( logRanges );
+    cpt.Write( samples );
+    cpt.WriteArray( &buckets[0], buckets.size( ) );
+}
+
+bool Histogram::RestoreCheckpoint( Checkpoint& cpt )
+{
+    double cptBucketWidth = 0.0;
+    ncounter_t cptLinearBuckets = 0, cptLogRanges = 0, cptSamples = 0;
+
+    cpt.Read( cptBucketWidth );
+    cpt.Read( cptLinearBuckets );
+    cpt.Read( cptLogRanges );
+    cpt.Read( cptSamples );
+
+    Histogram restored;
+
+    restored.SetBuckets( cptBucketWidth, cptLinearBuckets, cptLogRanges );
+    cpt.ReadArray( &restored.buckets[0], restored.buckets.size( ) );
+    restored.samples = cptSamples;
+
+    if( !cpt.Good( ) || restored.bucketWidth != bucketWidth 
+        || restored.linearBuckets != linearBuckets || restored.logRanges != logRanges )
+        return false;
+
+    buckets.swap( restored.buckets );
+    samples = restored.samples;
+
+    return true;
+}
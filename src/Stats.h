@@ -59,6 +59,9 @@
 // CHLD = NVMObject_hook, STAT = std::string; returns StatType
 #define GetStat(CHLD, STAT) (CHLD->GetStats( )->getStat( CHLD->StatName( ) + "." + STAT ) )
 
+// CHLD = NVMObject_hook, STAT = std::string; returns StatHandle
+#define GetStatHandle(CHLD, STAT) (CHLD->GetStats( )->getStatHandle( CHLD->StatName( ) + "." + STAT ) )
+
 // STAT = StatType, TYPE = any type; returns TYPE
 #define CastStat(STAT, TYPE) (*(static_cast< TYPE * >( STAT )))
 
@@ -67,6 +70,8 @@
 #include <ostream>
 #include <typeinfo>
 #include <vector>
+#include <string>
+#include <unordered_map>
 #include <cstring>
 
 #include "include/NVMTypes.h"
@@ -76,6 +81,90 @@ namespace NVM {
 
 typedef void * StatType;
 
+/* 
+ *  Position of a stat in the registry. Handles stay valid for the life of
+ *  the Stats object; removing a stat only invalidates its own handle.
+ */
+typedef ncounter_t StatHandle;
+
+const StatHandle InvalidStatHandle = static_cast<StatHandle>( -1 );
+
+/* 
+ *  Type tag of a stat, set from its type when it is registered. The values
+ *  are written in binary stats files and must not be renumbered.
+ */
+enum StatValueType
+{
+    STAT_TYPE_INT = 0,      /***< int */
+    STAT_TYPE_FLOAT = 1,    /***< float */
+    STAT_TYPE_DOUBLE = 2,   /***< double */
+    STAT_TYPE_UINT64 = 3,   /***< ncounter_t, ncycle_t and uint64_t */
+    STAT_TYPE_INT64 = 4,    /***< ncounters_t, ncycles_t and int64_t */
+    STAT_TYPE_STRING = 5,   /***< std::string */
+    STAT_TYPE_UNKNOWN = 6,  /***< Printed as ?????, skipped by other writers */
+    STAT_TYPE_HISTOGRAM = 7 /***< Histogram, written as its bucket starts and counts */
+};
+
+class StatsWriter;
+class Checkpoint;
+
+/*
+ *  Histogram with a fixed set of buckets. Values below linearBuckets *
+ *  bucketWidth go in buckets bucketWidth wide. Above that, each of the
+ *  logRanges power-of-two ranges is split into linearBuckets / 2 buckets,
+ *  so a bucket is at most 2 / linearBuckets of its values wide. Values
+ *  past the last range are counted in a separate overflow bucket, which
+ *  is the last bucket, and negative values in the first.
+ *
+ *  Recording is O(1) and does not allocate. Histograms with the same
+ *  buckets can be merged by adding their counts.
+ */
+class Histogram
+{
+  public:
+    Histogram( );
+    ~Histogram( ) { }
+
+    /* Clears the counts. linearBuckets must be even if logRanges > 0. */
+    void SetBuckets( double bucketWidth, ncounter_t linearBuckets, ncounter_t logRanges );
+
+    void Record( double value ) 
+    { 
+        buckets[GetBucket( value )]++; 
+        samples++;
+    }
+
+    /* False if other has different buckets. */
+    bool Merge( const Histogram& other );
+    void Reset( );
+
+    ncounter_t GetBucket( double value );
+    ncounter_t GetBucketCount( ) { return buckets.size( ); }
+    ncounter_t GetOverflowBucket( ) { return buckets.size( ) - 1; }
+    double GetBucketStart( ncounter_t bucket );
+    ncounter_t GetBucketSamples( ncounter_t bucket ) { return buckets[bucket]; }
+    ncounter_t GetSampleCount( ) { return samples; }
+
+    /* 
+     *  The non-empty buckets as a python-style dict of bucket start: count.
+     *  The overflow bucket is printed as '>=start': count.
+     */
+    void Print( std::ostream& stream );
+
+    void CreateCheckpoint( Checkpoint& cpt );
+    /* False if the checkpoint has different buckets, which are skipped. */
+    bool RestoreCheckpoint( Checkpoint& cpt );
+
+  private:
+    double bucketWidth;
+    ncounter_t linearBuckets;
+    ncounter_t logRanges;
+    ncounter_t rangeBuckets;
+    std::vector<ncounter_t> buckets;
+    ncounter_t samples;
+};
+
+
 
 class StatBase
 {
@@ -85,9 +174,15 @@ class StatBase
 
     void Reset( );
     void Print( std::ostream& stream, ncounter_t psInterval );
+    void PrintValue( std::ostream& stream );
+    /* False for stats that are not numbers, e.g., std::string. */
+    bool GetNumericValue( double& numericValue );
+    /* The value as text stats print it. */
+    std::string GetText( );
 
-    std::string GetName( ) { return name; }
-    void SetName( std::string n ) { name = n; }
+    /* Names are interned by Stats, which owns the string. */
+    const std::string& GetName( ) { return *name; }
+    void SetName( const std::string *n ) { name = n; }
 
     void* GetValue( ) { return value; }
     void SetValue( StatType val ) { value = val; }
@@ -98,12 +193,15 @@ class StatBase
     void SetResetValue( StatType rval ) { resetValue = rval; }
     void *GetResetValue( ) { return resetValue; }
 
-    void SetStatType( std::string st, size_t ts ) { statType = st; typeSize = ts; }
+    void SetStatType( std::string st, size_t ts );
     size_t GetTypeSize( ) { return typeSize; }
     std::string GetTypeName() { return statType; }
+    StatValueType GetValueType( ) { return valueType; }
 
   private:
-    std::string name, statType, units;
+    const std::string *name;
+    std::string statType, units;
+    StatValueType valueType;
     size_t typeSize;
     StatType resetValue;
     StatType value;
@@ -115,16 +213,65 @@ class Stats
     Stats( );
     ~Stats( );
 
-    void addStat( StatType stat, StatType resetValue, std::string statType, size_t typeSize, std::string name, std::string units );
+    StatHandle addStat( StatType stat, StatType resetValue, std::string statType, size_t typeSize, std::string name, std::string units );
     void removeStat( StatType stat );
     StatType getStat( std::string name );
 
+    /* Look up a handle once, then get the stat without hashing its name. */
+    StatHandle getStatHandle( const std::string& name );
+    StatType getStat( StatHandle handle );
+
+    /* Every stat named name, or whose name ends in "." + name. */
+    void findStatHandles( const std::string& name, std::vector<StatHandle>& handles );
+    bool getNumericValue( StatHandle handle, double& numericValue );
+    std::string getStatName( StatHandle handle );
+
     void PrintAll( std::ostream& );
     void ResetAll( );
 
+    /* PrintAll writes with writer, which Stats deletes. The default is text. */
+    void SetWriter( StatsWriter *writer );
+    StatsWriter *GetWriter( ) { return statsWriter; }
+
+    /* 
+     *  Sampling: AddSample records the value of every numeric stat as one
+     *  sample. The confidence interval of a mean uses the normal
+     *  distribution, so it needs about 30 samples to be accurate.
+     */
+    void AddSample( );
+    ncounter_t GetSampleCount( );
+    double GetSampleError( std::string name, double confidence );
+    void PrintSamples( std::ostream& stream, double confidence );
+
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   private: 
+    /* Removed stats leave a NULL entry so the other handles do not move. */
     std::vector<StatBase *> statList;
+    ncounter_t liveStats;
     ncounter_t psInterval;
+    StatsWriter *statsWriter;
+
+    /* 
+     *  The first live stat registered with each name, and how many live
+     *  stats share the name. The keys are the interned stat names.
+     */
+    struct NameEntry
+    {
+        StatHandle handle;
+        ncounter_t count;
+    };
+
+    std::unordered_map<std::string, NameEntry> nameIndex;
+    std::unordered_map<StatType, StatHandle> valueIndex;
+
+    ncounter_t sampleCount;
+    std::vector<double> sampleSums;
+    std::vector<double> sampleSquares;
+
+    double GetHalfWidth( size_t statIdx, double confidence );
+    ncounter_t GetLiveStatCount( );
 };
 
 
@@ -35,6 +35,7 @@
 #include "src/Bank.h"
 #include "src/MemoryController.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
 #include "include/NVMHelpers.h"
 #include "Endurance/EnduranceModelFactory.h"
 #include "Endurance/NullModel/NullModel.h"
@@ -93,7 +94,7 @@ SubArray::SubArray( )
     writeEnd = 0;
     writeStart = 0;
     writeEventTime = 0;
-    writeEvent = NULL;
+    writeEvent = EventHandle( );
     writeRequest = NULL;
     nextActivatePreWrite = 0;
     nextPrechargePreWrite = 0;
@@ -126,10 +127,11 @@ SubArray::SubArray( )
     num01Writes = 0;
     num10Writes = 0;
     num11Writes = 0;
-    mlcTimingHisto = "";
-    cancelCountHisto = "";
-    wpPauseHisto = "";
-    wpCancelHisto = "";
+    /* Write times in cycles, cancellations and write progress in percent. */
+    mlcTimingHisto.SetBuckets( 1.0, 128, 6 );
+    cancelCountHisto.SetBuckets( 1.0, 16, 4 );
+    wpPauseHisto.SetBuckets( 0.01, 101, 0 );
+    wpCancelHisto.SetBuckets( 0.01, 101, 0 );
     averageWriteTime = 0.0;
     measuredWriteTimes = 0;
     averageWriteIterations = 1;
@@ -652,27 +654,6 @@ bool SubArray::Write( NVMainRequest *request )
     writeEventTime = GetEventQueue()->GetCurrentCycle() + p->tCWD 
                      + MAX( p->tBURST, p->tCCD ) * request->burstCount + writeTimer;
 
-    /* The parent has our hook in the children list, we need to find this. */
-    std::vector<NVMObject_hook *>& children = GetParent( )->GetTrampoline( )->GetChildren( );
-    std::vector<NVMObject_hook *>::iterator it;
-    NVMObject_hook *hook = NULL;
-
-    for( it = children.begin(); it != children.end(); it++ )
-    {
-        if( (*it)->GetTrampoline() == this )
-        {
-            hook = (*it);
-            break;
-        }
-    }
-
-    assert( hook != NULL );
-
-    writeEvent = new NVM::Event( );
-    writeEvent->SetType( EventResponse );
-    writeEvent->SetRecipient( hook );
-    writeEvent->SetRequest( request );
-
     /* Issue a bus burst request when the burst starts. */
     NVMainRequest *busReq = new NVMainRequest( );
     *busReq = *request;
@@ -683,7 +664,7 @@ bool SubArray::Write( NVMainRequest *request )
             GetEventQueue()->GetCurrentCycle() + p->tCWD );
 
     /* Notify owner of write completion as well */
-    GetEventQueue( )->InsertEvent( writeEvent, writeEventTime );
+    writeEvent = GetEventQueue( )->InsertEvent( EventResponse, this, request, writeEventTime );
 
     /* Calculate energy. */
     if( p->EnergyModel == "current" )
@@ -874,10 +855,7 @@ void SubArray::CheckWritePausing( )
                 pausedWrites++;
             }
 
-            if( wpPauseMap.count( writePercent ) )
-                wpPauseMap[writePercent]++;
-            else
-                wpPauseMap[writePercent] = 1;
+            wpPauseHisto.Record( writePercent );
         }
         else
         {
@@ -890,16 +868,12 @@ void SubArray::CheckWritePausing( )
             cancelledWrites++;
             cancelledWriteTime += GetEventQueue()->GetCurrentCycle() - writeStart;
 
-            if( wpCancelMap.count( writePercent ) )
-                wpCancelMap[writePercent]++;
-            else
-                wpCancelMap[writePercent] = 1;
+            wpCancelHisto.Record( writePercent );
         }
 
         /* Delete the old event indicating write completion. */
-        GetEventQueue( )->RemoveEvent( writeEvent, writeEventTime );
-        delete writeEvent;
-        writeEvent = NULL;
+        GetEventQueue( )->RemoveEvent( writeEvent );
+        writeEvent = EventHandle( );
 
         /* Return this write as paused/cancelled. */
         GetEventQueue( )->InsertEvent( EventResponse, this, writeRequest,
@@ -1083,10 +1057,7 @@ ncycle_t SubArray::WriteCellData( NVMainRequest *request )
 
         maxDelay = oncePulseDelay + thisPulseCount * repeatPulseDelay;
 
-        if( mlcTimingMap.count( maxDelay ) > 0 )
-            mlcTimingMap[maxDelay]++;
-        else
-            mlcTimingMap[maxDelay] = 1;
+        mlcTimingHisto.Record( static_cast<double>( maxDelay ) );
 
         if( maxDelay > worstCaseWrite )
             worstCaseWrite = maxDelay;
@@ -1268,6 +1239,23 @@ bool SubArray::IssueCommand( NVMainRequest *req )
     return rv;
 }
 
+/*
+ *  An atomic write changes the cells without being timed, so only the data
+ *  encoder and the endurance model see it.
+ */
+bool SubArray::IssueAtomic( NVMainRequest *req )
+{
+    if( req->type == WRITE || req->type == WRITE_PRECHARGE )
+    {
+        if( dataEncoder )
+            dataEncoder->Write( req );
+
+        UpdateEndurance( req );
+    }
+
+    return true;
+}
+
 bool SubArray::RequestComplete( NVMainRequest *req )
 {
     if( req->type == WRITE || req->type == WRITE_PRECHARGE )
@@ -1288,10 +1276,7 @@ bool SubArray::RequestComplete( NVMainRequest *req )
                                     + req->cancellations) / static_cast<double>(measuredPauses + 1.0);
             measuredPauses++;
 
-            if( cancelCountMap.count( req->cancellations ) == 0 )
-                cancelCountMap[req->cancellations] = 0;
-            else
-                cancelCountMap[req->cancellations]++;
+            cancelCountHisto.Record( static_cast<double>( req->cancellations ) );
         }
     }
 
@@ -1398,6 +1383,8 @@ ncycle_t SubArray::UpdateEndurance( NVMainRequest *request )
                      !conf->GetSimInterface( )-> GetDataAtAddress( 
                         request->address.GetPhysicalAddress( ), &oldData ) )
             {
+                oldData.SetSize( wordSize );
+
                 for( uint64_t i = 0; i < wordSize; i++ )
                   oldData.SetByte( i, 0 );
             }
@@ -1472,12 +1459,97 @@ void SubArray::CalculateStats( )
     averageEndurance = endrModel->GetAverageLife( );
 
     actWaitAverage = static_cast<double>(actWaitTotal) / static_cast<double>(actWaits);
+}
+
+/*
+ *  No write is in flight when a checkpoint is taken, so the write event
+ *  and request are not saved.
+ */
+void SubArray::CreateCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( !writeBackRequests.empty( ) )
+    {
+        std::cout << "NVMain: Warning: " << StatName( ) << " has " 
+                  << writeBackRequests.size( ) << " pending write-backs which "
+                  << "are not saved in the checkpoint." << std::endl;
+    }
+
+    if( cpt.Create( Checkpoint::File( dir, StatName( ) ) ) )
+    {
+        cpt.Write( state );
+        cpt.Write( lastActivate );
+        cpt.Write( nextActivate );
+        cpt.Write( nextPrecharge );
+        cpt.Write( nextRead );
+        cpt.Write( nextWrite );
+        cpt.Write( nextPowerDown );
+        cpt.Write( writeCycle );
+        cpt.Write( isWriting );
+        cpt.Write( writeEnd );
+        cpt.Write( writeStart );
+        cpt.WriteSequence( writeIterationStarts );
+        cpt.Write( writeEventTime );
+        cpt.Write( nextActivatePreWrite );
+        cpt.Write( nextPrechargePreWrite );
+        cpt.Write( nextReadPreWrite );
+        cpt.Write( nextWritePreWrite );
+        cpt.Write( nextPowerDownPreWrite );
+        cpt.Write( dataCycles );
+        cpt.Write( idleTimer );
+        cpt.Write( openRow );
+
+        if( endrModel )
+            endrModel->WriteCheckpoint( cpt );
+
+        if( dataEncoder )
+            dataEncoder->WriteCheckpoint( cpt );
+
+        cpt.Close( );
+    }
+
+    NVMObject::CreateCheckpoint( dir );
+}
+
+void SubArray::RestoreCheckpoint( std::string dir )
+{
+    Checkpoint cpt;
+
+    if( cpt.Open( Checkpoint::File( dir, StatName( ) ) ) )
+    {
+        cpt.Read( state );
+        cpt.Read( lastActivate );
+        cpt.Read( nextActivate );
+        cpt.Read( nextPrecharge );
+        cpt.Read( nextRead );
+        cpt.Read( nextWrite );
+        cpt.Read( nextPowerDown );
+        cpt.Read( writeCycle );
+        cpt.Read( isWriting );
+        cpt.Read( writeEnd );
+        cpt.Read( writeStart );
+        cpt.ReadSequence( writeIterationStarts );
+        cpt.Read( writeEventTime );
+        cpt.Read( nextActivatePreWrite );
+        cpt.Read( nextPrechargePreWrite );
+        cpt.Read( nextReadPreWrite );
+        cpt.Read( nextWritePreWrite );
+        cpt.Read( nextPowerDownPreWrite );
+        cpt.Read( dataCycles );
+        cpt.Read( idleTimer );
+        cpt.Read( openRow );
+
+        if( endrModel )
+            endrModel->ReadCheckpoint( cpt );
+
+        if( dataEncoder )
+            dataEncoder->ReadCheckpoint( cpt );
+
+        cpt.Close( );
+    }
 
-    /* Print a histogram as a python-style dict. */
-    mlcTimingHisto = PyDictHistogram<uint64_t, uint64_t>( mlcTimingMap );
-    cancelCountHisto = PyDictHistogram<uint64_t, uint64_t>( cancelCountMap );
-    wpPauseHisto = PyDictHistogram<double, uint64_t>( wpPauseMap );
-    wpCancelHisto = PyDictHistogram<double, uint64_t>( wpCancelMap );
+    NVMObject::RestoreCheckpoint( dir );
 }
 
 bool SubArray::Idle( )
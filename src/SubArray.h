@@ -44,13 +44,12 @@
 #include "include/NVMAddress.h"
 #include "include/NVMainRequest.h"
 #include "src/Params.h"
+#include "src/EventQueue.h"
 
 #include <iostream>
 
 namespace NVM {
 
-class Event;
-
 /*
  *  We only use four subarray states because we use distributed timing control
  *  No PowerDown state is implemented since it does not make sense to apply 
@@ -91,6 +90,7 @@ class SubArray : public NVMObject
 
     bool IsIssuable( NVMainRequest *req, FailReason *reason = NULL );
     bool IssueCommand( NVMainRequest *req );
+    bool IssueAtomic( NVMainRequest *req );
     bool RequestComplete( NVMainRequest *req );
     ncycle_t NextIssuable( NVMainRequest *request );
 
@@ -116,6 +116,9 @@ class SubArray : public NVMObject
     void RegisterStats( );
     void CalculateStats( );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
     ncounter_t GetId( );
     std::string GetName( );
 
@@ -146,7 +149,7 @@ class SubArray : public NVMObject
     ncycle_t writeStart;
     std::set<ncycle_t> writeIterationStarts;
     NVMainRequest *writeRequest;
-    NVM::Event *writeEvent;
+    NVM::EventHandle writeEvent;
     ncycle_t writeEventTime;
     WriteMode writeMode;
     ncycle_t nextActivatePreWrite;
@@ -194,14 +197,10 @@ class SubArray : public NVMObject
 
     ncounter_t subArrayId;
  
-    std::map<uint64_t, uint64_t> mlcTimingMap;
-    std::map<uint64_t, uint64_t> cancelCountMap;
-    std::map<double, uint64_t> wpPauseMap;
-    std::map<double, uint64_t> wpCancelMap;
-    std::string mlcTimingHisto;
-    std::string cancelCountHisto;
-    std::string wpPauseHisto;
-    std::string wpCancelHisto;
+    Histogram mlcTimingHisto;
+    Histogram cancelCountHisto;
+    Histogram wpPauseHisto;
+    Histogram wpCancelHisto;
 
     ncycle_t WriteCellData( NVMainRequest *request );
     void CheckWritePausing( );
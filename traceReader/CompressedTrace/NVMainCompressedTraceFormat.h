@@ -0,0 +1,98 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAINCOMPRESSEDTRACEFORMAT_H__
+#define __NVMAINCOMPRESSEDTRACEFORMAT_H__
+
+#include "traceReader/NVMainBinaryTrace/NVMainBinaryTraceFormat.h"
+#include <stdint.h>
+
+namespace NVM {
+
+/*
+ *  NVMain compressed trace (NVMC) layout. The records are the same as in an
+ *  NVMB binary trace (see NVMainBinaryTraceFormat.h). They are grouped
+ *  into blocks of up to blockRecords records, and each block is compressed
+ *  on its own:
+ *
+ *    header | block | block | ... | index
+ *
+ *  Each block is an NVMCompressedTraceBlock followed by compressedSize
+ *  bytes. A block with compressedSize equal to rawSize is stored as-is.
+ *  The index holds one NVMCompressedTraceIndexEntry per block, giving the
+ *  cycle of the block's first record and the file offset of the block, so
+ *  a reader can start at any cycle without decompressing earlier blocks.
+ *
+ *  indexOffset is 0 if the writer did not finish. Readers then rebuild the
+ *  index by walking the block headers, ignoring a truncated last block.
+ */
+#define NVMC_MAGIC "NVMC"
+
+const uint32_t NVMC_VERSION = 1;
+
+struct NVMCompressedTraceHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t codec;         /* One of the TRACE_CODEC values. */
+    uint32_t flags;         /* NVMB_HAS_DATA and NVMB_HAS_OLDDATA. */
+    uint32_t dataSize;      /* Bytes in each data or old data payload. */
+    uint32_t recordSize;    /* Bytes per record, including payloads. */
+    uint32_t blockRecords;  /* Records per block; the last may have fewer. */
+    uint32_t reserved;
+    uint64_t indexOffset;
+    uint64_t blockCount;
+};
+
+struct NVMCompressedTraceBlock
+{
+    uint64_t firstCycle;
+    uint32_t records;
+    uint32_t rawSize;
+    uint32_t compressedSize;
+    uint32_t reserved;
+};
+
+struct NVMCompressedTraceIndexEntry
+{
+    uint64_t firstCycle;
+    uint64_t offset;
+};
+
+static_assert( sizeof(NVMCompressedTraceHeader) == 48, "NVMC header must be 48 bytes" );
+static_assert( sizeof(NVMCompressedTraceBlock) == 24, "NVMC block header must be 24 bytes" );
+static_assert( sizeof(NVMCompressedTraceIndexEntry) == 16, "NVMC index entry must be 16 bytes" );
+
+};
+
+#endif
@@ -0,0 +1,403 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/CompressedTrace/NVMainCompressedTraceReader.h"
+#include <cstring>
+
+using namespace NVM;
+
+NVMainCompressedTraceReader::NVMainCompressedTraceReader( )
+{
+    traceFile = "";
+    traceOpened = false;
+    traceValid = false;
+
+    memset( &header, 0, sizeof(header) );
+
+    blockRecords = 0;
+    nextRecord = 0;
+    nextBlock = 0;
+}
+
+NVMainCompressedTraceReader::~NVMainCompressedTraceReader( )
+{
+    if( trace.is_open( ) )
+        trace.close( );
+}
+
+void NVMainCompressedTraceReader::SetTraceFile( std::string file )
+{
+    traceFile = file;
+}
+
+std::string NVMainCompressedTraceReader::GetTraceFile( )
+{
+    return traceFile;
+}
+
+bool NVMainCompressedTraceReader::OpenTrace( )
+{
+    traceOpened = true;
+
+    trace.open( traceFile.c_str( ), std::ifstream::in | std::ifstream::binary );
+    if( !trace.is_open( ) )
+    {
+        std::cerr << "Could not open trace file: " << traceFile << "!" << std::endl;
+        return false;
+    }
+
+    trace.seekg( 0, std::ifstream::end );
+    uint64_t fileSize = static_cast<uint64_t>( trace.tellg( ) );
+    trace.seekg( 0, std::ifstream::beg );
+
+    trace.read( reinterpret_cast<char *>( &header ), sizeof(header) );
+
+    if( !trace.good( ) || memcmp( header.magic, NVMC_MAGIC, sizeof(header.magic) ) != 0 )
+    {
+        std::cerr << "NVMainCompressedTraceReader: " << traceFile 
+            << " is not a compressed trace." << std::endl;
+        return false;
+    }
+
+    if( header.version != NVMC_VERSION )
+    {
+        std::cerr << "NVMainCompressedTraceReader: Unsupported trace version " 
+            << header.version << " (expected " << NVMC_VERSION 
+            << "). A trace written on a machine with the other byte order "
+            << "must be converted again." << std::endl;
+        return false;
+    }
+
+    if( !TraceCompressor::IsSupported( header.codec ) )
+    {
+        std::cerr << "NVMainCompressedTraceReader: " << traceFile << " uses the " 
+            << TraceCompressor::GetCodecName( header.codec ) 
+            << " codec, which this build does not support." << std::endl;
+        return false;
+    }
+
+    uint64_t payloads = 0;
+
+    if( header.flags & NVMB_HAS_DATA )
+        payloads++;
+    if( header.flags & NVMB_HAS_OLDDATA )
+        payloads++;
+
+    if( header.recordSize != sizeof(NVMBinaryTraceRecord) + payloads * header.dataSize )
+    {
+        std::cerr << "NVMainCompressedTraceReader: Record size " << header.recordSize
+            << " does not match the header of " << traceFile << "." << std::endl;
+        return false;
+    }
+
+    if( !ReadIndex( fileSize ) )
+        RebuildIndex( fileSize );
+
+    if( header.flags & NVMB_HAS_DATA )
+        dataBlock.SetSize( header.dataSize );
+    if( header.flags & NVMB_HAS_OLDDATA )
+        oldDataBlock.SetSize( header.dataSize );
+
+    traceValid = true;
+
+    return true;
+}
+
+bool NVMainCompressedTraceReader::ReadIndex( uint64_t fileSize )
+{
+    uint64_t indexSize = header.blockCount * sizeof(NVMCompressedTraceIndexEntry);
+
+    if( header.indexOffset == 0 || header.indexOffset > fileSize 
+        || fileSize - header.indexOffset < indexSize )
+        return false;
+
+    index.resize( header.blockCount );
+
+    if( header.blockCount > 0 )
+    {
+        trace.seekg( header.indexOffset );
+        trace.read( reinterpret_cast<char *>( &index[0] ), indexSize );
+    }
+
+    if( !trace.good( ) )
+    {
+        trace.clear( );
+        index.clear( );
+        return false;
+    }
+
+    return true;
+}
+
+/* 
+ *  The writer did not finish, so walk the block headers instead. A block
+ *  that runs past the end of the file was cut short and is dropped.
+ */
+void NVMainCompressedTraceReader::RebuildIndex( uint64_t fileSize )
+{
+    uint64_t offset = sizeof(header);
+
+    std::cout << "NVMainCompressedTraceReader: " << traceFile 
+        << " has no index; rebuilding it from the block headers." << std::endl;
+
+    index.clear( );
+
+    while( fileSize - offset >= sizeof(NVMCompressedTraceBlock) )
+    {
+        NVMCompressedTraceBlock block;
+
+        trace.seekg( offset );
+        trace.read( reinterpret_cast<char *>( &block ), sizeof(block) );
+
+        if( !trace.good( ) 
+            || fileSize - offset - sizeof(block) < block.compressedSize )
+            break;
+
+        NVMCompressedTraceIndexEntry entry;
+
+        entry.firstCycle = block.firstCycle;
+        entry.offset = offset;
+        index.push_back( entry );
+
+        offset += sizeof(block) + block.compressedSize;
+    }
+
+    trace.clear( );
+}
+
+bool NVMainCompressedTraceReader::LoadBlock( ncounter_t block )
+{
+    NVMCompressedTraceBlock blockHeader;
+
+    trace.seekg( index[block].offset );
+    trace.read( reinterpret_cast<char *>( &blockHeader ), sizeof(blockHeader) );
+
+    if( !trace.good( ) 
+        || static_cast<uint64_t>( blockHeader.records ) * header.recordSize != blockHeader.rawSize )
+    {
+        std::cerr << "NVMainCompressedTraceReader: Block " << block << " of " 
+            << traceFile << " is corrupt." << std::endl;
+        return false;
+    }
+
+    compressedBlock.resize( blockHeader.compressedSize );
+    rawBlock.resize( blockHeader.rawSize );
+
+    if( blockHeader.compressedSize > 0 )
+        trace.read( reinterpret_cast<char *>( &compressedBlock[0] ), blockHeader.compressedSize );
+
+    uint32_t codec = header.codec;
+
+    /* Blocks that did not compress are stored as-is. */
+    if( blockHeader.compressedSize == blockHeader.rawSize )
+        codec = TRACE_CODEC_STORED;
+
+    if( !trace.good( ) 
+        || (blockHeader.rawSize > 0 
+            && !compressor.Decompress( codec, &compressedBlock[0], compressedBlock.size( ),
+                                       &rawBlock[0], rawBlock.size( ) )) )
+    {
+        std::cerr << "NVMainCompressedTraceReader: Could not decompress block " 
+            << block << " of " << traceFile << "." << std::endl;
+        return false;
+    }
+
+    blockRecords = blockHeader.records;
+    nextRecord = 0;
+    nextBlock = block + 1;
+
+    return true;
+}
+
+/* Load blocks until one has a record left; false at the end of the trace. */
+bool NVMainCompressedTraceReader::NextRecordReady( )
+{
+    while( nextRecord == blockRecords )
+    {
+        if( nextBlock == index.size( ) || !LoadBlock( nextBlock ) )
+        {
+            nextBlock = index.size( );
+            blockRecords = 0;
+            nextRecord = 0;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ncycle_t NVMainCompressedTraceReader::NextRecordCycle( )
+{
+    NVMBinaryTraceRecord record;
+
+    memcpy( &record, &rawBlock[nextRecord * header.recordSize], sizeof(record) );
+
+    return record.cycle;
+}
+
+/*
+ *  Position the reader on the first record at or after the given cycle,
+ *  assuming records are in cycle order. Only the block that may hold the
+ *  cycle, and any after it that do not, are decompressed.
+ */
+bool NVMainCompressedTraceReader::SeekToCycle( ncycle_t cycle )
+{
+    if( !traceOpened )
+        OpenTrace( );
+
+    if( !traceValid )
+        return false;
+
+    /* Last block starting before the cycle; later records may reach it. */
+    ncounter_t first = 0;
+    ncounter_t last = index.size( );
+
+    while( first < last )
+    {
+        ncounter_t middle = first + (last - first) / 2;
+
+        if( index[middle].firstCycle < cycle )
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    nextBlock = (first > 0) ? first - 1 : 0;
+    blockRecords = 0;
+    nextRecord = 0;
+
+    while( NextRecordReady( ) && NextRecordCycle( ) < cycle )
+        nextRecord++;
+
+    return true;
+}
+
+bool NVMainCompressedTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    /* If there is no trace file, we can't do anything. */
+    if( traceFile == "" )
+    {
+        std::cerr << "No trace file specified!" << std::endl;
+        return false;
+    }
+
+    if( !traceOpened )
+        OpenTrace( );
+
+    if( !traceValid )
+        return false;
+
+    /* There are no more records in the trace... Send back a "dummy" line */
+    if( !NextRecordReady( ) )
+    {
+        NVMAddress nAddress;
+        nAddress.SetPhysicalAddress( 0xDEADC0DEDEADBEEFULL );
+        nextAccess->SetLine( nAddress, NOP, 0, emptyBlock, emptyBlock, 0 );
+        std::cout << "NVMainCompressedTraceReader: Reached EOF!" << std::endl;
+        return false;
+    }
+
+    NVMBinaryTraceRecord record;
+    const uint8_t *recordData = &rawBlock[nextRecord * header.recordSize];
+    const uint8_t *payload = recordData + sizeof(record);
+
+    memcpy( &record, recordData, sizeof(record) );
+
+    if( header.flags & NVMB_HAS_DATA )
+    {
+        memcpy( dataBlock.rawData, payload, header.dataSize );
+        payload += header.dataSize;
+    }
+
+    if( header.flags & NVMB_HAS_OLDDATA )
+        memcpy( oldDataBlock.rawData, payload, header.dataSize );
+
+    nextRecord++;
+
+    OpType operation = READ;
+
+    if( record.operation == NVMB_OP_WRITE )
+        operation = WRITE;
+    else if( record.operation != NVMB_OP_READ )
+        std::cout << "Warning: Unknown operation `" 
+            << static_cast<int>( record.operation ) << "'" << std::endl;
+
+    NVMAddress nAddress;
+
+    nAddress.SetPhysicalAddress( record.address );
+
+    nextAccess->SetLine( nAddress, operation, record.cycle,
+                         (header.flags & NVMB_HAS_DATA) ? dataBlock : emptyBlock,
+                         (header.flags & NVMB_HAS_OLDDATA) ? oldDataBlock : emptyBlock,
+                         record.threadId );
+
+    return true;
+}
+
+/* 
+ * Get the next N accesses to main memory. Called GetNextAccess N times and 
+ * places the return values into a vector of TraceLine pointers.
+ */
+int NVMainCompressedTraceReader::GetNextNAccesses( unsigned int N, 
+                                   std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        /* We need a new TraceLine so the old values are not overwritten. */
+        TraceLine *nextLine = new TraceLine( );
+
+        if( GetNextAccess( nextLine ) )
+        {
+            nextAccesses->push_back( nextLine );
+            successes++;
+        }
+        else
+        {
+            delete nextLine;
+        }
+    }
+
+    return successes;
+}
+
+/* Every block is read after a seek, so the position need not be kept. */
+void NVMainCompressedTraceReader::Reopen( )
+{
+    if( !trace.is_open( ) )
+        return;
+
+    trace.close( );
+    trace.open( traceFile.c_str( ), std::ifstream::in | std::ifstream::binary );
+}
@@ -0,0 +1,333 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/CompressedTrace/TraceCompressor.h"
+#include <cstring>
+
+#ifdef NVM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace NVM;
+
+/*
+ *  LZ sequence format: a token byte holds the literal length in the high
+ *  nibble and the match length minus lzMinMatch in the low nibble. A
+ *  nibble of 15 is followed by extra length bytes, each 255 meaning more
+ *  follow. The literals come next, then a 2-byte little-endian offset and
+ *  any extra match length bytes. The last sequence has literals only.
+ */
+static const uint32_t lzHashBits = 14;
+static const size_t lzMinMatch = 4;
+static const size_t lzMaxOffset = 65535;
+static const uint32_t lzNoMatch = 0xFFFFFFFF;
+
+#ifdef NVM_HAVE_ZSTD
+static const int zstdLevel = 3;
+#endif
+
+static inline uint32_t ReadLZWord( const uint8_t *data )
+{
+    uint32_t word;
+
+    memcpy( &word, data, sizeof(word) );
+
+    return word;
+}
+
+static inline uint32_t HashLZWord( uint32_t word )
+{
+    return (word * 2654435761U) >> (32 - lzHashBits);
+}
+
+static void PutLZLength( std::vector<uint8_t>& output, size_t length )
+{
+    while( length >= 255 )
+    {
+        output.push_back( 255 );
+        length -= 255;
+    }
+
+    output.push_back( static_cast<uint8_t>( length ) );
+}
+
+static bool GetLZLength( const uint8_t *& input, const uint8_t *inputEnd, size_t& length )
+{
+    uint8_t extra;
+
+    do
+    {
+        if( input == inputEnd )
+            return false;
+
+        extra = *input++;
+        length += extra;
+    } while( extra == 255 );
+
+    return true;
+}
+
+static void PutLZSequence( std::vector<uint8_t>& output, const uint8_t *literals, 
+                           size_t literalLength, size_t offset, size_t matchLength )
+{
+    size_t tokenPosition = output.size( );
+    uint8_t token;
+
+    output.push_back( 0 );
+
+    if( literalLength >= 15 )
+    {
+        token = 15 << 4;
+        PutLZLength( output, literalLength - 15 );
+    }
+    else
+    {
+        token = static_cast<uint8_t>( literalLength << 4 );
+    }
+
+    output.insert( output.end( ), literals, literals + literalLength );
+
+    if( matchLength > 0 )
+    {
+        size_t extraLength = matchLength - lzMinMatch;
+
+        output.push_back( static_cast<uint8_t>( offset & 0xFF ) );
+        output.push_back( static_cast<uint8_t>( offset >> 8 ) );
+
+        if( extraLength >= 15 )
+        {
+            token |= 15;
+            PutLZLength( output, extraLength - 15 );
+        }
+        else
+        {
+            token |= static_cast<uint8_t>( extraLength );
+        }
+    }
+
+    output[tokenPosition] = token;
+}
+
+TraceCompressor::TraceCompressor( )
+{
+
+}
+
+TraceCompressor::~TraceCompressor( )
+{
+
+}
+
+bool TraceCompressor::IsSupported( uint32_t codec )
+{
+    bool rv = (codec == TRACE_CODEC_STORED || codec == TRACE_CODEC_LZ);
+
+#ifdef NVM_HAVE_ZSTD
+    rv = rv || (codec == TRACE_CODEC_ZSTD);
+#endif
+
+    return rv;
+}
+
+const char *TraceCompressor::GetCodecName( uint32_t codec )
+{
+    if( codec == TRACE_CODEC_STORED )
+        return "stored";
+    else if( codec == TRACE_CODEC_LZ )
+        return "LZ";
+    else if( codec == TRACE_CODEC_ZSTD )
+        return "zstd";
+
+    return "unknown";
+}
+
+/*
+ *  Output that is not smaller than the input is still returned; callers
+ *  that want to store incompressible blocks as-is compare the sizes.
+ */
+void TraceCompressor::Compress( uint32_t codec, const uint8_t *input, size_t inputSize, 
+                                std::vector<uint8_t>& output )
+{
+    if( codec == TRACE_CODEC_LZ )
+    {
+        CompressLZ( input, inputSize, output );
+    }
+#ifdef NVM_HAVE_ZSTD
+    else if( codec == TRACE_CODEC_ZSTD )
+    {
+        output.resize( ZSTD_compressBound( inputSize ) );
+
+        size_t compressedSize = ZSTD_compress( &output[0], output.size( ), 
+                                               input, inputSize, zstdLevel );
+
+        if( ZSTD_isError( compressedSize ) )
+            output.assign( input, input + inputSize );
+        else
+            output.resize( compressedSize );
+    }
+#endif
+    else
+    {
+        output.assign( input, input + inputSize );
+    }
+}
+
+bool TraceCompressor::Decompress( uint32_t codec, const uint8_t *input, size_t inputSize,
+                                  uint8_t *output, size_t outputSize )
+{
+    bool rv = false;
+
+    if( codec == TRACE_CODEC_STORED )
+    {
+        if( inputSize == outputSize )
+        {
+            memcpy( output, input, outputSize );
+            rv = true;
+        }
+    }
+    else if( codec == TRACE_CODEC_LZ )
+    {
+        rv = DecompressLZ( input, inputSize, output, outputSize );
+    }
+#ifdef NVM_HAVE_ZSTD
+    else if( codec == TRACE_CODEC_ZSTD )
+    {
+        size_t decompressedSize = ZSTD_decompress( output, outputSize, input, inputSize );
+
+        rv = !ZSTD_isError( decompressedSize ) && decompressedSize == outputSize;
+    }
+#endif
+
+    return rv;
+}
+
+/* Greedy matching against the last position seen with the same hash. */
+void TraceCompressor::CompressLZ( const uint8_t *input, size_t inputSize, 
+                                  std::vector<uint8_t>& output )
+{
+    size_t anchor = 0;
+    size_t position = 0;
+
+    matchTable.assign( static_cast<size_t>( 1 ) << lzHashBits, lzNoMatch );
+    output.clear( );
+    output.reserve( inputSize + inputSize / 255 + 16 );
+
+    while( position + lzMinMatch <= inputSize )
+    {
+        uint32_t word = ReadLZWord( input + position );
+        uint32_t hash = HashLZWord( word );
+        uint32_t candidate = matchTable[hash];
+
+        matchTable[hash] = static_cast<uint32_t>( position );
+
+        if( candidate != lzNoMatch && position - candidate <= lzMaxOffset
+            && ReadLZWord( input + candidate ) == word )
+        {
+            size_t matchLength = lzMinMatch;
+
+            while( position + matchLength < inputSize 
+                   && input[candidate + matchLength] == input[position + matchLength] )
+            {
+                matchLength++;
+            }
+
+            PutLZSequence( output, input + anchor, position - anchor, 
+                           position - candidate, matchLength );
+
+            position += matchLength;
+            anchor = position;
+        }
+        else
+        {
+            position++;
+        }
+    }
+
+    PutLZSequence( output, input + anchor, inputSize - anchor, 0, 0 );
+}
+
+bool TraceCompressor::DecompressLZ( const uint8_t *input, size_t inputSize,
+                                    uint8_t *output, size_t outputSize )
+{
+    const uint8_t *inputEnd = input + inputSize;
+    uint8_t *outputStart = output;
+    uint8_t *outputEnd = output + outputSize;
+
+    while( input < inputEnd )
+    {
+        uint8_t token = *input++;
+        size_t literalLength = token >> 4;
+        size_t matchLength = token & 15;
+
+        if( literalLength == 15 && !GetLZLength( input, inputEnd, literalLength ) )
+            return false;
+
+        if( static_cast<size_t>( inputEnd - input ) < literalLength
+            || static_cast<size_t>( outputEnd - output ) < literalLength )
+            return false;
+
+        if( literalLength > 0 )
+            memcpy( output, input, literalLength );
+        output += literalLength;
+        input += literalLength;
+
+        /* The last sequence ends with its literals. */
+        if( input == inputEnd )
+            break;
+
+        if( inputEnd - input < 2 )
+            return false;
+
+        size_t offset = input[0] | (static_cast<size_t>( input[1] ) << 8);
+        input += 2;
+
+        if( matchLength == 15 && !GetLZLength( input, inputEnd, matchLength ) )
+            return false;
+
+        matchLength += lzMinMatch;
+
+        if( offset == 0 || offset > static_cast<size_t>( output - outputStart )
+            || static_cast<size_t>( outputEnd - output ) < matchLength )
+            return false;
+
+        /* Matches may overlap the bytes they produce, so copy forwards. */
+        const uint8_t *match = output - offset;
+
+        for( size_t i = 0; i < matchLength; i++ )
+            output[i] = match[i];
+
+        output += matchLength;
+    }
+
+    return output == outputEnd;
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __TRACECOMPRESSOR_H__
+#define __TRACECOMPRESSOR_H__
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+namespace NVM {
+
+/* Codec identifiers stored in compressed trace headers. */
+const uint32_t TRACE_CODEC_STORED = 0;
+const uint32_t TRACE_CODEC_LZ     = 1;
+const uint32_t TRACE_CODEC_ZSTD   = 2;
+
+/*
+ *  Block compressor for trace containers. TRACE_CODEC_LZ is a small
+ *  built-in LZ77 codec (LZ4-style sequences of literals and back
+ *  references within 64KB) that is always available. TRACE_CODEC_ZSTD is
+ *  only available when NVMain is built with NVM_HAVE_ZSTD.
+ *
+ *  The compressor keeps its match table between blocks, so one instance
+ *  should be reused rather than created per block.
+ */
+class TraceCompressor
+{
+  public:
+    TraceCompressor( );
+    ~TraceCompressor( );
+
+    static bool IsSupported( uint32_t codec );
+    static const char *GetCodecName( uint32_t codec );
+
+    void Compress( uint32_t codec, const uint8_t *input, size_t inputSize, 
+                   std::vector<uint8_t>& output );
+    bool Decompress( uint32_t codec, const uint8_t *input, size_t inputSize,
+                     uint8_t *output, size_t outputSize );
+
+  private:
+    std::vector<uint32_t> matchTable;
+
+    void CompressLZ( const uint8_t *input, size_t inputSize, 
+                     std::vector<uint8_t>& output );
+    bool DecompressLZ( const uint8_t *input, size_t inputSize,
+                       uint8_t *output, size_t outputSize );
+};
+
+};
+
+#endif
@@ -37,6 +37,7 @@
 #include <string>
 #include <vector>
 #include "traceReader/TraceLine.h"
+#include "src/Config.h"
 
 namespace NVM {
 
@@ -46,12 +47,28 @@ class GenericTraceReader
     GenericTraceReader( ) { }
 
     virtual ~GenericTraceReader( ) { }
+
+    /* Readers that take parameters read them from the configuration here. */
+    virtual void Init( Config * /*conf*/ ) { }
+
     virtual void SetTraceFile( std::string file ) = 0;
 
     virtual std::string GetTraceFile( ) = 0;
     virtual bool GetNextAccess( TraceLine *nextAccess ) = 0;
     virtual int  GetNextNAccesses( unsigned int N, 
                                    std::vector<TraceLine *> *nextAccesses ) = 0;
+
+    /*
+     *  Position the reader so the next access is the first one at or after
+     *  the given trace cycle. Readers that cannot seek return false.
+     */
+    virtual bool SeekToCycle( ncycle_t /*cycle*/ ) { return false; }
+
+    /*
+     *  Reopen any open trace file at the same position. A forked process 
+     *  calls this so it does not share the file offset with its parent.
+     */
+    virtual void Reopen( ) { }
 };
 
 };
@@ -0,0 +1,181 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/LLCFilter/LLCFilterTraceReader.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+
+using namespace NVM;
+
+LLCFilterTraceReader::LLCFilterTraceReader( GenericTraceReader *reader, Config *config )
+{
+    uint64_t size = 8 * 1024 * 1024;
+    uint64_t assoc = 16;
+    uint64_t lineSize = 64;
+
+    if( config->KeyExists( "LLCSize" ) )
+        size = config->GetValueUL( "LLCSize" );
+    if( config->KeyExists( "LLCAssoc" ) )
+        assoc = config->GetValueUL( "LLCAssoc" );
+    if( config->KeyExists( "LLCLineSize" ) )
+        lineSize = config->GetValueUL( "LLCLineSize" );
+
+    if( assoc == 0 || lineSize == 0 || (lineSize & (lineSize - 1)) != 0 
+        || size < assoc * lineSize )
+    {
+        std::cerr << "LLCFilterTraceReader: LLCSize must hold at least LLCAssoc "
+            << "lines and LLCLineSize must be a power of two." << std::endl;
+        exit(1);
+    }
+
+    this->reader = reader;
+    cache = new FilterCache( size / (assoc * lineSize), assoc, lineSize );
+
+    writebackPending = false;
+
+    zeroLine.SetSize( lineSize );
+    memset( zeroLine.rawData, 0, lineSize );
+}
+
+LLCFilterTraceReader::~LLCFilterTraceReader( )
+{
+    delete cache;
+    delete reader;
+}
+
+void LLCFilterTraceReader::SetTraceFile( std::string file )
+{
+    reader->SetTraceFile( file );
+}
+
+std::string LLCFilterTraceReader::GetTraceFile( )
+{
+    return reader->GetTraceFile( );
+}
+
+FilterCache *LLCFilterTraceReader::GetCache( )
+{
+    return cache;
+}
+
+bool LLCFilterTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    if( writebackPending )
+    {
+        writebackPending = false;
+
+        nextAccess->SetLine( writeback.GetAddress( ), WRITE, writeback.GetCycle( ),
+                             zeroLine, zeroLine, writeback.GetThreadId( ) );
+
+        return true;
+    }
+
+    /* Hits never leave the LLC, so keep reading until an access misses. */
+    while( reader->GetNextAccess( &access ) )
+    {
+        bool dirtyVictim;
+        uint64_t victim;
+
+        if( access.GetOperation( ) != READ && access.GetOperation( ) != WRITE )
+        {
+            *nextAccess = access;
+            return true;
+        }
+
+        if( cache->Access( access.GetAddress( ).GetPhysicalAddress( ), 
+                           (access.GetOperation( ) == WRITE), &dirtyVictim, &victim ) )
+            continue;
+
+        NVMAddress lineAddress;
+
+        lineAddress.SetPhysicalAddress( 
+            cache->GetLineAddress( access.GetAddress( ).GetPhysicalAddress( ) ) );
+
+        nextAccess->SetLine( lineAddress, READ, access.GetCycle( ), access.GetData( ),
+                             access.GetOldData( ), access.GetThreadId( ) );
+
+        if( dirtyVictim )
+        {
+            NVMAddress victimAddress;
+
+            victimAddress.SetPhysicalAddress( victim );
+            writeback.SetLine( victimAddress, WRITE, access.GetCycle( ), zeroLine,
+                               zeroLine, access.GetThreadId( ) );
+            writebackPending = true;
+        }
+
+        return true;
+    }
+
+    *nextAccess = access;
+
+    return false;
+}
+
+int LLCFilterTraceReader::GetNextNAccesses( unsigned int N, 
+                                            std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        /* We need a new TraceLine so the old values are not overwritten. */
+        TraceLine *nextLine = new TraceLine( );
+
+        if( GetNextAccess( nextLine ) )
+        {
+            nextAccesses->push_back( nextLine );
+            successes++;
+        }
+        else
+        {
+            delete nextLine;
+        }
+    }
+
+    return successes;
+}
+
+/* The cache contents are kept, so a seek behaves like a skipped region. */
+bool LLCFilterTraceReader::SeekToCycle( ncycle_t cycle )
+{
+    writebackPending = false;
+
+    return reader->SeekToCycle( cycle );
+}
+
+void LLCFilterTraceReader::Reopen( )
+{
+    reader->Reopen( );
+}
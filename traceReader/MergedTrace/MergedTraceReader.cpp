@@ -0,0 +1,263 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/MergedTrace/MergedTraceReader.h"
+#include "traceReader/TraceReaderFactory.h"
+#include <iostream>
+#include <sstream>
+
+using namespace NVM;
+
+MergedTraceReader::MergedTraceReader( )
+{
+    traceFile = "";
+    config = NULL;
+    opened = false;
+    loopTraces = false;
+    activeSources = 0;
+}
+
+MergedTraceReader::~MergedTraceReader( )
+{
+    for( std::vector<MergeSource *>::iterator it = sources.begin( ); 
+         it != sources.end( ); ++it )
+    {
+        delete (*it)->reader;
+        delete (*it);
+    }
+}
+
+void MergedTraceReader::Init( Config *conf )
+{
+    config = conf;
+
+    if( config->KeyExists( "MergeLoopTraces" ) )
+        loopTraces = config->GetBool( "MergeLoopTraces" );
+}
+
+void MergedTraceReader::SetTraceFile( std::string file )
+{
+    traceFile = file;
+}
+
+std::string MergedTraceReader::GetTraceFile( )
+{
+    return traceFile;
+}
+
+GenericTraceReader *MergedTraceReader::CreateReader( ncounter_t source )
+{
+    std::string readerName = "NVMainTrace";
+    std::stringstream sourceKey;
+
+    sourceKey << "MergeTraceReader_T" << source;
+
+    if( config != NULL && config->KeyExists( sourceKey.str( ) ) )
+        readerName = config->GetString( sourceKey.str( ) );
+    else if( config != NULL && config->KeyExists( "MergeTraceReader" ) )
+        readerName = config->GetString( "MergeTraceReader" );
+
+    if( readerName == "MergedTrace" )
+    {
+        std::cout << "MergedTraceReader: Merged traces cannot be nested." << std::endl;
+        return NULL;
+    }
+
+    GenericTraceReader *reader = TraceReaderFactory::CreateNewTraceReader( readerName );
+
+    if( reader != NULL )
+    {
+        if( config != NULL )
+            reader->Init( config );
+
+        reader->SetTraceFile( sources[source]->traceFile );
+    }
+
+    return reader;
+}
+
+void MergedTraceReader::OpenSources( )
+{
+    std::stringstream fileList( traceFile );
+    std::string file;
+    uint64_t addressOffset = 0;
+
+    opened = true;
+
+    if( config != NULL && config->KeyExists( "MergeAddressOffset" ) )
+        addressOffset = config->GetValueUL( "MergeAddressOffset" );
+
+    while( std::getline( fileList, file, ',' ) )
+    {
+        if( file == "" )
+            continue;
+
+        MergeSource *source = new MergeSource;
+
+        source->traceFile = file;
+        source->reader = NULL;
+        source->cycleOffset = 0;
+        source->lastCycle = 0;
+        source->addressOffset = addressOffset * sources.size( );
+        source->lines = 0;
+        source->ended = false;
+
+        sources.push_back( source );
+    }
+
+    for( ncounter_t i = 0; i < sources.size( ); i++ )
+    {
+        sources[i]->reader = CreateReader( i );
+
+        if( sources[i]->reader == NULL )
+        {
+            sources[i]->ended = true;
+            continue;
+        }
+
+        activeSources++;
+        Advance( i );
+    }
+}
+
+/*
+ *  Read the next line of a source and put it on the heap. A source that
+ *  ends is restarted when looping, until every source has ended once.
+ */
+bool MergedTraceReader::Advance( ncounter_t source )
+{
+    MergeSource *s = sources[source];
+
+    while( !s->reader->GetNextAccess( &s->line ) )
+    {
+        if( !s->ended )
+        {
+            s->ended = true;
+            activeSources--;
+        }
+
+        /* An empty trace cannot be looped. */
+        if( !loopTraces || activeSources == 0 || s->lines == 0 )
+            return false;
+
+        delete s->reader;
+        s->reader = CreateReader( source );
+        s->cycleOffset = s->lastCycle + 1;
+
+        if( s->reader == NULL )
+            return false;
+    }
+
+    MergeEntry entry;
+
+    s->lines++;
+    s->lastCycle = s->line.GetCycle( ) + s->cycleOffset;
+
+    entry.cycle = s->lastCycle;
+    entry.source = source;
+
+    heap.push( entry );
+
+    return true;
+}
+
+bool MergedTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    if( !opened )
+        OpenSources( );
+
+    /* 
+     *  Looping sources still have lines queued once the last source ends;
+     *  the merged trace ends there.
+     */
+    if( heap.empty( ) || (loopTraces && activeSources == 0) )
+    {
+        NVMAddress nAddress;
+        nAddress.SetPhysicalAddress( 0xDEADC0DEDEADBEEFULL );
+        nextAccess->SetLine( nAddress, NOP, 0, emptyBlock, emptyBlock, 0 );
+        std::cout << "MergedTraceReader: Reached EOF!" << std::endl;
+        return false;
+    }
+
+    MergeEntry entry = heap.top( );
+    MergeSource *s = sources[entry.source];
+    NVMAddress nAddress;
+
+    heap.pop( );
+
+    nAddress.SetPhysicalAddress( s->line.GetAddress( ).GetPhysicalAddress( ) 
+                                 + s->addressOffset );
+
+    nextAccess->SetLine( nAddress, s->line.GetOperation( ), entry.cycle,
+                         s->line.GetData( ), s->line.GetOldData( ), 
+                         static_cast<ncounters_t>( entry.source ) );
+
+    Advance( entry.source );
+
+    return true;
+}
+
+/* 
+ * Get the next N accesses to main memory. Called GetNextAccess N times and 
+ * places the return values into a vector of TraceLine pointers.
+ */
+int MergedTraceReader::GetNextNAccesses( unsigned int N, 
+                                         std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        /* We need a new TraceLine so the old values are not overwritten. */
+        TraceLine *nextLine = new TraceLine( );
+
+        if( GetNextAccess( nextLine ) )
+        {
+            nextAccesses->push_back( nextLine );
+            successes++;
+        }
+        else
+        {
+            delete nextLine;
+        }
+    }
+
+    return successes;
+}
+
+void MergedTraceReader::Reopen( )
+{
+    for( size_t i = 0; i < sources.size( ); i++ )
+        if( sources[i]->reader != NULL )
+            sources[i]->reader->Reopen( );
+}
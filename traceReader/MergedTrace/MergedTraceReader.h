@@ -0,0 +1,113 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __MERGEDTRACEREADER_H__
+#define __MERGEDTRACEREADER_H__
+
+#include "traceReader/GenericTraceReader.h"
+#include "src/Config.h"
+#include <queue>
+
+namespace NVM {
+
+/*
+ *  Merges several traces by cycle for multiprogrammed workloads. The trace
+ *  file is a comma separated list; source n is read with the reader named
+ *  by MergeTraceReader (NVMainTrace by default, MergeTraceReader_T<n>
+ *  overrides it) and its requests get threadId n.
+ *
+ *  MergeAddressOffset moves source n to address + n * offset so cores do
+ *  not share data. With MergeLoopTraces, a source that ends is restarted
+ *  after its last cycle until every source has ended at least once, so
+ *  short traces keep their core busy until the longest finishes.
+ */
+class MergedTraceReader : public GenericTraceReader
+{
+  public:
+    MergedTraceReader( );
+    ~MergedTraceReader( );
+
+    void Init( Config *conf );
+
+    void SetTraceFile( std::string file );
+    std::string GetTraceFile( );
+
+    bool GetNextAccess( TraceLine *nextAccess );
+    int  GetNextNAccesses( unsigned int N, std::vector<TraceLine *> *nextAccesses );
+
+    void Reopen( );
+
+  private:
+    struct MergeSource
+    {
+        std::string traceFile;
+        GenericTraceReader *reader;
+        TraceLine line;
+        ncycle_t cycleOffset;
+        ncycle_t lastCycle;
+        uint64_t addressOffset;
+        ncounter_t lines;
+        bool ended;
+    };
+
+    /* Min-heap entry; ties go to the lowest source. */
+    struct MergeEntry
+    {
+        ncycle_t cycle;
+        ncounter_t source;
+
+        bool operator>( const MergeEntry& m ) const
+        {
+            return (cycle > m.cycle) || (cycle == m.cycle && source > m.source);
+        }
+    };
+
+    std::string traceFile;
+    Config *config;
+    bool opened;
+    bool loopTraces;
+    ncounter_t activeSources;
+
+    std::vector<MergeSource *> sources;
+    std::priority_queue<MergeEntry, std::vector<MergeEntry>, std::greater<MergeEntry> > heap;
+
+    NVMDataBlock emptyBlock;
+
+    void OpenSources( );
+    GenericTraceReader *CreateReader( ncounter_t source );
+    bool Advance( ncounter_t source );
+};
+
+};
+
+#endif
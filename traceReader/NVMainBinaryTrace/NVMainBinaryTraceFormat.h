@@ -0,0 +1,87 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAINBINARYTRACEFORMAT_H__
+#define __NVMAINBINARYTRACEFORMAT_H__
+
+#include <stdint.h>
+
+namespace NVM {
+
+/*
+ *  NVMain binary trace (NVMB) layout. A fixed header is followed by
+ *  fixed-size records, so a reader can walk a memory-mapped file without
+ *  parsing. Each record is an NVMBinaryTraceRecord, followed by dataSize
+ *  bytes of data if NVMB_HAS_DATA is set and dataSize bytes of old data
+ *  if NVMB_HAS_OLDDATA is set. Payload bytes are in the same order as the
+ *  hex digits of an NVMV1 text trace.
+ *
+ *  Fields are in the byte order of the machine that wrote the trace; a
+ *  reader on a machine of the other order sees a byte-swapped version.
+ */
+#define NVMB_MAGIC "NVMB"
+
+const uint32_t NVMB_VERSION = 1;
+
+const uint32_t NVMB_HAS_DATA    = 0x1;
+const uint32_t NVMB_HAS_OLDDATA = 0x2;
+
+const uint8_t NVMB_OP_READ  = 0;
+const uint8_t NVMB_OP_WRITE = 1;
+
+struct NVMBinaryTraceHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t dataSize;      /* Bytes in each data or old data payload. */
+    uint32_t recordSize;    /* Bytes per record, including payloads. */
+    uint32_t reserved;
+    uint64_t recordCount;   /* 0 if the writer did not finish the trace. */
+};
+
+struct NVMBinaryTraceRecord
+{
+    uint64_t cycle;
+    uint64_t address;
+    uint32_t threadId;
+    uint8_t operation;
+    uint8_t reserved[3];
+};
+
+static_assert( sizeof(NVMBinaryTraceHeader) == 32, "NVMB header must be 32 bytes" );
+static_assert( sizeof(NVMBinaryTraceRecord) == 24, "NVMB record must be 24 bytes" );
+
+};
+
+#endif
@@ -0,0 +1,299 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/NVMainBinaryTrace/NVMainBinaryTraceReader.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace NVM;
+
+NVMainBinaryTraceReader::NVMainBinaryTraceReader( )
+{
+    traceFile = "";
+    traceOpened = false;
+    traceFd = -1;
+    traceMap = NULL;
+    traceSize = 0;
+
+    memset( &header, 0, sizeof(header) );
+    nextRecord = NULL;
+    traceEnd = NULL;
+}
+
+NVMainBinaryTraceReader::~NVMainBinaryTraceReader( )
+{
+    CloseTrace( );
+}
+
+void NVMainBinaryTraceReader::SetTraceFile( std::string file )
+{
+    CloseTrace( );
+
+    traceFile = file;
+    traceOpened = false;
+}
+
+std::string NVMainBinaryTraceReader::GetTraceFile( )
+{
+    return traceFile;
+}
+
+void NVMainBinaryTraceReader::CloseTrace( )
+{
+    if( traceMap != NULL )
+        munmap( traceMap, traceSize );
+
+    if( traceFd != -1 )
+        close( traceFd );
+
+    traceFd = -1;
+    traceMap = NULL;
+    traceSize = 0;
+    nextRecord = NULL;
+    traceEnd = NULL;
+}
+
+/*
+ *  Map the whole trace and check its header. Records are then read in
+ *  place, so the file must stay unchanged while the simulation runs.
+ */
+bool NVMainBinaryTraceReader::OpenTrace( )
+{
+    struct stat traceStat;
+
+    traceOpened = true;
+
+    traceFd = open( traceFile.c_str( ), O_RDONLY );
+    if( traceFd == -1 || fstat( traceFd, &traceStat ) != 0 )
+    {
+        std::cerr << "Could not open trace file: " << traceFile << "!" << std::endl;
+        CloseTrace( );
+        return false;
+    }
+
+    traceSize = static_cast<size_t>( traceStat.st_size );
+    if( traceSize < sizeof(header) )
+    {
+        std::cerr << "NVMainBinaryTraceReader: " << traceFile 
+            << " is too short to be a binary trace." << std::endl;
+        CloseTrace( );
+        return false;
+    }
+
+    void *mapping = mmap( NULL, traceSize, PROT_READ, MAP_PRIVATE, traceFd, 0 );
+    if( mapping == MAP_FAILED )
+    {
+        std::cerr << "NVMainBinaryTraceReader: Could not map " << traceFile 
+            << "!" << std::endl;
+        traceSize = 0;
+        CloseTrace( );
+        return false;
+    }
+
+    traceMap = static_cast<uint8_t *>( mapping );
+    madvise( traceMap, traceSize, MADV_SEQUENTIAL );
+
+    memcpy( &header, traceMap, sizeof(header) );
+
+    if( memcmp( header.magic, NVMB_MAGIC, sizeof(header.magic) ) != 0 )
+    {
+        std::cerr << "NVMainBinaryTraceReader: " << traceFile 
+            << " is not a binary trace." << std::endl;
+        CloseTrace( );
+        return false;
+    }
+
+    if( header.version != NVMB_VERSION )
+    {
+        std::cerr << "NVMainBinaryTraceReader: Unsupported trace version " 
+            << header.version << " (expected " << NVMB_VERSION 
+            << "). A trace written on a machine with the other byte order "
+            << "must be converted again." << std::endl;
+        CloseTrace( );
+        return false;
+    }
+
+    uint64_t payloads = 0;
+
+    if( header.flags & NVMB_HAS_DATA )
+        payloads++;
+    if( header.flags & NVMB_HAS_OLDDATA )
+        payloads++;
+
+    if( header.recordSize != sizeof(NVMBinaryTraceRecord) + payloads * header.dataSize )
+    {
+        std::cerr << "NVMainBinaryTraceReader: Record size " << header.recordSize
+            << " does not match the header of " << traceFile << "." << std::endl;
+        CloseTrace( );
+        return false;
+    }
+
+    /* An unfinished trace has no record count; use every whole record. */
+    uint64_t availableRecords = (traceSize - sizeof(header)) / header.recordSize;
+
+    if( header.recordCount == 0 || header.recordCount > availableRecords )
+        header.recordCount = availableRecords;
+
+    nextRecord = traceMap + sizeof(header);
+    traceEnd = nextRecord + header.recordCount * header.recordSize;
+
+    if( header.flags & NVMB_HAS_DATA )
+        dataBlock.SetSize( header.dataSize );
+    if( header.flags & NVMB_HAS_OLDDATA )
+        oldDataBlock.SetSize( header.dataSize );
+
+    return true;
+}
+
+/*
+ *  Position the reader on the first record at or after the given cycle,
+ *  assuming records are in cycle order.
+ */
+bool NVMainBinaryTraceReader::SeekToCycle( ncycle_t cycle )
+{
+    if( !traceOpened )
+        OpenTrace( );
+
+    if( traceMap == NULL )
+        return false;
+
+    const uint8_t *firstRecord = traceMap + sizeof(header);
+    uint64_t first = 0;
+    uint64_t last = header.recordCount;
+
+    while( first < last )
+    {
+        uint64_t middle = first + (last - first) / 2;
+        NVMBinaryTraceRecord record;
+
+        memcpy( &record, firstRecord + middle * header.recordSize, sizeof(record) );
+
+        if( record.cycle < cycle )
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    nextRecord = firstRecord + first * header.recordSize;
+
+    return true;
+}
+
+bool NVMainBinaryTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    /* If there is no trace file, we can't do anything. */
+    if( traceFile == "" )
+    {
+        std::cerr << "No trace file specified!" << std::endl;
+        return false;
+    }
+
+    if( !traceOpened && !OpenTrace( ) )
+        return false;
+
+    /* There are no more records in the trace... Send back a "dummy" line */
+    if( nextRecord == traceEnd )
+    {
+        NVMAddress nAddress;
+        nAddress.SetPhysicalAddress( 0xDEADC0DEDEADBEEFULL );
+        nextAccess->SetLine( nAddress, NOP, 0, emptyBlock, emptyBlock, 0 );
+        std::cout << "NVMainBinaryTraceReader: Reached EOF!" << std::endl;
+        return false;
+    }
+
+    NVMBinaryTraceRecord record;
+    const uint8_t *payload = nextRecord + sizeof(record);
+
+    memcpy( &record, nextRecord, sizeof(record) );
+
+    if( header.flags & NVMB_HAS_DATA )
+    {
+        memcpy( dataBlock.rawData, payload, header.dataSize );
+        payload += header.dataSize;
+    }
+
+    if( header.flags & NVMB_HAS_OLDDATA )
+        memcpy( oldDataBlock.rawData, payload, header.dataSize );
+
+    nextRecord += header.recordSize;
+
+    OpType operation = READ;
+
+    if( record.operation == NVMB_OP_WRITE )
+        operation = WRITE;
+    else if( record.operation != NVMB_OP_READ )
+        std::cout << "Warning: Unknown operation `" 
+            << static_cast<int>( record.operation ) << "'" << std::endl;
+
+    NVMAddress nAddress;
+
+    nAddress.SetPhysicalAddress( record.address );
+
+    nextAccess->SetLine( nAddress, operation, record.cycle,
+                         (header.flags & NVMB_HAS_DATA) ? dataBlock : emptyBlock,
+                         (header.flags & NVMB_HAS_OLDDATA) ? oldDataBlock : emptyBlock,
+                         record.threadId );
+
+    return true;
+}
+
+/* 
+ * Get the next N accesses to main memory. Called GetNextAccess N times and 
+ * places the return values into a vector of TraceLine pointers.
+ */
+int NVMainBinaryTraceReader::GetNextNAccesses( unsigned int N, 
+                                   std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        /* We need a new TraceLine so the old values are not overwritten. */
+        TraceLine *nextLine = new TraceLine( );
+
+        if( GetNextAccess( nextLine ) )
+        {
+            nextAccesses->push_back( nextLine );
+            successes++;
+        }
+        else
+        {
+            delete nextLine;
+        }
+    }
+
+    return successes;
+}
@@ -92,7 +92,7 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
     std::string fullLine;
 
     /* We will read in a full line and fill in these values */
-    unsigned int cycle = 0;
+    ncycle_t cycle = 0;
     OpType operation = READ;
     uint64_t address;
     NVMDataBlock dataBlock;
@@ -135,7 +135,7 @@ bool NVMainTraceReader::GetNextAccess( TraceLine *nextAccess )
         if( field != "" )
         {
             if( fieldId == 0 )
-                cycle = atoi( field.c_str( ) );
+                cycle = strtoull( field.c_str( ), NULL, 10 );
             else if( fieldId == 1 )
             {
                 if( field == "R" )
@@ -282,3 +282,15 @@ int NVMainTraceReader::GetNextNAccesses( unsigned int N,
 
     return successes;
 }
+
+void NVMainTraceReader::Reopen( )
+{
+    if( !trace.is_open( ) || !trace.good( ) )
+        return;
+
+    std::streampos position = trace.tellg( );
+
+    trace.close( );
+    trace.open( traceFile.c_str( ) );
+    trace.seekg( position );
+}
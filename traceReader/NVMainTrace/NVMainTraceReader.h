@@ -52,6 +52,8 @@ class NVMainTraceReader : public GenericTraceReader
     
     bool GetNextAccess( TraceLine *nextAccess );
     int  GetNextNAccesses( unsigned int N, std::vector<TraceLine *> *nextAccess );
+
+    void Reopen( );
   
   private:
     std::string traceFile;
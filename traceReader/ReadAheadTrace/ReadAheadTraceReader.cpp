@@ -0,0 +1,277 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/ReadAheadTrace/ReadAheadTraceReader.h"
+#include <iostream>
+#include <cstdlib>
+#include <cassert>
+
+using namespace NVM;
+
+/* Lines decoded before the consumer is allowed to see them. */
+static const ncounter_t readAheadBatchLines = 256;
+
+ReadAheadTraceReader::ReadAheadTraceReader( GenericTraceReader *reader,
+                                            ncounter_t readAheadLines )
+    : head(0), tail(0), stopping(false), producerWaiting(false), consumerWaiting(false)
+{
+    this->reader = reader;
+
+    batchLines = readAheadBatchLines;
+    batchCount = readAheadLines / batchLines;
+
+    /* At least one batch to fill while another is consumed. */
+    if( batchCount < 2 )
+        batchCount = 2;
+
+    batches = new Batch[batchCount];
+
+    for( ncounter_t i = 0; i < batchCount; i++ )
+    {
+        batches[i].lines = new TraceLine[batchLines + 1];
+        batches[i].count = 0;
+        batches[i].endOfTrace = false;
+    }
+
+    nextLine = 0;
+    finished = false;
+    threadStarted = false;
+
+    pthread_mutex_init( &waitLock, NULL );
+    pthread_cond_init( &waitCond, NULL );
+}
+
+ReadAheadTraceReader::~ReadAheadTraceReader( )
+{
+    if( threadStarted )
+    {
+        pthread_mutex_lock( &waitLock );
+        stopping = true;
+        pthread_cond_broadcast( &waitCond );
+        pthread_mutex_unlock( &waitLock );
+
+        pthread_join( thread, NULL );
+    }
+
+    pthread_cond_destroy( &waitCond );
+    pthread_mutex_destroy( &waitLock );
+
+    for( ncounter_t i = 0; i < batchCount; i++ )
+        delete [] batches[i].lines;
+
+    delete [] batches;
+    delete reader;
+}
+
+void ReadAheadTraceReader::SetTraceFile( std::string file )
+{
+    /* The producer owns the wrapped reader once it is running. */
+    assert( !threadStarted );
+
+    reader->SetTraceFile( file );
+}
+
+std::string ReadAheadTraceReader::GetTraceFile( )
+{
+    return reader->GetTraceFile( );
+}
+
+/* Only possible before reading starts, while the wrapped reader is idle. */
+bool ReadAheadTraceReader::SeekToCycle( ncycle_t cycle )
+{
+    if( threadStarted )
+        return false;
+
+    return reader->SeekToCycle( cycle );
+}
+
+void ReadAheadTraceReader::StartThread( )
+{
+    if( pthread_create( &thread, NULL, ProducerThread, this ) != 0 )
+    {
+        std::cerr << "ReadAheadTraceReader: Could not create reader thread." 
+            << std::endl;
+        exit(1);
+    }
+
+    threadStarted = true;
+}
+
+void *ReadAheadTraceReader::ProducerThread( void *data )
+{
+    static_cast<ReadAheadTraceReader *>( data )->Produce( );
+
+    return NULL;
+}
+
+/*
+ *  Wake the other side if it is (or is about to be) asleep. The waiting
+ *  flag is set before the sleeper re-checks the ring, and the ring index
+ *  is published before the flag is read here, so one of the two always
+ *  sees the other's update.
+ */
+void ReadAheadTraceReader::Wake( std::atomic<bool>& waiting )
+{
+    if( waiting )
+    {
+        pthread_mutex_lock( &waitLock );
+        pthread_cond_broadcast( &waitCond );
+        pthread_mutex_unlock( &waitLock );
+    }
+}
+
+void ReadAheadTraceReader::Produce( )
+{
+    while( !stopping )
+    {
+        ncounter_t position = tail;
+
+        /* Ring is full, wait for the simulation to catch up. */
+        if( position - head == batchCount )
+        {
+            pthread_mutex_lock( &waitLock );
+            producerWaiting = true;
+
+            while( position - head == batchCount && !stopping )
+                pthread_cond_wait( &waitCond, &waitLock );
+
+            producerWaiting = false;
+            pthread_mutex_unlock( &waitLock );
+
+            continue;
+        }
+
+        Batch& batch = batches[position % batchCount];
+
+        batch.count = 0;
+        batch.endOfTrace = false;
+
+        while( batch.count < batchLines )
+        {
+            if( !reader->GetNextAccess( &batch.lines[batch.count] ) )
+            {
+                batch.endOfTrace = true;
+                break;
+            }
+
+            batch.count++;
+        }
+
+        tail = position + 1;
+        Wake( consumerWaiting );
+
+        if( batch.endOfTrace )
+            break;
+    }
+}
+
+bool ReadAheadTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    if( !threadStarted )
+        StartThread( );
+
+    ncounter_t position = head;
+
+    /* Ring is empty, wait for the reader thread. */
+    if( tail == position )
+    {
+        pthread_mutex_lock( &waitLock );
+        consumerWaiting = true;
+
+        while( tail == position )
+            pthread_cond_wait( &waitCond, &waitLock );
+
+        consumerWaiting = false;
+        pthread_mutex_unlock( &waitLock );
+    }
+
+    Batch& batch = batches[position % batchCount];
+    bool rv = true;
+
+    /* Past the last line, keep returning the wrapped reader's final line. */
+    if( finished || nextLine == batch.count )
+    {
+        assert( batch.endOfTrace );
+
+        finished = true;
+        rv = false;
+    }
+
+    TraceLine& line = batch.lines[rv ? nextLine : batch.count];
+
+    nextAccess->SetLine( line.GetAddress( ), line.GetOperation( ), line.GetCycle( ),
+                         line.GetData( ), line.GetOldData( ), line.GetThreadId( ) );
+
+    if( rv )
+    {
+        nextLine++;
+
+        /* Hand the batch back unless it holds the end of the trace. */
+        if( nextLine == batch.count && !batch.endOfTrace )
+        {
+            nextLine = 0;
+            head = position + 1;
+            Wake( producerWaiting );
+        }
+    }
+
+    return rv;
+}
+
+/* 
+ * Get the next N accesses to main memory. Called GetNextAccess N times and 
+ * places the return values into a vector of TraceLine pointers.
+ */
+int ReadAheadTraceReader::GetNextNAccesses( unsigned int N, 
+                                   std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        /* We need a new TraceLine so the old values are not overwritten. */
+        TraceLine *line = new TraceLine( );
+
+        if( GetNextAccess( line ) )
+        {
+            nextAccesses->push_back( line );
+            successes++;
+        }
+        else
+        {
+            delete line;
+        }
+    }
+
+    return successes;
+}
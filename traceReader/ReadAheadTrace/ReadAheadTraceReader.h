@@ -0,0 +1,112 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __READAHEADTRACEREADER_H__
+#define __READAHEADTRACEREADER_H__
+
+#include "traceReader/GenericTraceReader.h"
+#include <atomic>
+#include <pthread.h>
+
+namespace NVM {
+
+/*
+ *  Wraps another trace reader and decodes its lines on a background thread,
+ *  so trace I/O and parsing overlap with simulation. Decoded lines are
+ *  passed through a single-producer, single-consumer ring of batches. The
+ *  ring is lock-free while it is neither full nor empty; otherwise the
+ *  waiting side sleeps until the other side makes progress.
+ *
+ *  The wrapped reader is owned by the decorator and must not be used by
+ *  anyone else once the first access has been requested.
+ */
+class ReadAheadTraceReader : public GenericTraceReader
+{
+  public:
+    ReadAheadTraceReader( GenericTraceReader *reader, ncounter_t readAheadLines );
+    ~ReadAheadTraceReader( );
+    
+    void SetTraceFile( std::string file );
+    std::string GetTraceFile( );
+    
+    bool GetNextAccess( TraceLine *nextAccess );
+    int  GetNextNAccesses( unsigned int N, std::vector<TraceLine *> *nextAccesses );
+
+    bool SeekToCycle( ncycle_t cycle );
+  
+  private:
+    /* 
+     *  A batch holds up to batchLines decoded lines. The batch that hits the
+     *  end of the trace also keeps the reader's final (failed) line, so the
+     *  caller sees exactly what the wrapped reader returned.
+     */
+    struct Batch
+    {
+        TraceLine *lines;
+        ncounter_t count;
+        bool endOfTrace;
+    };
+
+    GenericTraceReader *reader;
+
+    Batch *batches;
+    ncounter_t batchCount;
+    ncounter_t batchLines;
+
+    /* Batches are produced at tail and consumed at head. */
+    std::atomic<ncounter_t> head;
+    std::atomic<ncounter_t> tail;
+
+    /* Consumer position inside the batch at head. */
+    ncounter_t nextLine;
+    bool finished;
+
+    pthread_t thread;
+    bool threadStarted;
+    std::atomic<bool> stopping;
+
+    pthread_mutex_t waitLock;
+    pthread_cond_t waitCond;
+    std::atomic<bool> producerWaiting;
+    std::atomic<bool> consumerWaiting;
+
+    void StartThread( );
+    void Produce( );
+    void Wake( std::atomic<bool>& waiting );
+
+    static void *ProducerThread( void *data );
+};
+
+};
+
+#endif
@@ -249,3 +249,15 @@ int RubyTraceReader::GetNextNAccesses( unsigned int N,
 
     return successes;
 }
+
+void RubyTraceReader::Reopen( )
+{
+    if( !trace.is_open( ) || !trace.good( ) )
+        return;
+
+    std::streampos position = trace.tellg( );
+
+    trace.close( );
+    trace.open( traceFile.c_str( ) );
+    trace.seekg( position );
+}
@@ -56,6 +56,8 @@ class RubyTraceReader : public GenericTraceReader
     bool GetNextAccess( TraceLine *nextAccess );
     int  GetNextNAccesses( unsigned int N, std::vector<TraceLine *> *nextAccesses );
 
+    void Reopen( );
+
   private:
     std::string traceFile;
     std::ifstream trace;
@@ -0,0 +1,235 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/SharedTrace/SharedTraceReader.h"
+#include <limits>
+#include <algorithm>
+#include <cassert>
+
+using namespace NVM;
+
+/* Lines decoded at a time by the consumer that runs out first. */
+static const ncounter_t sharedBatchLines = 256;
+
+SharedTraceSource::SharedTraceSource( GenericTraceReader *reader, ncounter_t consumers,
+                                      ncounter_t bufferLines )
+{
+    this->reader = reader;
+
+    firstBatch = 0;
+    maxBatches = bufferLines / sharedBatchLines;
+    decodedAll = false;
+
+    /* The slowest consumer must always be able to decode its next batch. */
+    if( maxBatches < 1 )
+        maxBatches = 1;
+
+    positions.assign( consumers, 0 );
+
+    pthread_mutex_init( &lock, NULL );
+    pthread_cond_init( &released, NULL );
+}
+
+SharedTraceSource::~SharedTraceSource( )
+{
+    while( !batches.empty( ) )
+    {
+        delete [] batches.front( )->lines;
+        delete batches.front( );
+        batches.pop_front( );
+    }
+
+    pthread_mutex_destroy( &lock );
+    pthread_cond_destroy( &released );
+
+    delete reader;
+}
+
+GenericTraceReader *SharedTraceSource::CreateReader( ncounter_t consumer )
+{
+    assert( consumer < positions.size( ) );
+
+    return new SharedTraceReader( this, consumer );
+}
+
+std::string SharedTraceSource::GetTraceFile( )
+{
+    return reader->GetTraceFile( );
+}
+
+SharedTraceSource::Batch *SharedTraceSource::GetBatch( ncounter_t index )
+{
+    Batch *rv;
+
+    pthread_mutex_lock( &lock );
+
+    while( index >= firstBatch + batches.size( ) )
+    {
+        /* Too far ahead of the slowest consumer to buffer another batch. */
+        if( index - firstBatch >= maxBatches )
+        {
+            pthread_cond_wait( &released, &lock );
+            continue;
+        }
+
+        assert( !decodedAll );
+
+        Batch *newBatch = new Batch( );
+
+        newBatch->lines = new TraceLine[sharedBatchLines + 1];
+        newBatch->count = 0;
+        newBatch->endOfTrace = false;
+
+        while( newBatch->count < sharedBatchLines )
+        {
+            if( !reader->GetNextAccess( &newBatch->lines[newBatch->count] ) )
+            {
+                newBatch->endOfTrace = true;
+                decodedAll = true;
+                break;
+            }
+
+            newBatch->count++;
+        }
+
+        batches.push_back( newBatch );
+    }
+
+    rv = batches[index - firstBatch];
+
+    pthread_mutex_unlock( &lock );
+
+    return rv;
+}
+
+void SharedTraceSource::Release( ncounter_t consumer, ncounter_t position )
+{
+    pthread_mutex_lock( &lock );
+
+    positions[consumer] = position;
+
+    ncounter_t slowest = *std::min_element( positions.begin( ), positions.end( ) );
+
+    /* Once everyone has detached the final batch can go as well. */
+    while( firstBatch < slowest && !batches.empty( ) )
+    {
+        delete [] batches.front( )->lines;
+        delete batches.front( );
+        batches.pop_front( );
+        firstBatch++;
+    }
+
+    pthread_cond_broadcast( &released );
+    pthread_mutex_unlock( &lock );
+}
+
+SharedTraceReader::SharedTraceReader( SharedTraceSource *source, ncounter_t consumer )
+{
+    this->source = source;
+    this->consumer = consumer;
+
+    batch = NULL;
+    batchIndex = 0;
+    nextLine = 0;
+}
+
+SharedTraceReader::~SharedTraceReader( )
+{
+    /* Stop holding back the other consumers. */
+    source->Release( consumer, std::numeric_limits<ncounter_t>::max( ) );
+}
+
+void SharedTraceReader::SetTraceFile( std::string /*file*/ )
+{
+    /* The trace is opened once by the source. */
+}
+
+std::string SharedTraceReader::GetTraceFile( )
+{
+    return source->GetTraceFile( );
+}
+
+bool SharedTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    while( true )
+    {
+        if( batch == NULL )
+        {
+            batch = source->GetBatch( batchIndex );
+            nextLine = 0;
+        }
+
+        if( nextLine < batch->count )
+        {
+            *nextAccess = batch->lines[nextLine];
+            nextLine++;
+
+            return true;
+        }
+
+        if( batch->endOfTrace )
+        {
+            *nextAccess = batch->lines[batch->count];
+
+            return false;
+        }
+
+        batchIndex++;
+        batch = NULL;
+        source->Release( consumer, batchIndex );
+    }
+}
+
+int SharedTraceReader::GetNextNAccesses( unsigned int N, 
+                                         std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        /* We need a new TraceLine so the old values are not overwritten. */
+        TraceLine *nextLine = new TraceLine( );
+
+        if( GetNextAccess( nextLine ) )
+        {
+            nextAccesses->push_back( nextLine );
+            successes++;
+        }
+        else
+        {
+            delete nextLine;
+        }
+    }
+
+    return successes;
+}
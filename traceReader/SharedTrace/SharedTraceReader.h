@@ -0,0 +1,120 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __SHAREDTRACEREADER_H__
+#define __SHAREDTRACEREADER_H__
+
+#include "traceReader/GenericTraceReader.h"
+#include <deque>
+#include <pthread.h>
+
+namespace NVM {
+
+/*
+ *  Decodes one trace for several consumers, e.g., the hierarchies of a
+ *  sweep. Each consumer reads through its own SharedTraceReader. Lines are
+ *  decoded in batches by whichever consumer first needs them and a batch
+ *  is freed once every consumer has moved past it. A consumer running more
+ *  than the buffer ahead of the slowest one waits for it to catch up.
+ *
+ *  The wrapped reader is owned by the source. Readers detach when they are
+ *  deleted, so the source must outlive every reader it created.
+ */
+class SharedTraceSource
+{
+  public:
+    SharedTraceSource( GenericTraceReader *reader, ncounter_t consumers, 
+                       ncounter_t bufferLines );
+    ~SharedTraceSource( );
+
+    /* Create the reader for the given consumer, numbered from 0. */
+    GenericTraceReader *CreateReader( ncounter_t consumer );
+
+    std::string GetTraceFile( );
+
+  private:
+    friend class SharedTraceReader;
+
+    /* 
+     *  The batch that hits the end of the trace also keeps the reader's 
+     *  final (failed) line after its count lines.
+     */
+    struct Batch
+    {
+        TraceLine *lines;
+        ncounter_t count;
+        bool endOfTrace;
+    };
+
+    GenericTraceReader *reader;
+
+    /* Batch firstBatch is at the front. */
+    std::deque<Batch *> batches;
+    ncounter_t firstBatch;
+    ncounter_t maxBatches;
+    bool decodedAll;
+
+    /* The first batch each consumer still needs. */
+    std::vector<ncounter_t> positions;
+
+    pthread_mutex_t lock;
+    pthread_cond_t released;
+
+    Batch *GetBatch( ncounter_t index );
+    void Release( ncounter_t consumer, ncounter_t position );
+};
+
+class SharedTraceReader : public GenericTraceReader
+{
+  public:
+    SharedTraceReader( SharedTraceSource *source, ncounter_t consumer );
+    ~SharedTraceReader( );
+
+    void SetTraceFile( std::string file );
+    std::string GetTraceFile( );
+
+    bool GetNextAccess( TraceLine *nextAccess );
+    int  GetNextNAccesses( unsigned int N, std::vector<TraceLine *> *nextAccesses );
+
+  private:
+    SharedTraceSource *source;
+    ncounter_t consumer;
+
+    SharedTraceSource::Batch *batch;
+    ncounter_t batchIndex;
+    ncounter_t nextLine;
+};
+
+};
+
+#endif
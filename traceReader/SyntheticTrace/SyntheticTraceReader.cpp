@@ -0,0 +1,464 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceReader/SyntheticTrace/SyntheticTraceReader.h"
+#include "src/Params.h"
+#include "include/NVMHelpers.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+using namespace NVM;
+
+/* Zeta terms summed exactly before the tail is approximated. */
+static const uint64_t zipfExactTerms = 1ULL << 20;
+
+SyntheticTraceReader::SyntheticTraceReader( )
+{
+    traceFile = "";
+    config = NULL;
+    lineSize = 64;
+    rows = cols = banks = ranks = channels = subarrays = 1;
+    method = NULL;
+    translator = NULL;
+}
+
+SyntheticTraceReader::~SyntheticTraceReader( )
+{
+    delete translator;
+    delete method;
+}
+
+void SyntheticTraceReader::SetTraceFile( std::string file )
+{
+    traceFile = file;
+}
+
+std::string SyntheticTraceReader::GetTraceFile( )
+{
+    return traceFile;
+}
+
+/* The per-thread override of a key, e.g., SyntheticPattern_T1. */
+std::string SyntheticTraceReader::ThreadKey( std::string key, ncounters_t threadId )
+{
+    std::stringstream threadKey;
+
+    threadKey << key << "_T" << threadId;
+
+    return threadKey.str( );
+}
+
+std::string SyntheticTraceReader::GetThreadString( std::string key, ncounters_t threadId,
+                                                   std::string defaultValue )
+{
+    std::string threadKey = ThreadKey( key, threadId );
+
+    if( config->KeyExists( threadKey ) )
+        return config->GetString( threadKey );
+    else if( config->KeyExists( key ) )
+        return config->GetString( key );
+
+    return defaultValue;
+}
+
+uint64_t SyntheticTraceReader::GetThreadUL( std::string key, ncounters_t threadId,
+                                            uint64_t defaultValue )
+{
+    std::string threadKey = ThreadKey( key, threadId );
+
+    if( config->KeyExists( threadKey ) )
+        return config->GetValueUL( threadKey );
+    else if( config->KeyExists( key ) )
+        return config->GetValueUL( key );
+
+    return defaultValue;
+}
+
+double SyntheticTraceReader::GetThreadDouble( std::string key, ncounters_t threadId,
+                                              double defaultValue )
+{
+    std::string threadKey = ThreadKey( key, threadId );
+
+    if( config->KeyExists( threadKey ) )
+        return config->GetEnergy( threadKey );
+    else if( config->KeyExists( key ) )
+        return config->GetEnergy( key );
+
+    return defaultValue;
+}
+
+/*
+ *  Build the same address mapping as NVMain, so the row locality pattern
+ *  can place requests in a chosen row and the default region covers the
+ *  whole memory.
+ */
+void SyntheticTraceReader::InitTranslator( )
+{
+    Params *p = new Params( );
+
+    p->SetParams( config );
+
+    if( config->KeyExists( "MATHeight" ) )
+    {
+        rows = p->MATHeight;
+        subarrays = p->ROWS / p->MATHeight;
+    }
+    else
+    {
+        rows = p->ROWS;
+        subarrays = 1;
+    }
+    cols = p->COLS;
+    banks = p->BANKS;
+    ranks = p->RANKS;
+    channels = p->CHANNELS;
+
+    method = new TranslationMethod( );
+    method->SetBitWidths( NVM::mlog2( static_cast<int>( rows ) ),
+                          NVM::mlog2( static_cast<int>( cols ) ),
+                          NVM::mlog2( static_cast<int>( banks ) ),
+                          NVM::mlog2( static_cast<int>( ranks ) ),
+                          NVM::mlog2( static_cast<int>( channels ) ),
+                          NVM::mlog2( static_cast<int>( subarrays ) ) );
+    method->SetCount( rows, cols, banks, ranks, channels, subarrays );
+    method->SetAddressMappingScheme( p->AddressMappingScheme );
+
+    translator = new AddressTranslator( );
+    translator->SetTranslationMethod( method );
+
+    delete p;
+}
+
+void SyntheticTraceReader::InitThread( SyntheticThread& thread, ncounters_t threadId )
+{
+    std::string pattern = GetThreadString( "SyntheticPattern", threadId, "Sequential" );
+
+    thread.threadId = threadId;
+
+    if( pattern == "Sequential" )
+        thread.pattern = SYNTHETIC_SEQUENTIAL;
+    else if( pattern == "Strided" )
+        thread.pattern = SYNTHETIC_STRIDED;
+    else if( pattern == "Random" )
+        thread.pattern = SYNTHETIC_RANDOM;
+    else if( pattern == "Zipf" )
+        thread.pattern = SYNTHETIC_ZIPF;
+    else if( pattern == "RowLocality" )
+        thread.pattern = SYNTHETIC_ROWLOCALITY;
+    else
+    {
+        std::cout << "SyntheticTraceReader: Unknown pattern `" << pattern 
+            << "' for thread " << threadId << ". Using Sequential." << std::endl;
+        thread.pattern = SYNTHETIC_SEQUENTIAL;
+    }
+
+    uint64_t memorySize = rows * cols * banks * ranks * channels * subarrays
+                        * translator->ReverseTranslate( 0, 1, 0, 0, 0, 0 );
+
+    thread.baseAddress = GetThreadUL( "SyntheticBaseAddress", threadId, 0 );
+    if( thread.baseAddress >= memorySize )
+        thread.baseAddress = 0;
+
+    uint64_t footprint = GetThreadUL( "SyntheticFootprint", threadId, 
+                                      memorySize - thread.baseAddress );
+
+    thread.lines = footprint / lineSize;
+    if( thread.lines == 0 )
+        thread.lines = 1;
+
+    thread.stride = lineSize;
+    if( thread.pattern == SYNTHETIC_STRIDED )
+        thread.stride = GetThreadUL( "SyntheticStride", threadId, lineSize );
+
+    thread.offset = 0;
+    thread.readRatio = GetThreadDouble( "SyntheticReadRatio", threadId, 1.0 );
+    thread.rowHitRate = GetThreadDouble( "SyntheticRowHitRate", threadId, 0.5 );
+    thread.interval = GetThreadUL( "SyntheticInterval", threadId, 1 );
+    thread.requests = GetThreadUL( "SyntheticRequests", threadId, 0 );
+    thread.issued = 0;
+    thread.nextCycle = GetThreadUL( "SyntheticStartCycle", threadId, 0 );
+
+    thread.rng.seed( GetThreadUL( "SyntheticSeed", threadId, 1 ) 
+                     + 0x9E3779B97F4A7C15ULL * threadId );
+
+    thread.row = thread.bank = thread.rank = thread.channel = thread.subarray = 0;
+
+    thread.zipfTheta = thread.zipfZetaN = thread.zipfEta = 0.0;
+
+    if( thread.pattern == SYNTHETIC_ZIPF )
+    {
+        double theta = GetThreadDouble( "SyntheticZipfAlpha", threadId, 0.99 );
+
+        if( theta <= 0.0 || theta >= 1.0 )
+        {
+            std::cout << "SyntheticTraceReader: SyntheticZipfAlpha must be between 0 "
+                << "and 1 (exclusive). Using 0.99." << std::endl;
+            theta = 0.99;
+        }
+
+        /* 
+         *  zeta(n) = sum of 1/i^theta. Large regions sum the head exactly and
+         *  approximate the tail with its integral (Euler-Maclaurin).
+         */
+        uint64_t n = thread.lines;
+        uint64_t exact = std::min( n, zipfExactTerms );
+        double zetaN = 0.0;
+
+        for( uint64_t i = 1; i <= exact; i++ )
+            zetaN += std::pow( static_cast<double>( i ), -theta );
+
+        if( n > exact )
+        {
+            double k = static_cast<double>( exact );
+            double m = static_cast<double>( n );
+
+            zetaN += (std::pow( m, 1.0 - theta ) - std::pow( k, 1.0 - theta )) / (1.0 - theta)
+                   + (std::pow( m, -theta ) - std::pow( k, -theta )) / 2.0;
+        }
+
+        double zeta2 = 1.0 + std::pow( 2.0, -theta );
+
+        thread.zipfTheta = theta;
+        thread.zipfZetaN = zetaN;
+        thread.zipfEta = (1.0 - std::pow( 2.0 / static_cast<double>( n ), 1.0 - theta ))
+                       / (1.0 - zeta2 / zetaN);
+    }
+}
+
+void SyntheticTraceReader::Init( Config *conf )
+{
+    config = conf;
+
+    if( config->KeyExists( "SyntheticLineSize" ) )
+        lineSize = config->GetValueUL( "SyntheticLineSize" );
+    if( lineSize == 0 )
+        lineSize = 64;
+
+    InitTranslator( );
+
+    ncounter_t threadCount = 1;
+
+    if( config->KeyExists( "SyntheticThreads" ) )
+        threadCount = config->GetValueUL( "SyntheticThreads" );
+    if( threadCount == 0 )
+        threadCount = 1;
+
+    threads.resize( threadCount );
+
+    for( ncounter_t i = 0; i < threadCount; i++ )
+        InitThread( threads[i], static_cast<ncounters_t>( i ) );
+
+    dataBlock.SetSize( lineSize );
+    oldDataBlock.SetSize( lineSize );
+    memset( dataBlock.rawData, 0, lineSize );
+    memset( oldDataBlock.rawData, 0, lineSize );
+}
+
+double SyntheticTraceReader::NextDouble( SyntheticThread& thread )
+{
+    /* 53 random bits give a uniform double in [0, 1). */
+    return static_cast<double>( thread.rng( ) >> 11 ) * (1.0 / 9007199254740992.0);
+}
+
+uint64_t SyntheticTraceReader::NextZipf( SyntheticThread& thread )
+{
+    double u = NextDouble( thread );
+    double uz = u * thread.zipfZetaN;
+
+    if( uz < 1.0 )
+        return 0;
+
+    if( uz < 1.0 + std::pow( 0.5, thread.zipfTheta ) )
+        return 1;
+
+    uint64_t rank = static_cast<uint64_t>( static_cast<double>( thread.lines ) 
+                  * std::pow( thread.zipfEta * u - thread.zipfEta + 1.0, 
+                              1.0 / (1.0 - thread.zipfTheta) ) );
+
+    return (rank < thread.lines) ? rank : thread.lines - 1;
+}
+
+uint64_t SyntheticTraceReader::NextAddress( SyntheticThread& thread )
+{
+    uint64_t address = 0;
+
+    switch( thread.pattern )
+    {
+        case SYNTHETIC_SEQUENTIAL:
+        case SYNTHETIC_STRIDED:
+            address = thread.baseAddress + thread.offset;
+            thread.offset = (thread.offset + thread.stride) % (thread.lines * lineSize);
+            break;
+
+        case SYNTHETIC_RANDOM:
+            address = thread.baseAddress + (thread.rng( ) % thread.lines) * lineSize;
+            break;
+
+        case SYNTHETIC_ZIPF:
+            address = thread.baseAddress + NextZipf( thread ) * lineSize;
+            break;
+
+        case SYNTHETIC_ROWLOCALITY:
+            if( thread.issued == 0 || NextDouble( thread ) >= thread.rowHitRate )
+            {
+                thread.row = thread.rng( ) % rows;
+                thread.bank = thread.rng( ) % banks;
+                thread.rank = thread.rng( ) % ranks;
+                thread.channel = thread.rng( ) % channels;
+                thread.subarray = thread.rng( ) % subarrays;
+            }
+
+            address = translator->ReverseTranslate( thread.row, thread.rng( ) % cols,
+                                                    thread.bank, thread.rank,
+                                                    thread.channel, thread.subarray );
+            break;
+    }
+
+    return address;
+}
+
+/* The thread with the earliest next request; ties go to the lowest id. */
+SyntheticTraceReader::SyntheticThread *SyntheticTraceReader::NextThread( )
+{
+    SyntheticThread *next = NULL;
+
+    for( std::vector<SyntheticThread>::iterator it = threads.begin( );
+         it != threads.end( ); ++it )
+    {
+        if( it->requests != 0 && it->issued >= it->requests )
+            continue;
+
+        if( next == NULL || it->nextCycle < next->nextCycle )
+            next = &(*it);
+    }
+
+    return next;
+}
+
+bool SyntheticTraceReader::GetNextAccess( TraceLine *nextAccess )
+{
+    if( config == NULL )
+    {
+        std::cerr << "SyntheticTraceReader: Init was not called!" << std::endl;
+        return false;
+    }
+
+    SyntheticThread *thread = NextThread( );
+
+    if( thread == NULL )
+    {
+        NVMAddress nAddress;
+        nAddress.SetPhysicalAddress( 0xDEADC0DEDEADBEEFULL );
+        nextAccess->SetLine( nAddress, NOP, 0, dataBlock, oldDataBlock, 0 );
+        std::cout << "SyntheticTraceReader: Generated all requests!" << std::endl;
+        return false;
+    }
+
+    NVMAddress nAddress;
+    OpType operation = READ;
+    ncycle_t cycle = thread->nextCycle;
+
+    nAddress.SetPhysicalAddress( NextAddress( *thread ) );
+
+    if( thread->readRatio < 1.0 && NextDouble( *thread ) >= thread->readRatio )
+    {
+        operation = WRITE;
+
+        /* Random contents, so data-dependent write models see bit flips. */
+        for( uint64_t i = 0; i + 8 <= lineSize; i += 8 )
+        {
+            uint64_t word = thread->rng( );
+            memcpy( dataBlock.rawData + i, &word, sizeof(word) );
+        }
+    }
+
+    thread->issued++;
+    thread->nextCycle += thread->interval;
+
+    nextAccess->SetLine( nAddress, operation, cycle, dataBlock, oldDataBlock, 
+                         thread->threadId );
+
+    return true;
+}
+
+/* Generate and drop requests until every thread reaches the cycle. */
+bool SyntheticTraceReader::SeekToCycle( ncycle_t cycle )
+{
+    TraceLine skipped;
+
+    if( config == NULL )
+        return false;
+
+    for( ;; )
+    {
+        SyntheticThread *thread = NextThread( );
+
+        if( thread == NULL || thread->nextCycle >= cycle )
+            break;
+
+        GetNextAccess( &skipped );
+    }
+
+    return true;
+}
+
+/* 
+ * Get the next N accesses to main memory. Called GetNextAccess N times and 
+ * places the return values into a vector of TraceLine pointers.
+ */
+int SyntheticTraceReader::GetNextNAccesses( unsigned int N, 
+                                            std::vector<TraceLine *> *nextAccesses )
+{
+    int successes = 0;
+
+    for( unsigned int i = 0; i < N; i++ )
+    {
+        /* We need a new TraceLine so the old values are not overwritten. */
+        TraceLine *nextLine = new TraceLine( );
+
+        if( GetNextAccess( nextLine ) )
+        {
+            nextAccesses->push_back( nextLine );
+            successes++;
+        }
+        else
+        {
+            delete nextLine;
+        }
+    }
+
+    return successes;
+}
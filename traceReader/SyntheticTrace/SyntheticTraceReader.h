@@ -0,0 +1,142 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __SYNTHETICTRACEREADER_H__
+#define __SYNTHETICTRACEREADER_H__
+
+#include "traceReader/GenericTraceReader.h"
+#include "src/AddressTranslator.h"
+#include "src/Config.h"
+#include <random>
+
+namespace NVM {
+
+enum SyntheticPattern
+{
+    SYNTHETIC_SEQUENTIAL,
+    SYNTHETIC_STRIDED,
+    SYNTHETIC_RANDOM,
+    SYNTHETIC_ZIPF,
+    SYNTHETIC_ROWLOCALITY
+};
+
+/*
+ *  Generates requests from config keys instead of reading a trace file.
+ *  Each of the SyntheticThreads threads has its own pattern, address
+ *  region, read ratio and request interval. A key suffixed with _T<n>
+ *  (e.g., SyntheticPattern_T1) overrides the shared value for thread n.
+ *
+ *  Patterns:
+ *    Sequential  - consecutive lines of the region
+ *    Strided     - every SyntheticStride bytes of the region
+ *    Random      - uniformly random lines of the region
+ *    Zipf        - lines ranked by a Zipf distribution (SyntheticZipfAlpha),
+ *                  so the lowest lines of the region form the hot set
+ *    RowLocality - stays in the open row with probability
+ *                  SyntheticRowHitRate, otherwise moves to a random row,
+ *                  bank, rank and channel under the configured mapping
+ *
+ *  The trace file name is ignored. Generation ends once every thread has
+ *  issued SyntheticRequests requests (0 = never).
+ */
+class SyntheticTraceReader : public GenericTraceReader
+{
+  public:
+    SyntheticTraceReader( );
+    ~SyntheticTraceReader( );
+
+    void Init( Config *conf );
+
+    void SetTraceFile( std::string file );
+    std::string GetTraceFile( );
+
+    bool GetNextAccess( TraceLine *nextAccess );
+    int  GetNextNAccesses( unsigned int N, std::vector<TraceLine *> *nextAccesses );
+
+    bool SeekToCycle( ncycle_t cycle );
+
+  private:
+    struct SyntheticThread
+    {
+        ncounters_t threadId;
+        SyntheticPattern pattern;
+        uint64_t baseAddress;
+        uint64_t lines;
+        uint64_t stride;
+        uint64_t offset;
+        double readRatio;
+        double rowHitRate;
+        ncycle_t interval;
+        ncounter_t requests;
+        ncounter_t issued;
+        ncycle_t nextCycle;
+
+        /* Zipf generator state (Gray et al., SIGMOD '94). */
+        double zipfTheta;
+        double zipfZetaN;
+        double zipfEta;
+
+        /* Open row for the row locality pattern. */
+        uint64_t row, bank, rank, channel, subarray;
+
+        std::mt19937_64 rng;
+    };
+
+    std::string traceFile;
+    Config *config;
+    std::vector<SyntheticThread> threads;
+
+    uint64_t lineSize;
+    uint64_t rows, cols, banks, ranks, channels, subarrays;
+    TranslationMethod *method;
+    AddressTranslator *translator;
+
+    NVMDataBlock dataBlock;
+    NVMDataBlock oldDataBlock;
+
+    std::string ThreadKey( std::string key, ncounters_t threadId );
+    std::string GetThreadString( std::string key, ncounters_t threadId, std::string defaultValue );
+    uint64_t GetThreadUL( std::string key, ncounters_t threadId, uint64_t defaultValue );
+    double GetThreadDouble( std::string key, ncounters_t threadId, double defaultValue );
+
+    void InitTranslator( );
+    void InitThread( SyntheticThread& thread, ncounters_t threadId );
+    SyntheticThread *NextThread( );
+    uint64_t NextAddress( SyntheticThread& thread );
+    uint64_t NextZipf( SyntheticThread& thread );
+    double NextDouble( SyntheticThread& thread );
+};
+
+};
+
+#endif
@@ -37,6 +37,10 @@
 /* Add your trace reader's include below. */
 #include "traceReader/NVMainTrace/NVMainTraceReader.h"
 #include "traceReader/RubyTrace/RubyTraceReader.h"
+#include "traceReader/NVMainBinaryTrace/NVMainBinaryTraceReader.h"
+#include "traceReader/CompressedTrace/NVMainCompressedTraceReader.h"
+#include "traceReader/SyntheticTrace/SyntheticTraceReader.h"
+#include "traceReader/MergedTrace/MergedTraceReader.h"
 
 using namespace NVM;
 
@@ -52,6 +56,14 @@ GenericTraceReader *TraceReaderFactory::CreateNewTraceReader( std::string reader
         tracer = new NVMainTraceReader( );
     else if( reader == "RubyTrace" )
         tracer = new RubyTraceReader( );
+    else if( reader == "NVMainBinaryTrace" )
+        tracer = new NVMainBinaryTraceReader( );
+    else if( reader == "NVMainCompressedTrace" )
+        tracer = new NVMainCompressedTraceReader( );
+    else if( reader == "SyntheticTrace" )
+        tracer = new SyntheticTraceReader( );
+    else if( reader == "MergedTrace" )
+        tracer = new MergedTraceReader( );
 
     if( tracer == NULL )
         std::cout << "NVMain: Unknown trace reader `" << reader << "'." 
@@ -0,0 +1,276 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceSim/TraceCore.h"
+#include <sstream>
+#include <limits>
+#include <algorithm>
+
+using namespace NVM;
+
+TraceCore::TraceCore( ncounters_t threadId, Config *config )
+{
+    std::stringstream name;
+
+    this->threadId = threadId;
+
+    robSize = GetThreadValue( config, "CoreROBSize", 128 );
+    mshrs = GetThreadValue( config, "CoreMSHRs", 16 );
+    width = GetThreadValue( config, "CoreWidth", 4 );
+
+    if( robSize == 0 )
+        robSize = 1;
+    if( mshrs == 0 )
+        mshrs = 1;
+    if( width == 0 )
+        width = 1;
+
+    started = false;
+    headBlocked = false;
+    lastTraceCycle = 0;
+    lastPosition = 0;
+    fetchPosition = 0;
+    fetchSlot = 0;
+    startCycle = 0;
+    finishCycle = 0;
+
+    instructions = 0;
+    reads = 0;
+    writes = 0;
+    robStalls = 0;
+    mshrStalls = 0;
+    cycles = 0;
+    ipc = 0.0;
+    averageReadLatency = 0.0;
+    totalReadLatency = 0;
+
+    name << "core" << threadId;
+    StatName( name.str( ) );
+}
+
+TraceCore::~TraceCore( )
+{
+    while( !lines.empty( ) )
+    {
+        delete lines.front( );
+        lines.pop_front( );
+    }
+}
+
+/* The per-thread override of a key, e.g., CoreROBSize_T1. */
+ncounter_t TraceCore::GetThreadValue( Config *config, std::string key, 
+                                      ncounter_t defaultValue )
+{
+    std::stringstream threadKey;
+
+    threadKey << key << "_T" << threadId;
+
+    if( config->KeyExists( threadKey.str( ) ) )
+        return config->GetValueUL( threadKey.str( ) );
+    else if( config->KeyExists( key ) )
+        return config->GetValueUL( key );
+
+    return defaultValue;
+}
+
+void TraceCore::RegisterStats( )
+{
+    AddStat(instructions);
+    AddStat(reads);
+    AddStat(writes);
+    AddStat(robStalls);
+    AddStat(mshrStalls);
+    AddStat(cycles);
+    AddStat(ipc);
+    AddUnitStat(averageReadLatency, "cycles");
+}
+
+void TraceCore::CalculateStats( )
+{
+    instructions = lastPosition;
+    cycles = finishCycle - startCycle;
+
+    if( cycles > 0 )
+        ipc = static_cast<double>( instructions ) / static_cast<double>( cycles );
+
+    if( reads > 0 )
+        averageReadLatency = static_cast<double>( totalReadLatency ) 
+                           / static_cast<double>( reads );
+}
+
+void TraceCore::AddLine( TraceLine *line )
+{
+    lines.push_back( line );
+}
+
+ncounter_t TraceCore::QueuedLines( )
+{
+    return lines.size( );
+}
+
+TraceLine *TraceCore::GetLine( )
+{
+    return lines.empty( ) ? NULL : lines.front( );
+}
+
+bool TraceCore::Done( )
+{
+    return lines.empty( ) && outstandingReads.empty( );
+}
+
+/* Instruction number of the next memory request. */
+ncounter_t TraceCore::HeadPosition( )
+{
+    ncycle_t traceCycle = lines.front( )->GetCycle( );
+
+    if( !started || traceCycle <= lastTraceCycle )
+        return lastPosition + 1;
+
+    return lastPosition + (traceCycle - lastTraceCycle);
+}
+
+/*
+ *  Fetch until the given cycle, but not past the limit instruction. Once
+ *  the limit is reached the core is stalled, so fetch time stops there.
+ */
+void TraceCore::AdvanceFetch( ncycle_t cycle, ncounter_t limit )
+{
+    ncycle_t slot = cycle * width;
+
+    if( limit <= fetchPosition || slot <= fetchSlot )
+        return;
+
+    ncounter_t progress = std::min( limit - fetchPosition, slot - fetchSlot );
+
+    fetchPosition += progress;
+    fetchSlot += progress;
+
+    if( fetchPosition == limit )
+        fetchSlot = slot;
+}
+
+ncycle_t TraceCore::ReadyCycle( )
+{
+    if( lines.empty( ) )
+        return std::numeric_limits<ncycle_t>::max( );
+
+    /* The first request of a thread starts at its trace cycle. */
+    if( !started )
+        return lines.front( )->GetCycle( );
+
+    ncounter_t position = HeadPosition( );
+    bool isRead = (lines.front( )->GetOperation( ) == READ);
+
+    if( !outstandingReads.empty( ) && position >= *outstandingReads.begin( ) + robSize )
+    {
+        if( !headBlocked )
+            robStalls++;
+
+        headBlocked = true;
+        return std::numeric_limits<ncycle_t>::max( );
+    }
+
+    if( isRead && outstandingReads.size( ) >= mshrs )
+    {
+        if( !headBlocked )
+            mshrStalls++;
+
+        headBlocked = true;
+        return std::numeric_limits<ncycle_t>::max( );
+    }
+
+    return (fetchSlot + (position - fetchPosition)) / width;
+}
+
+void TraceCore::Issue( NVMainRequest *request, ncycle_t cycle )
+{
+    TraceLine *line = lines.front( );
+    ncounter_t position = HeadPosition( );
+
+    if( !started )
+    {
+        started = true;
+        startCycle = cycle;
+        fetchSlot = cycle * width;
+        position = 1;
+    }
+
+    fetchSlot = std::max( fetchSlot + (position - fetchPosition), cycle * width );
+    fetchPosition = position;
+    lastPosition = position;
+    lastTraceCycle = line->GetCycle( );
+    headBlocked = false;
+    finishCycle = std::max( finishCycle, cycle );
+
+    if( request->type == READ )
+    {
+        reads++;
+        outstandingReads.insert( position );
+        readPositions[request] = position;
+        readIssueCycles[request] = cycle;
+    }
+    else
+    {
+        writes++;
+    }
+
+    lines.pop_front( );
+    delete line;
+}
+
+/* Returns true if the request was a read issued by this core. */
+bool TraceCore::Complete( NVMainRequest *request, ncycle_t cycle )
+{
+    std::map<NVMainRequest *, ncounter_t>::iterator it = readPositions.find( request );
+
+    if( it == readPositions.end( ) )
+        return false;
+
+    /* Fetch ran up to the limits in place until this read completed. */
+    ncounter_t limit = *outstandingReads.begin( ) + robSize - 1;
+
+    if( !lines.empty( ) )
+        limit = std::min( limit, HeadPosition( ) - 1 );
+
+    AdvanceFetch( cycle, limit );
+
+    outstandingReads.erase( it->second );
+    readPositions.erase( it );
+
+    totalReadLatency += cycle - readIssueCycles[request];
+    readIssueCycles.erase( request );
+
+    finishCycle = std::max( finishCycle, cycle );
+
+    return true;
+}
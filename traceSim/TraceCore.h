@@ -0,0 +1,117 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __TRACESIM_TRACECORE_H__
+#define __TRACESIM_TRACECORE_H__
+
+#include "src/NVMObject.h"
+#include "src/Config.h"
+#include "traceReader/TraceLine.h"
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+
+namespace NVM {
+
+/*
+ *  A lightweight out-of-order core replaying one thread of a trace. The
+ *  trace cycle delta between two requests of the thread is taken as the
+ *  number of non-memory instructions between them, fetched CoreWidth per
+ *  cycle. A read holds its ROB entry and an MSHR until it completes, so
+ *  the core stops fetching once it is CoreROBSize instructions past the
+ *  oldest outstanding read, or when CoreMSHRs reads are in flight. Writes
+ *  are posted. Fetch progress is tracked in 1/CoreWidth cycle slots, so
+ *  the model only does work when a request is issued or completes.
+ */
+class TraceCore : public NVMObject
+{
+  public:
+    TraceCore( ncounters_t threadId, Config *config );
+    ~TraceCore( );
+
+    void RegisterStats( );
+    void CalculateStats( );
+
+    void Cycle( ncycle_t ) { }
+
+    void AddLine( TraceLine *line );
+    ncounter_t QueuedLines( );
+    TraceLine *GetLine( );
+
+    /* Cycle the next request may issue, or the maximum if it is blocked. */
+    ncycle_t ReadyCycle( );
+
+    void Issue( NVMainRequest *request, ncycle_t cycle );
+    bool Complete( NVMainRequest *request, ncycle_t cycle );
+    bool Done( );
+
+  private:
+    ncounters_t threadId;
+    ncounter_t robSize;
+    ncounter_t mshrs;
+    ncounter_t width;
+
+    std::deque<TraceLine *> lines;
+    std::map<NVMainRequest *, ncounter_t> readPositions;
+    std::set<ncounter_t> outstandingReads;
+
+    bool started;
+    bool headBlocked;
+    ncycle_t lastTraceCycle;
+    ncounter_t lastPosition;
+    ncounter_t fetchPosition;
+    ncycle_t fetchSlot;
+    ncycle_t startCycle;
+    ncycle_t finishCycle;
+
+    ncounter_t instructions;
+    ncounter_t reads;
+    ncounter_t writes;
+    ncounter_t robStalls;
+    ncounter_t mshrStalls;
+    ncycle_t cycles;
+    double ipc;
+    double averageReadLatency;
+    ncycle_t totalReadLatency;
+    std::map<NVMainRequest *, ncycle_t> readIssueCycles;
+
+    ncounter_t GetThreadValue( Config *config, std::string key, ncounter_t defaultValue );
+    ncounter_t HeadPosition( );
+    void AdvanceFetch( ncycle_t cycle, ncounter_t limit );
+};
+
+};
+
+#endif
@@ -35,12 +35,26 @@
 #include <cmath>
 #include <stdlib.h>
 #include <fstream>
+#include <algorithm>
+#include <limits>
+#include <functional>
+#include <set>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <cstdio>
 
 #include "src/Interconnect.h"
 #include "Interconnect/InterconnectFactory.h"
 #include "src/Config.h"
+#include "src/StatSampler.h"
 #include "src/TranslationMethod.h"
 #include "traceReader/TraceReaderFactory.h"
+#include "traceReader/ReadAheadTrace/ReadAheadTraceReader.h"
+#include "traceReader/LLCFilter/LLCFilterTraceReader.h"
+#include "traceReader/SharedTrace/SharedTraceReader.h"
+#include "traceWriter/TraceWriterFactory.h"
 #include "src/AddressTranslator.h"
 #include "Decoders/DecoderFactory.h"
 #include "src/MemoryController.h"
@@ -50,8 +64,11 @@
 #include "include/NVMHelpers.h"
 #include "Utils/HookFactory.h"
 #include "src/EventQueue.h"
+#include "src/Checkpoint.h"
+#include "StatsWriters/StatsWriterFactory.h"
 #include "NVM/nvmain.h"
 #include "traceSim/traceMain.h"
+#include "traceSim/TraceCore.h"
 
 using namespace NVM;
 
@@ -64,7 +81,15 @@ int main( int argc, char *argv[] )
 
 TraceMain::TraceMain( )
 {
-
+    outstandingRequests = 0;
+    cpuPeriod = 0.0;
+    memoryPeriod = 0.0;
+    forkCycle = 0;
+    forkPending = false;
+    checkpointCycle = 0;
+    checkpointInterval = 0;
+    traceLines = 0;
+    timingStartCycle = 0;
 }
 
 TraceMain::~TraceMain( )
@@ -74,19 +99,8 @@ TraceMain::~TraceMain( )
 
 int TraceMain::RunTrace( int argc, char *argv[] )
 {
-    Stats *stats = new Stats( );
     Config *config = new Config( );
-    GenericTraceReader *trace = NULL;
-    TraceLine *tl = new TraceLine( );
-    SimInterface *simInterface = new NullInterface( );
-    NVMain *nvmain = new NVMain( );
-    EventQueue *mainEventQueue = new EventQueue( );
-    GlobalEventQueue *globalEventQueue = new GlobalEventQueue( );
-    TagGenerator *tagGenerator = new TagGenerator( 1000 );
-    bool IgnoreData = false;
-
-    uint64_t simulateCycles;
-    uint64_t currentCycle;
+    ncycle_t traceCycles;
     
     if( argc < 4 )
     {
@@ -104,12 +118,6 @@ int TraceMain::RunTrace( int argc, char *argv[] )
     std::cout << std::endl << std::endl;
 
     config->Read( argv[1] );
-    config->SetSimInterface( simInterface );
-    SetEventQueue( mainEventQueue );
-    SetGlobalEventQueue( globalEventQueue );
-    SetStats( stats );
-    SetTagGenerator( tagGenerator );
-    std::ofstream statStream;
 
     /* Allow for overriding config parameter values for trace simulations from command line. */
     if( argc > 4 )
@@ -128,17 +136,134 @@ int TraceMain::RunTrace( int argc, char *argv[] )
         }
     }
 
+    if( argc == 3 )
+        traceCycles = 0;
+    else
+        traceCycles = strtoull( argv[3], NULL, 10 );
+
+    /* Run every configuration of the sweep on one pass over the trace. */
+    if( config->KeyExists( "SweepFile" ) )
+        return RunSweep( config, argv[2], traceCycles );
+
+    return Simulate( config, argv[2], traceCycles, NULL );
+}
+
+/*
+ *  Simulate one memory hierarchy built from config. The trace is opened 
+ *  from traceFile unless a reader is given, which is then owned here.
+ */
+int TraceMain::Simulate( Config *config, std::string traceFile, ncycle_t traceCycles,
+                         GenericTraceReader *sharedTrace )
+{
+    Stats *stats = new Stats( );
+    GenericTraceReader *trace = sharedTrace;
+    TraceLine *tl = new TraceLine( );
+    SimInterface *simInterface = new NullInterface( );
+    NVMain *nvmain = new NVMain( );
+    EventQueue *mainEventQueue = new EventQueue( );
+    GlobalEventQueue *globalEventQueue = new GlobalEventQueue( );
+    TagGenerator *tagGenerator = new TagGenerator( 1000 );
+    bool IgnoreData = false;
+    ncycle_t traceStartCycle = 0;
+    FilterCache *llc = NULL;
+
+    uint64_t simulateCycles;
+    uint64_t currentCycle;
+
+    config->SetSimInterface( simInterface );
+    SetEventQueue( mainEventQueue );
+    SetGlobalEventQueue( globalEventQueue );
+    SetStats( stats );
+    SetTagGenerator( tagGenerator );
+    std::ofstream statStream;
+
     if( config->KeyExists( "StatsFile" ) )
     {
         statStream.open( config->GetString( "StatsFile" ).c_str(), 
                          std::ofstream::out | std::ofstream::app );
     }
 
+    if( config->KeyExists( "StatsFormat" ) )
+    {
+        StatsWriter *statsWriter = StatsWriterFactory::CreateStatsWriter( config->GetString( "StatsFormat" ) );
+
+        if( statsWriter != NULL && !statsWriter->IsPlainText( ) && !statStream.is_open( ) )
+        {
+            std::cout << "Warning: StatsFormat " << config->GetString( "StatsFormat" )
+                << " needs a StatsFile. Printing text stats instead." << std::endl;
+            delete statsWriter;
+            statsWriter = NULL;
+        }
+
+        stats->SetWriter( statsWriter );
+    }
+
     if( config->KeyExists( "IgnoreData" ) && config->GetString( "IgnoreData" ) == "true" )
     {
         IgnoreData = true;
     }
 
+    /* Fork the sets of ForkFile from the warm state at ForkCycle. */
+    if( config->KeyExists( "ForkFile" ) )
+    {
+        if( !ReadOverrideSets( config->GetString( "ForkFile" ), forkSets ) )
+            return 1;
+
+        /* Threads do not survive a fork. */
+        if( config->KeyExists( "TraceReadAhead" ) && config->GetBool( "TraceReadAhead" ) )
+        {
+            std::cout << "Warning: TraceReadAhead is disabled by ForkFile." << std::endl;
+            config->SetValue( "TraceReadAhead", "false" );
+        }
+
+        if( config->KeyExists( "ParallelChannels" ) && config->GetBool( "ParallelChannels" ) )
+        {
+            std::cout << "Warning: ParallelChannels is disabled by ForkFile." << std::endl;
+            config->SetValue( "ParallelChannels", "false" );
+        }
+
+        /* ForkCycle is in trace cycles, like CYCLES. */
+        ncycle_t traceForkCycle = 0;
+
+        if( config->KeyExists( "ForkCycle" ) )
+            traceForkCycle = config->GetValueUL( "ForkCycle" );
+
+        forkCycle = (ncycle_t)ceil( ((double)(config->GetValue( "CPUFreq" )) 
+                    / (double)(config->GetValue( "CLK" ))) * traceForkCycle ); 
+        forkPending = true;
+    }
+
+    /* Checkpoint at CheckpointCycle, then every CheckpointInterval trace cycles. */
+    if( config->KeyExists( "CheckpointCycle" ) || config->KeyExists( "RestoreDirectory" ) )
+    {
+        double memoryCyclesPerTraceCycle = (double)(config->GetValue( "CPUFreq" )) 
+                                         / (double)(config->GetValue( "CLK" ));
+
+        if( config->KeyExists( "ParallelChannels" ) && config->GetBool( "ParallelChannels" ) )
+        {
+            std::cout << "Warning: ParallelChannels is disabled by checkpoints." << std::endl;
+            config->SetValue( "ParallelChannels", "false" );
+        }
+
+        if( config->KeyExists( "CheckpointCycle" ) )
+        {
+            checkpointDirectory = "checkpoint";
+            if( config->KeyExists( "CheckpointDirectory" ) )
+                checkpointDirectory = config->GetString( "CheckpointDirectory" );
+
+            checkpointCycle = (ncycle_t)ceil( memoryCyclesPerTraceCycle 
+                            * config->GetValueUL( "CheckpointCycle" ) );
+
+            if( config->KeyExists( "CheckpointInterval" ) )
+                checkpointInterval = (ncycle_t)ceil( memoryCyclesPerTraceCycle 
+                                   * config->GetValueUL( "CheckpointInterval" ) );
+
+            /* Cycle 0 means that no checkpoint is pending. */
+            if( checkpointCycle == 0 )
+                checkpointCycle = (checkpointInterval != 0) ? checkpointInterval : 1;
+        }
+    }
+
     /*  Add any specified hooks */
     std::vector<std::string>& hookList = config->GetHooks( );
 
@@ -173,18 +298,55 @@ int TraceMain::RunTrace( int argc, char *argv[] )
     std::cout << "traceMain (" << (void*)(this) << ")" << std::endl;
     nvmain->PrintHierarchy( );
 
-    if( config->KeyExists( "TraceReader" ) )
-        trace = TraceReaderFactory::CreateNewTraceReader( 
-                config->GetString( "TraceReader" ) );
-    else
-        trace = TraceReaderFactory::CreateNewTraceReader( "NVMainTrace" );
+    /* Measure the latency-bandwidth curve instead of running a trace. */
+    if( config->KeyExists( "LoadedLatency" ) && config->GetBool( "LoadedLatency" ) )
+    {
+        std::ostream& refStream = (statStream.is_open()) ? statStream : std::cout;
 
-    trace->SetTraceFile( argv[2] );
+        RunLoadedLatency( config, refStream );
 
-    if( argc == 3 )
-        simulateCycles = 0;
-    else
-        simulateCycles = atoi( argv[3] );
+        GetChild( )->CalculateStats( );
+        stats->PrintAll( refStream );
+
+        std::cout << "Exiting at cycle " << globalEventQueue->GetCurrentCycle( ) 
+            << " because the loaded-latency curve is complete." << std::endl;
+
+        delete trace;
+        delete config;
+        delete stats;
+
+        return 0;
+    }
+
+    /* A shared reader was positioned by whoever opened the trace. */
+    if( trace == NULL )
+        trace = OpenTrace( config, traceFile, traceStartCycle );
+    else if( config->KeyExists( "TraceStartCycle" ) )
+        traceStartCycle = config->GetValueUL( "TraceStartCycle" );
+
+    /* Filter CPU accesses through a last level cache before memory. */
+    if( config->KeyExists( "LLCFilter" ) && config->GetBool( "LLCFilter" ) )
+    {
+        LLCFilterTraceReader *llcFilter = new LLCFilterTraceReader( trace, config );
+
+        llc = llcFilter->GetCache( );
+        llc->SetStats( stats );
+        llc->RegisterStats( );
+
+        trace = llcFilter;
+    }
+
+    /* Rewrite the trace in another format instead of simulating it. */
+    if( config->KeyExists( "TraceConvertFile" ) )
+    {
+        int rv = ConvertTrace( trace, config );
+
+        delete trace;
+
+        return rv;
+    }
+
+    simulateCycles = traceCycles;
 
     std::cout << "*** Simulating " << simulateCycles << " input cycles. (";
 
@@ -198,8 +360,120 @@ int TraceMain::RunTrace( int argc, char *argv[] )
     std::cout << simulateCycles << " memory cycles) ***" << std::endl;
 
     currentCycle = 0;
-    while( currentCycle <= simulateCycles || simulateCycles == 0 )
+    timingStartCycle = traceStartCycle;
+
+    /* Replay each thread on its own core model instead of in trace order. */
+    bool coreModel = config->KeyExists( "CoreModel" ) && config->GetBool( "CoreModel" );
+    bool restored = false;
+
+    if( coreModel && (checkpointCycle != 0 || config->KeyExists( "RestoreDirectory" )) )
+    {
+        std::cout << "Warning: Checkpoints are not supported by CoreModel and are "
+            << "disabled." << std::endl;
+        checkpointCycle = 0;
+    }
+    else if( config->KeyExists( "RestoreDirectory" ) )
+    {
+        /* The checkpoint holds the state of any functional warmup. */
+        restored = true;
+
+        if( !RestoreSimulation( config->GetString( "RestoreDirectory" ), traceFile, 
+                                traceStartCycle, trace, tl ) )
+        {
+            delete trace;
+            delete config;
+            delete stats;
+
+            return 1;
+        }
+
+        currentCycle = globalEventQueue->GetCurrentCycle( );
+
+        /* Skip the checkpoints the restored run has already passed. */
+        while( checkpointCycle != 0 && checkpointCycle <= currentCycle )
+            checkpointCycle = (checkpointInterval != 0) ? checkpointCycle + checkpointInterval : 0;
+    }
+
+    if( config->KeyExists( "FunctionalWarmup" ) && !restored )
+        FunctionalWarmup( trace, tl, config->GetValueUL( "FunctionalWarmup" ), IgnoreData );
+
+    /* Simulate sampled windows of SamplingInterval trace lines. */
+    bool sampling = config->KeyExists( "SamplingInterval" ) 
+                 && config->GetValueUL( "SamplingInterval" ) != 0;
+    double samplingConfidence = 0.95;
+
+    if( sampling && coreModel )
+    {
+        std::cout << "Warning: Sampling is not supported by CoreModel and is "
+            << "disabled." << std::endl;
+        sampling = false;
+    }
+
+    if( sampling && (forkPending || checkpointCycle != 0) )
+    {
+        std::cout << "Warning: ForkFile and CheckpointCycle are disabled by "
+            << "sampling." << std::endl;
+        forkPending = false;
+        checkpointCycle = 0;
+    }
+
+    /* Only read when sampling, so unsampled runs do not warn about it. */
+    if( sampling )
+        config->GetEnergy( "SamplingConfidence", samplingConfidence );
+
+    /* Record a time series of StatSamplerStats every StatSamplerInterval memory cycles. */
+    StatSampler *statSampler = NULL;
+
+    if( config->KeyExists( "StatSamplerInterval" ) 
+        && config->GetValueUL( "StatSamplerInterval" ) != 0 )
+    {
+        /* The writer thread does not survive a fork. */
+        if( forkPending )
+        {
+            std::cout << "Warning: StatSamplerInterval is disabled by ForkFile." << std::endl;
+        }
+        else if( config->KeyExists( "ParallelChannels" ) && config->GetBool( "ParallelChannels" ) )
+        {
+            std::cout << "Warning: StatSamplerInterval is disabled by ParallelChannels." 
+                << std::endl;
+        }
+        else
+        {
+            statSampler = new StatSampler( );
+
+            if( statSampler->Init( config, stats, globalEventQueue->GetCurrentCycle( ) ) )
+            {
+                globalEventQueue->SetStatSampler( statSampler );
+            }
+            else
+            {
+                delete statSampler;
+                statSampler = NULL;
+            }
+        }
+    }
+
+    if( coreModel )
+        currentCycle = RunCoreModel( trace, config, simulateCycles, 
+                                     timingStartCycle, IgnoreData );
+    else if( sampling )
+        currentCycle = RunSampling( trace, tl, config, simulateCycles, samplingConfidence, 
+                                    IgnoreData, (statStream.is_open()) ? statStream : std::cout );
+
+    while( !coreModel && !sampling && (currentCycle <= simulateCycles || simulateCycles == 0) )
     {
+        if( forkPending && currentCycle >= forkCycle )
+            ForkChildren( config, trace );
+
+        if( checkpointCycle != 0 && currentCycle >= checkpointCycle )
+        {
+            TakeCheckpoint( traceFile, traceStartCycle );
+            currentCycle = globalEventQueue->GetCurrentCycle( );
+
+            if( currentCycle >= simulateCycles && simulateCycles != 0 )
+                break;
+        }
+
         if( !trace->GetNextAccess( tl ) )
         {
             /* Force all modules to drain requests. */
@@ -211,9 +485,11 @@ int TraceMain::RunTrace( int argc, char *argv[] )
             /* Wait for requests to drain. */
             while( outstandingRequests > 0 )
             {
-                globalEventQueue->Cycle( 1 );
+                ncycle_t stallCycles = StallCycles( NULL, 0 );
+
+                globalEventQueue->Cycle( stallCycles );
               
-                currentCycle++;
+                currentCycle += stallCycles;
 
                 /* Retry drain each cycle if it failed. */
                 if( !draining )
@@ -223,6 +499,8 @@ int TraceMain::RunTrace( int argc, char *argv[] )
             break;
         }
 
+        traceLines++;
+
         NVMainRequest *request = new NVMainRequest( );
         
         request->address = tl->GetAddress( );
@@ -242,6 +520,11 @@ int TraceMain::RunTrace( int argc, char *argv[] )
                 && config->GetString( "IgnoreTraceCycle" ) == "true" )
             tl->SetLine( tl->GetAddress( ), tl->GetOperation( ), 0, 
                          tl->GetData( ), tl->GetOldData( ), tl->GetThreadId( ) );
+        else if( timingStartCycle != 0 )
+            tl->SetLine( tl->GetAddress( ), tl->GetOperation( ), 
+                         (tl->GetCycle( ) > timingStartCycle) 
+                         ? tl->GetCycle( ) - timingStartCycle : 0, 
+                         tl->GetData( ), tl->GetOldData( ), tl->GetThreadId( ) );
 
         if( request->type != READ && request->type != WRITE )
             std::cout << "traceMain: Unknown Operation: " << request->type 
@@ -284,7 +567,11 @@ int TraceMain::RunTrace( int argc, char *argv[] )
                 if( currentCycle >= simulateCycles && simulateCycles != 0 )
                     break;
 
-                globalEventQueue->Cycle( 1 );
+                if( simulateCycles != 0 )
+                    globalEventQueue->Cycle( StallCycles( request, simulateCycles - currentCycle ) );
+                else
+                    globalEventQueue->Cycle( StallCycles( request, 0 ) );
+
                 currentCycle = globalEventQueue->GetCurrentCycle( );
             }
 
@@ -296,9 +583,54 @@ int TraceMain::RunTrace( int argc, char *argv[] )
         }
     }       
 
+    if( statSampler != NULL )
+    {
+        globalEventQueue->SetStatSampler( NULL );
+        statSampler->Close( );
+
+        std::cout << "StatSampler wrote " << statSampler->GetSampleCount( ) 
+            << " samples of " << statSampler->GetStatCount( ) << " stats." << std::endl;
+
+        delete statSampler;
+    }
+
     GetChild( )->CalculateStats( );
+
+    for( std::map<ncounters_t, TraceCore *>::iterator it = cores.begin( ); 
+         it != cores.end( ); ++it )
+        it->second->CalculateStats( );
+
+    if( llc != NULL )
+        llc->CalculateStats( );
+
+    if( forkPending )
+        std::cout << "Warning: The simulation ended before ForkCycle. No children "
+            << "were forked." << std::endl;
+
+    if( checkpointCycle != 0 && checkpointInterval == 0 )
+        std::cout << "Warning: The simulation ended before CheckpointCycle. No "
+            << "checkpoint was written." << std::endl;
+
+    /* A forked child has its own stats file. */
+    if( !forkStatsFile.empty( ) )
+    {
+        if( statStream.is_open( ) )
+            statStream.close( );
+
+        statStream.open( forkStatsFile.c_str( ), std::ofstream::out | std::ofstream::app );
+    }
+
     std::ostream& refStream = (statStream.is_open()) ? statStream : std::cout;
-    stats->PrintAll( refStream );
+
+    /* 
+     *  Sampled runs print the mean of each stat over the windows instead. 
+     *  They are text, so they are kept out of other stats formats.
+     */
+    if( sampling )
+        stats->PrintSamples( stats->GetWriter( )->IsPlainText( ) ? refStream : std::cout, 
+                             samplingConfidence );
+    else
+        stats->PrintAll( refStream );
 
     std::cout << "Exiting at cycle " << currentCycle << " because simCycles " 
         << simulateCycles << " reached." << std::endl; 
@@ -306,23 +638,1160 @@ int TraceMain::RunTrace( int argc, char *argv[] )
         std::cout << "Note: " << outstandingRequests << " requests still in-flight."
                   << std::endl;
 
+    for( std::map<ncounters_t, TraceCore *>::iterator it = cores.begin( ); 
+         it != cores.end( ); ++it )
+        delete it->second;
+
+    cores.clear( );
+
+    delete trace;
     delete config;
     delete stats;
 
-    return 0;
+    return WaitForChildren( );
 }
 
-void TraceMain::Cycle( ncycle_t /*steps*/ )
+/*
+ *  Create the configured reader for traceFile. The trace is decoded ahead on
+ *  another thread if requested and positioned at TraceStartCycle, which is
+ *  returned in traceStartCycle (0 when the reader cannot seek).
+ */
+GenericTraceReader *TraceMain::OpenTrace( Config *config, std::string traceFile,
+                                          ncycle_t& traceStartCycle )
 {
+    GenericTraceReader *trace;
+
+    if( config->KeyExists( "TraceReader" ) )
+        trace = TraceReaderFactory::CreateNewTraceReader( 
+                config->GetString( "TraceReader" ) );
+    else
+        trace = TraceReaderFactory::CreateNewTraceReader( "NVMainTrace" );
+
+    trace->Init( config );
+    trace->SetTraceFile( traceFile );
+
+    /* Decode the trace on its own thread, ahead of the simulation. */
+    if( config->KeyExists( "TraceReadAhead" ) && config->GetBool( "TraceReadAhead" ) )
+    {
+        ncounter_t readAheadLines = 4096;
+
+        if( config->KeyExists( "TraceReadAheadLines" ) )
+            readAheadLines = config->GetValueUL( "TraceReadAheadLines" );
+
+        trace = new ReadAheadTraceReader( trace, readAheadLines );
+    }
+
+    /* 
+     *  Start part way into the trace. Cycles are counted from the start 
+     *  cycle, so the simulation does not idle until it is reached.
+     */
+    if( config->KeyExists( "TraceStartCycle" ) )
+    {
+        traceStartCycle = config->GetValueUL( "TraceStartCycle" );
+
+        if( !trace->SeekToCycle( traceStartCycle ) )
+        {
+            std::cout << "Warning: The trace reader cannot seek. Starting at "
+                << "the beginning of the trace." << std::endl;
+            traceStartCycle = 0;
+        }
+    }
 
+    return trace;
 }
 
-bool TraceMain::RequestComplete( NVMainRequest* request )
+/* One hierarchy of a sweep and the thread simulating it. */
+struct SweepJob
 {
-    /* This is the top-level module, so there are no more parents to fallback. */
-    assert( request->owner == this );
+    TraceMain *runner;
+    Config *config;
+    std::string traceFile;
+    std::string statsFile;
+    ncycle_t traceCycles;
+    GenericTraceReader *trace;
+    pthread_t thread;
+    int rv;
+};
 
-    outstandingRequests--;
+void *TraceMain::SweepThread( void *data )
+{
+    SweepJob *job = static_cast<SweepJob *>( data );
+
+    job->rv = job->runner->Simulate( job->config, job->traceFile, 
+                                     job->traceCycles, job->trace );
+
+    return NULL;
+}
+
+/*
+ *  Each non-empty line of SweepFile is a set of PARAM=value overrides
+ *  applied on top of the configuration. Every set gets its own hierarchy
+ *  and thread, and all of them are fed from one decoded copy of the trace.
+ *  The stats of set n go to its StatsFile, <SweepFile>.<n>.stats unless
+ *  the set names one.
+ */
+int TraceMain::RunSweep( Config *config, std::string traceFile, ncycle_t traceCycles )
+{
+    std::string sweepFile = config->GetString( "SweepFile" );
+    std::vector<std::vector<std::string> > overrideSets;
+    ncounter_t bufferLines = 65536;
+    ncycle_t traceStartCycle = 0;
+    int rv = 0;
+
+    /* The hierarchies are threads, which do not survive a fork. */
+    if( config->KeyExists( "ForkFile" ) )
+    {
+        std::cerr << "traceMain: SweepFile and ForkFile cannot be combined." << std::endl;
+        return 1;
+    }
+
+    /* Checkpoints hold one hierarchy. */
+    if( config->KeyExists( "CheckpointCycle" ) || config->KeyExists( "RestoreDirectory" ) )
+    {
+        std::cerr << "traceMain: SweepFile cannot be combined with checkpoints." << std::endl;
+        return 1;
+    }
+
+    if( !ReadOverrideSets( sweepFile, overrideSets ) )
+        return 1;
+
+    if( config->KeyExists( "SweepBufferLines" ) )
+        bufferLines = config->GetValueUL( "SweepBufferLines" );
+
+    /* Seek once on the shared trace; the hierarchies only shift cycles. */
+    GenericTraceReader *trace = OpenTrace( config, traceFile, traceStartCycle );
+    std::stringstream startCycle;
+
+    startCycle << traceStartCycle;
+    config->SetValue( "TraceStartCycle", startCycle.str( ) );
+
+    SharedTraceSource *source = new SharedTraceSource( trace, overrideSets.size( ), 
+                                                       bufferLines );
+    std::vector<SweepJob> jobs( overrideSets.size( ) );
+
+    for( size_t setIdx = 0; setIdx < overrideSets.size( ); setIdx++ )
+    {
+        Config *sweepConfig = new Config( *config );
+        std::stringstream statsFile;
+
+        statsFile << sweepFile << "." << setIdx << ".stats";
+        sweepConfig->SetValue( "StatsFile", statsFile.str( ) );
+
+        /* Each hierarchy writes its own time series. */
+        if( config->KeyExists( "StatSamplerInterval" ) )
+        {
+            std::stringstream sampleFile;
+
+            sampleFile << sweepFile << "." << setIdx << ".csv";
+            sweepConfig->SetValue( "StatSamplerFile", sampleFile.str( ) );
+        }
+
+        std::stringstream prefix;
+
+        prefix << "Sweep " << setIdx << ": ";
+        ApplyOverrides( sweepConfig, overrideSets[setIdx], prefix.str( ) );
+
+        jobs[setIdx].runner = new TraceMain( );
+        jobs[setIdx].config = sweepConfig;
+        jobs[setIdx].traceFile = traceFile;
+        jobs[setIdx].statsFile = sweepConfig->GetString( "StatsFile" );
+        jobs[setIdx].traceCycles = traceCycles;
+        jobs[setIdx].trace = source->CreateReader( setIdx );
+        jobs[setIdx].rv = 0;
+    }
+
+    for( size_t setIdx = 0; setIdx < jobs.size( ); setIdx++ )
+        pthread_create( &jobs[setIdx].thread, NULL, &TraceMain::SweepThread, &jobs[setIdx] );
+
+    for( size_t setIdx = 0; setIdx < jobs.size( ); setIdx++ )
+    {
+        pthread_join( jobs[setIdx].thread, NULL );
+
+        std::cout << "Sweep " << setIdx << " finished with return code "
+            << jobs[setIdx].rv << "; stats are in " 
+            << jobs[setIdx].statsFile << std::endl;
+
+        if( jobs[setIdx].rv != 0 )
+            rv = jobs[setIdx].rv;
+    }
+
+    delete source;
+    delete config;
+
+    return rv;
+}
+
+/*
+ *  Read a file of override sets, one set of PARAM=value pairs per line. A
+ *  ';' starts a comment and lines without overrides are skipped.
+ */
+bool TraceMain::ReadOverrideSets( std::string file, 
+                                  std::vector<std::vector<std::string> >& overrideSets )
+{
+    std::ifstream setStream( file.c_str( ) );
+    std::string setLine;
+
+    if( !setStream.good( ) )
+    {
+        std::cerr << "traceMain: Could not open override file " << file << std::endl;
+        return false;
+    }
+
+    while( std::getline( setStream, setLine ) )
+    {
+        std::istringstream lineStream( setLine.substr( 0, setLine.find( ';' ) ) );
+        std::vector<std::string> overrides;
+        std::string clPair;
+
+        while( lineStream >> clPair )
+            overrides.push_back( clPair );
+
+        if( !overrides.empty( ) )
+            overrideSets.push_back( overrides );
+    }
+
+    if( overrideSets.empty( ) )
+    {
+        std::cerr << "traceMain: No override sets in " << file << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/* Each override is printed after prefix, unless the prefix is empty. */
+void TraceMain::ApplyOverrides( Config *config, std::vector<std::string>& overrides,
+                                std::string prefix )
+{
+    for( size_t i = 0; i < overrides.size( ); i++ )
+    {
+        std::string clParam, clValue, clPair;
+
+        clPair = overrides[i];
+        clParam = clPair.substr( 0, clPair.find_first_of("="));
+        clValue = clPair.substr( clPair.find_first_of("=") + 1, std::string::npos );
+
+        if( !prefix.empty( ) )
+            std::cout << prefix << "Overriding " << clParam << " with '" << clValue 
+                << "'" << std::endl;
+
+        config->SetValue( clParam, clValue );
+    }
+}
+
+/*
+ *  Re-read the parameters of every module below object from overrides,
+ *  which only holds the overridden keys. Modules that read a key through
+ *  their Params while running pick up the new value; keys only used while
+ *  the hierarchy is built keep their old effect.
+ */
+void TraceMain::OverrideParams( NVMObject *object, Config *overrides )
+{
+    if( object->GetParams( ) != NULL )
+        object->GetParams( )->SetParams( overrides );
+
+    std::vector<NVMObject_hook *>& children = object->GetChildren( );
+
+    for( size_t i = 0; i < children.size( ); i++ )
+        OverrideParams( children[i]->GetTrampoline( ), overrides );
+}
+
+/*
+ *  Fork one child per set in ForkFile once the warmup is done. Each child
+ *  continues from the warm state with its overrides applied and writes its
+ *  stats to its StatsFile, <ForkFile>.<n>.stats unless the set names one.
+ *  The parent continues with the base configuration and waits for the
+ *  children before it exits.
+ */
+void TraceMain::ForkChildren( Config *config, GenericTraceReader *trace )
+{
+    std::string forkFile = config->GetString( "ForkFile" );
+
+    forkPending = false;
+
+    std::cout << "Forking " << forkSets.size( ) << " children at cycle " 
+        << GetGlobalEventQueue( )->GetCurrentCycle( ) << std::endl;
+
+    /* Anything still buffered would be printed by every child. */
+    std::cout.flush( );
+    std::cerr.flush( );
+
+    for( size_t setIdx = 0; setIdx < forkSets.size( ); setIdx++ )
+    {
+        int reopened[2];
+        char ready = 0;
+
+        /* The parent waits until the child has its own trace file offset. */
+        if( pipe( reopened ) != 0 )
+        {
+            std::cerr << "traceMain: Could not fork child " << setIdx << std::endl;
+            continue;
+        }
+
+        pid_t pid = fork( );
+
+        if( pid < 0 )
+        {
+            std::cerr << "traceMain: Could not fork child " << setIdx << std::endl;
+            close( reopened[0] );
+            close( reopened[1] );
+            continue;
+        }
+        
+        if( pid == 0 )
+        {
+            trace->Reopen( );
+
+            close( reopened[0] );
+            if( write( reopened[1], &ready, 1 ) != 1 )
+                std::cerr << "traceMain: Could not signal the parent." << std::endl;
+            close( reopened[1] );
+
+            Config *overrides = new Config( );
+            std::stringstream prefix, statsFile;
+
+            prefix << "Fork " << setIdx << ": ";
+            statsFile << forkFile << "." << setIdx << ".stats";
+
+            config->SetValue( "StatsFile", statsFile.str( ) );
+            ApplyOverrides( config, forkSets[setIdx], prefix.str( ) );
+            forkStatsFile = config->GetString( "StatsFile" );
+
+            overrides->SetWarnings( false );
+            ApplyOverrides( overrides, forkSets[setIdx], "" );
+            OverrideParams( GetChild( )->GetTrampoline( ), overrides );
+
+            forkSets.clear( );
+            forkChildren.clear( );
+            delete overrides;
+
+            return;
+        }
+
+        close( reopened[1] );
+        if( read( reopened[0], &ready, 1 ) != 1 )
+            std::cerr << "traceMain: Child " << setIdx << " did not start." << std::endl;
+        close( reopened[0] );
+
+        forkChildren.push_back( pid );
+    }
+}
+
+/* Called by the parent once it is done; returns the first failure, if any. */
+int TraceMain::WaitForChildren( )
+{
+    int rv = 0;
+
+    for( size_t childIdx = 0; childIdx < forkChildren.size( ); childIdx++ )
+    {
+        int status = 0;
+
+        waitpid( forkChildren[childIdx], &status, 0 );
+
+        int childRv = WIFEXITED( status ) ? WEXITSTATUS( status ) : 1;
+
+        std::cout << "Fork child " << forkChildren[childIdx] << " finished with return code "
+            << childRv << std::endl;
+
+        if( childRv != 0 && rv == 0 )
+            rv = childRv;
+    }
+
+    forkChildren.clear( );
+
+    return rv;
+}
+
+void TraceMain::FillRequest( NVMainRequest *request, TraceLine *tl, bool ignoreData )
+{
+    request->address = tl->GetAddress( );
+    request->type = tl->GetOperation( );
+    request->bulkCmd = CMD_NOP;
+    request->threadId = tl->GetThreadId( );
+    if( !ignoreData ) request->data = tl->GetData( );
+    if( !ignoreData ) request->oldData = tl->GetOldData( );
+    request->status = MEM_REQUEST_INCOMPLETE;
+    request->owner = (NVMObject *)this;
+}
+
+void TraceMain::IssueAtomicLine( TraceLine *tl, bool ignoreData )
+{
+    NVMainRequest request;
+
+    FillRequest( &request, tl, ignoreData );
+    GetChild( )->IssueAtomic( &request );
+
+    traceLines++;
+}
+
+/*
+ *  Issue a trace line with timing once its cycle is reached and the memory
+ *  system accepts it.
+ */
+void TraceMain::IssueTimedLine( TraceLine *tl, bool ignoreData )
+{
+    GlobalEventQueue *globalEventQueue = GetGlobalEventQueue( );
+    NVMainRequest *request = new NVMainRequest( );
+    ncycle_t issueCycle = (tl->GetCycle( ) > timingStartCycle) 
+                        ? tl->GetCycle( ) - timingStartCycle : 0;
+
+    FillRequest( request, tl, ignoreData );
+
+    if( issueCycle > globalEventQueue->GetCurrentCycle( ) )
+        globalEventQueue->Cycle( issueCycle - globalEventQueue->GetCurrentCycle( ) );
+
+    while( !GetChild( )->IsIssuable( request ) )
+        globalEventQueue->Cycle( StallCycles( request, 0 ) );
+
+    outstandingRequests++;
+    GetChild( )->IssueCommand( request );
+
+    traceLines++;
+}
+
+/*
+ *  SMARTS-style sampling. The trace is split into units of SamplingInterval
+ *  lines. Each unit is fast-forwarded with atomic requests up to its last
+ *  SamplingWarmup + SamplingWindow lines, which are simulated with timing.
+ *  The stats are reset after the SamplingWarmup lines, so each window of 
+ *  SamplingWindow lines is one sample of every stat. Sampling stops early 
+ *  once the confidence interval of each SamplingStats stat is within 
+ *  SamplingError of its mean for at least SamplingMinWindows samples.
+ */
+ncycle_t TraceMain::RunSampling( GenericTraceReader *trace, TraceLine *tl, Config *config,
+                                 ncycle_t simulateCycles, double confidence,
+                                 bool ignoreData, std::ostream& statOut )
+{
+    GlobalEventQueue *globalEventQueue = GetGlobalEventQueue( );
+    ncounter_t unitLines = config->GetValueUL( "SamplingInterval" );
+    ncounter_t windowLines = 1000;
+    ncounter_t warmupLines = 2000;
+    ncounter_t minWindows = 30;
+    double errorBound = 0.03;
+    bool printWindows = false;
+    std::string statList = "averageLatency";
+    std::vector<std::string> targetStats;
+    bool traceEnded = false;
+
+    config->GetValueUL( "SamplingWindow", windowLines );
+    config->GetValueUL( "SamplingWarmup", warmupLines );
+    config->GetValueUL( "SamplingMinWindows", minWindows );
+    config->GetEnergy( "SamplingError", errorBound );
+    config->GetBool( "SamplingPrintWindows", printWindows );
+
+    if( config->KeyExists( "SamplingStats" ) )
+        statList = config->GetString( "SamplingStats" );
+
+    std::stringstream statStream( statList );
+    std::string statName;
+
+    while( std::getline( statStream, statName, ',' ) )
+    {
+        if( statName.find_first_not_of( " " ) != std::string::npos )
+            targetStats.push_back( statName );
+    }
+
+    if( windowLines == 0 )
+        windowLines = 1;
+
+    if( unitLines < warmupLines + windowLines )
+    {
+        std::cout << "Warning: SamplingInterval is shorter than SamplingWarmup plus "
+            << "SamplingWindow. Every line is simulated with timing." << std::endl;
+        unitLines = warmupLines + windowLines;
+    }
+
+    while( !traceEnded )
+    {
+        ncycle_t currentCycle = globalEventQueue->GetCurrentCycle( );
+        ncounter_t line;
+
+        if( simulateCycles != 0 && currentCycle >= simulateCycles )
+            break;
+
+        /* Fast-forward, then continue the timed lines from the current cycle. */
+        for( line = 0; line < unitLines - warmupLines - windowLines; line++ )
+        {
+            if( !trace->GetNextAccess( tl ) )
+            {
+                traceEnded = true;
+                break;
+            }
+
+            IssueAtomicLine( tl, ignoreData );
+        }
+
+        if( line > 0 && tl->GetCycle( ) > timingStartCycle + currentCycle )
+            timingStartCycle = tl->GetCycle( ) - currentCycle;
+
+        for( line = 0; line < warmupLines && !traceEnded; line++ )
+        {
+            if( !trace->GetNextAccess( tl ) )
+                traceEnded = true;
+            else
+                IssueTimedLine( tl, ignoreData );
+        }
+
+        GetStats( )->ResetAll( );
+
+        for( line = 0; line < windowLines && !traceEnded; line++ )
+        {
+            if( !trace->GetNextAccess( tl ) )
+                traceEnded = true;
+            else
+                IssueTimedLine( tl, ignoreData );
+        }
+
+        /* Let the requests of the window complete before it is measured. */
+        bool draining = Drain( );
+
+        while( outstandingRequests > 0 )
+        {
+            globalEventQueue->Cycle( StallCycles( NULL, 0 ) );
+
+            if( !draining )
+                draining = Drain( );
+        }
+
+        /* A window cut short by the end of the trace is not a sample. */
+        if( line < windowLines )
+            break;
+
+        GetChild( )->CalculateStats( );
+        GetStats( )->AddSample( );
+
+        if( printWindows )
+            GetStats( )->PrintAll( statOut );
+
+        if( errorBound > 0.0 && GetStats( )->GetSampleCount( ) >= minWindows )
+        {
+            double maxError = 0.0;
+
+            for( size_t statIdx = 0; statIdx < targetStats.size( ); statIdx++ )
+            {
+                double error = GetStats( )->GetSampleError( targetStats[statIdx], confidence );
+
+                if( error > maxError )
+                    maxError = error;
+            }
+
+            if( maxError <= errorBound )
+            {
+                std::cout << "Sampling stopped after " << GetStats( )->GetSampleCount( )
+                    << " windows with a relative error of " << maxError << "." << std::endl;
+                break;
+            }
+        }
+    }
+
+    return globalEventQueue->GetCurrentCycle( );
+}
+
+/*
+ *  Pass the next warmupRequests trace lines through IssueAtomic, which
+ *  updates DRAM cache tags, migration tables, prefetch buffers and cell
+ *  wear without simulating time. Timing starts from the cycle of the last
+ *  warmup line and the stats gathered so far are reset.
+ */
+void TraceMain::FunctionalWarmup( GenericTraceReader *trace, TraceLine *tl, 
+                                  ncounter_t warmupRequests, bool ignoreData )
+{
+    ncounter_t warmedRequests = 0;
+
+    while( warmedRequests < warmupRequests && trace->GetNextAccess( tl ) )
+    {
+        IssueAtomicLine( tl, ignoreData );
+
+        if( tl->GetCycle( ) > timingStartCycle )
+            timingStartCycle = tl->GetCycle( );
+
+        warmedRequests++;
+    }
+
+    GetStats( )->ResetAll( );
+
+    std::cout << "Functional warmup issued " << warmedRequests << " requests. "
+        << "Timing starts at trace cycle " << timingStartCycle << "." << std::endl;
+}
+
+/* Memory cycles Quiesce waits for the memory system to drain. */
+static const ncycle_t quiesceLimit = 1000000;
+
+/*
+ *  Stop issuing and wait until every request has completed and the only
+ *  events left are ones the objects save in their checkpoints. Returns
+ *  false if the memory system did not drain within quiesceLimit cycles.
+ */
+bool TraceMain::Quiesce( )
+{
+    GlobalEventQueue *globalEventQueue = GetGlobalEventQueue( );
+    ncycle_t quiesceStart = globalEventQueue->GetCurrentCycle( );
+    bool draining = Drain( );
+
+    while( outstandingRequests > 0 || !globalEventQueue->CanCheckpoint( ) )
+    {
+        if( globalEventQueue->GetCurrentCycle( ) - quiesceStart > quiesceLimit )
+            return false;
+
+        globalEventQueue->Cycle( StallCycles( NULL, 0 ) );
+
+        if( !draining )
+            draining = Drain( );
+    }
+
+    return true;
+}
+
+/*
+ *  The hooks added here are shared by every object below, so they are
+ *  checkpointed once along with the hierarchy.
+ */
+void TraceMain::CreateCheckpoint( std::string dir )
+{
+    std::set<NVMObject *> hookSet;
+
+    NVMObject::CreateCheckpoint( dir );
+
+    for( int h = 0; h < static_cast<int>(NVMHOOK_COUNT); h++ )
+    {
+        std::vector<NVMObject *>& hookList = GetHooks( static_cast<HookType>(h) );
+
+        for( size_t i = 0; i < hookList.size( ); i++ )
+        {
+            if( hookSet.insert( hookList[i] ).second )
+                hookList[i]->CreateCheckpoint( dir );
+        }
+    }
+}
+
+void TraceMain::RestoreCheckpoint( std::string dir )
+{
+    std::set<NVMObject *> hookSet;
+
+    NVMObject::RestoreCheckpoint( dir );
+
+    for( int h = 0; h < static_cast<int>(NVMHOOK_COUNT); h++ )
+    {
+        std::vector<NVMObject *>& hookList = GetHooks( static_cast<HookType>(h) );
+
+        for( size_t i = 0; i < hookList.size( ); i++ )
+        {
+            if( hookSet.insert( hookList[i] ).second )
+                hookList[i]->RestoreCheckpoint( dir );
+        }
+    }
+}
+
+/*
+ *  Write the state of the hierarchy, the stats and the trace position to
+ *  checkpointDirectory. The trace file is written last so that only a
+ *  complete checkpoint can be restored.
+ */
+void TraceMain::TakeCheckpoint( std::string traceFile, ncycle_t traceStartCycle )
+{
+    std::string traceCheckpoint = Checkpoint::File( checkpointDirectory, "trace" );
+
+    checkpointCycle = (checkpointInterval != 0) ? checkpointCycle + checkpointInterval : 0;
+
+    if( !Quiesce( ) )
+    {
+        std::cout << "Warning: The memory system did not drain within " << quiesceLimit
+            << " cycles. No checkpoint was written." << std::endl;
+        return;
+    }
+
+    mkdir( checkpointDirectory.c_str( ), 0777 );
+    std::remove( traceCheckpoint.c_str( ) );
+
+    CreateCheckpoint( checkpointDirectory );
+    GetStats( )->CreateCheckpoint( checkpointDirectory );
+
+    Checkpoint cpt;
+
+    if( cpt.Create( traceCheckpoint ) )
+    {
+        cpt.Write( GetGlobalEventQueue( )->GetCurrentCycle( ) );
+        cpt.Write( traceLines );
+        cpt.Write( traceStartCycle );
+        cpt.Write( timingStartCycle );
+        cpt.WriteString( traceFile );
+
+        if( cpt.Close( ) )
+            std::cout << "Wrote checkpoint " << checkpointDirectory << " at cycle " 
+                << GetGlobalEventQueue( )->GetCurrentCycle( ) << std::endl;
+    }
+}
+
+/*
+ *  Continue the checkpoint in dir. The hierarchy is built from the same
+ *  configuration, the trace lines consumed before the checkpoint are read 
+ *  again, e.g., to warm up an LLCFilter, then the saved state replaces the
+ *  state that was built.
+ */
+bool TraceMain::RestoreSimulation( std::string dir, std::string traceFile,
+                                   ncycle_t traceStartCycle, GenericTraceReader *trace,
+                                   TraceLine *tl )
+{
+    Checkpoint cpt;
+    ncycle_t savedCycle = 0, savedStartCycle = 0;
+    ncounter_t savedLines = 0;
+    std::string savedTraceFile;
+
+    if( !cpt.Open( Checkpoint::File( dir, "trace" ) ) )
+    {
+        std::cerr << "traceMain: No complete checkpoint in " << dir << std::endl;
+        return false;
+    }
+
+    cpt.Read( savedCycle );
+    cpt.Read( savedLines );
+    cpt.Read( savedStartCycle );
+    cpt.Read( timingStartCycle );
+    cpt.ReadString( savedTraceFile );
+
+    if( !cpt.Close( ) )
+        return false;
+
+    if( savedTraceFile != traceFile || savedStartCycle != traceStartCycle )
+    {
+        std::cout << "Warning: Checkpoint " << dir << " was taken on " << savedTraceFile
+            << " from cycle " << savedStartCycle << ", not on " << traceFile 
+            << " from cycle " << traceStartCycle << "." << std::endl;
+    }
+
+    for( traceLines = 0; traceLines < savedLines; traceLines++ )
+    {
+        if( !trace->GetNextAccess( tl ) )
+        {
+            std::cerr << "traceMain: The trace ends before the " << savedLines
+                << " lines read by checkpoint " << dir << std::endl;
+            return false;
+        }
+    }
+
+    RestoreCheckpoint( dir );
+    GetGlobalEventQueue( )->SetCurrentCycle( savedCycle );
+    GetStats( )->RestoreCheckpoint( dir );
+
+    std::cout << "Restored checkpoint " << dir << " at cycle " << savedCycle << std::endl;
+
+    return true;
+}
+
+/*
+ *  Closed-loop replay: each thread of the trace runs on a TraceCore, which
+ *  decides when its next request may issue from its ROB and MSHR limits,
+ *  so memory latency slows the thread down instead of only stalling the
+ *  trace. Requests are issued one at a time, earliest ready core first.
+ */
+ncycle_t TraceMain::RunCoreModel( GenericTraceReader *trace, Config *config,
+                                  ncycle_t simulateCycles, ncycle_t traceStartCycle,
+                                  bool ignoreData )
+{
+    GlobalEventQueue *globalEventQueue = GetGlobalEventQueue( );
+    ncounter_t lookahead = 4096;
+    bool traceEnded = false;
+    ncycle_t lastReadCycle = 0;
+
+    if( config->KeyExists( "CoreLookahead" ) )
+        lookahead = config->GetValueUL( "CoreLookahead" );
+
+    for( ;; )
+    {
+        ncycle_t currentCycle = globalEventQueue->GetCurrentCycle( );
+
+        if( simulateCycles != 0 && currentCycle >= simulateCycles )
+            return currentCycle;
+
+        if( forkPending && currentCycle >= forkCycle )
+            ForkChildren( config, trace );
+
+        /* 
+         *  Keep the next line of every core queued, and read past the 
+         *  current cycle so threads that start later are found in time. 
+         *  No core queues more than CoreLookahead lines.
+         */
+        while( !traceEnded )
+        {
+            bool needLines = (lastReadCycle <= currentCycle);
+            bool full = false;
+
+            for( std::map<ncounters_t, TraceCore *>::iterator it = cores.begin( ); 
+                 it != cores.end( ); ++it )
+            {
+                if( it->second->QueuedLines( ) == 0 )
+                    needLines = true;
+                else if( it->second->QueuedLines( ) >= lookahead )
+                    full = true;
+            }
+
+            if( !needLines || full )
+                break;
+
+            TraceLine *line = new TraceLine( );
+
+            if( !trace->GetNextAccess( line ) )
+            {
+                delete line;
+                traceEnded = true;
+                break;
+            }
+
+            if( config->KeyExists( "IgnoreTraceCycle" ) 
+                    && config->GetString( "IgnoreTraceCycle" ) == "true" )
+                line->SetLine( line->GetAddress( ), line->GetOperation( ), 0, 
+                               line->GetData( ), line->GetOldData( ), line->GetThreadId( ) );
+            else if( traceStartCycle != 0 )
+                line->SetLine( line->GetAddress( ), line->GetOperation( ), 
+                               (line->GetCycle( ) > traceStartCycle) 
+                               ? line->GetCycle( ) - traceStartCycle : 0, 
+                               line->GetData( ), line->GetOldData( ), line->GetThreadId( ) );
+
+            lastReadCycle = line->GetCycle( );
+
+            if( cores.count( line->GetThreadId( ) ) == 0 )
+            {
+                TraceCore *core = new TraceCore( line->GetThreadId( ), config );
+
+                core->SetStats( GetStats( ) );
+                core->RegisterStats( );
+                cores[line->GetThreadId( )] = core;
+            }
+
+            cores[line->GetThreadId( )]->AddLine( line );
+        }
+
+        TraceCore *nextCore = NULL;
+        ncycle_t nextReady = std::numeric_limits<ncycle_t>::max( );
+        bool done = traceEnded;
+
+        for( std::map<ncounters_t, TraceCore *>::iterator it = cores.begin( ); 
+             it != cores.end( ); ++it )
+        {
+            ncycle_t ready = it->second->ReadyCycle( );
+
+            if( ready < nextReady )
+            {
+                nextCore = it->second;
+                nextReady = ready;
+            }
+
+            if( !it->second->Done( ) )
+                done = false;
+        }
+
+        if( done )
+            break;
+
+        /* Sleep until a core can issue or a completion unblocks one. */
+        if( nextCore == NULL || nextReady > currentCycle )
+        {
+            ncycle_t limit = (nextCore == NULL) ? 0 : nextReady - currentCycle;
+
+            if( simulateCycles != 0 && (limit == 0 || currentCycle + limit > simulateCycles) )
+                limit = simulateCycles - currentCycle;
+
+            globalEventQueue->Cycle( StallCycles( NULL, limit ) );
+            continue;
+        }
+
+        TraceLine *line = nextCore->GetLine( );
+        NVMainRequest *request = new NVMainRequest( );
+
+        request->address = line->GetAddress( );
+        request->type = line->GetOperation( );
+        request->bulkCmd = CMD_NOP;
+        request->threadId = line->GetThreadId( );
+        if( !ignoreData ) request->data = line->GetData( );
+        if( !ignoreData ) request->oldData = line->GetOldData( );
+        request->status = MEM_REQUEST_INCOMPLETE;
+        request->owner = (NVMObject *)this;
+
+        if( !GetChild( )->IsIssuable( request ) )
+        {
+            ncycle_t limit = (simulateCycles != 0) ? simulateCycles - currentCycle : 0;
+
+            globalEventQueue->Cycle( StallCycles( request, limit ) );
+            delete request;
+            continue;
+        }
+
+        nextCore->Issue( request, currentCycle );
+
+        outstandingRequests++;
+        GetChild( )->IssueCommand( request );
+    }
+
+    /* Force all modules to drain requests. */
+    bool draining = Drain( );
+
+    std::cout << "Could not read next line from trace file!" << std::endl;
+
+    while( outstandingRequests > 0 )
+    {
+        globalEventQueue->Cycle( StallCycles( NULL, 0 ) );
+
+        /* Retry drain each cycle if it failed. */
+        if( !draining )
+            draining = Drain( );
+    }
+
+    return globalEventQueue->GetCurrentCycle( );
+}
+
+/*
+ *  Copy every line of the trace to TraceConvertFile using the writer named
+ *  by TraceConvertWriter (NVMainCompressedTrace by default), for example to
+ *  compress a text trace.
+ */
+int TraceMain::ConvertTrace( GenericTraceReader *trace, Config *config )
+{
+    std::string writerName = "NVMainCompressedTrace";
+    std::string outputFile = config->GetString( "TraceConvertFile" );
+    TraceLine traceLine;
+    ncounter_t convertedLines = 0;
+
+    if( config->KeyExists( "TraceConvertWriter" ) )
+        writerName = config->GetString( "TraceConvertWriter" );
+
+    GenericTraceWriter *writer = TraceWriterFactory::CreateNewTraceWriter( writerName );
+
+    if( writer == NULL )
+        return 1;
+
+    writer->SetTraceFile( outputFile );
+    writer->Init( config );
+
+    while( trace->GetNextAccess( &traceLine ) )
+    {
+        if( !writer->SetNextAccess( &traceLine ) )
+        {
+            std::cout << "Could not write to " << outputFile << "!" << std::endl;
+            delete writer;
+            return 1;
+        }
+
+        convertedLines++;
+    }
+
+    delete writer;
+
+    std::cout << "Converted " << convertedLines << " trace lines to " 
+        << outputFile << " using " << writerName << "." << std::endl;
+
+    return 0;
+}
+
+/*
+ *  Drive the memory system with open-loop synthetic traffic (configured by
+ *  the Synthetic* keys, see SyntheticTraceReader) once per interval in
+ *  LoadedLatencyIntervals, from the lightest load to the heaviest, and
+ *  print the achieved bandwidth and the mean and 99th percentile latency
+ *  of each point. Latency is counted from the cycle a request should have
+ *  been injected, so time stalled in the front end because the controller
+ *  was full is included; the rest comes from the request's arrival and
+ *  completion cycles at the memory controller.
+ */
+void TraceMain::RunLoadedLatency( Config *config, std::ostream& out )
+{
+    GlobalEventQueue *globalEventQueue = GetGlobalEventQueue( );
+    std::string intervalList = "1000,500,200,100,50,20,10,5,2,1";
+    std::vector<ncycle_t> intervals;
+    ncounter_t pointRequests = 10000;
+    ncounter_t warmupRequests;
+    ncounter_t threads = 1;
+    ncounter_t lineSize = 64;
+    TraceLine traceLine;
+
+    if( config->KeyExists( "LoadedLatencyIntervals" ) )
+        intervalList = config->GetString( "LoadedLatencyIntervals" );
+    if( config->KeyExists( "LoadedLatencyRequests" ) )
+        pointRequests = config->GetValueUL( "LoadedLatencyRequests" );
+    if( config->KeyExists( "SyntheticThreads" ) && config->GetValueUL( "SyntheticThreads" ) > 0 )
+        threads = config->GetValueUL( "SyntheticThreads" );
+    if( config->KeyExists( "SyntheticLineSize" ) && config->GetValueUL( "SyntheticLineSize" ) > 0 )
+        lineSize = config->GetValueUL( "SyntheticLineSize" );
+
+    /* The first requests of each point only bring the queues to steady state. */
+    warmupRequests = pointRequests / 10;
+    if( config->KeyExists( "LoadedLatencyWarmup" ) )
+        warmupRequests = config->GetValueUL( "LoadedLatencyWarmup" );
+
+    std::stringstream intervalStream( intervalList );
+    std::string intervalValue;
+
+    while( std::getline( intervalStream, intervalValue, ',' ) )
+    {
+        if( intervalValue.find_first_not_of( " " ) != std::string::npos )
+            intervals.push_back( strtoull( intervalValue.c_str( ), NULL, 10 ) );
+    }
+
+    /* Increasing injection rate. */
+    std::sort( intervals.begin( ), intervals.end( ), std::greater<ncycle_t>( ) );
+
+    /* Both in ns per cycle. */
+    cpuPeriod = 1000.0 / config->GetEnergy( "CPUFreq" );
+    memoryPeriod = 1000.0 / config->GetEnergy( "CLK" );
+
+    out << "LoadedLatency interval offered_GBps bandwidth_GBps mean_ns p99_ns requests" 
+        << std::endl;
+
+    for( std::vector<ncycle_t>::iterator it = intervals.begin( ); it != intervals.end( ); ++it )
+    {
+        ncycle_t startCycle = globalEventQueue->GetCurrentCycle( );
+        ncounter_t injected = 0;
+        std::stringstream value;
+
+        value.str( "" ); value << *it;
+        config->SetValue( "SyntheticInterval", value.str( ) );
+        value.str( "" ); value << (pointRequests + threads - 1) / threads;
+        config->SetValue( "SyntheticRequests", value.str( ) );
+        value.str( "" ); value << startCycle;
+        config->SetValue( "SyntheticStartCycle", value.str( ) );
+
+        GenericTraceReader *trace = TraceReaderFactory::CreateNewTraceReader( "SyntheticTrace" );
+
+        trace->Init( config );
+        trace->SetTraceFile( "LoadedLatency" );
+
+        latencies.clear( );
+
+        while( trace->GetNextAccess( &traceLine ) )
+        {
+            NVMainRequest *request = new NVMainRequest( );
+
+            request->address = traceLine.GetAddress( );
+            request->type = traceLine.GetOperation( );
+            request->bulkCmd = CMD_NOP;
+            request->threadId = traceLine.GetThreadId( );
+            request->status = MEM_REQUEST_INCOMPLETE;
+            request->owner = (NVMObject *)this;
+
+            if( traceLine.GetCycle( ) > globalEventQueue->GetCurrentCycle( ) )
+                globalEventQueue->Cycle( traceLine.GetCycle( ) 
+                                         - globalEventQueue->GetCurrentCycle( ) );
+
+            while( !GetChild( )->IsIssuable( request ) )
+                globalEventQueue->Cycle( StallCycles( request, 0 ) );
+
+            if( injected >= warmupRequests )
+                frontEndCycles[request] = globalEventQueue->GetCurrentCycle( ) 
+                                        - traceLine.GetCycle( );
+
+            injected++;
+            outstandingRequests++;
+            GetChild( )->IssueCommand( request );
+        }
+
+        delete trace;
+
+        /* Let every request of this point complete before the next one. */
+        bool draining = Drain( );
+
+        while( outstandingRequests > 0 )
+        {
+            globalEventQueue->Cycle( StallCycles( NULL, 0 ) );
+
+            if( !draining )
+                draining = Drain( );
+        }
+
+        frontEndCycles.clear( );
+
+        double elapsed = static_cast<double>( globalEventQueue->GetCurrentCycle( ) - startCycle ) 
+                       * cpuPeriod;
+        double offered = static_cast<double>( threads * lineSize ) 
+                       / (static_cast<double>( *it ) * cpuPeriod);
+        double bandwidth = (elapsed > 0.0) ? static_cast<double>( injected * lineSize ) / elapsed 
+                                           : 0.0;
+        double meanLatency = 0.0;
+        double tailLatency = 0.0;
+
+        if( !latencies.empty( ) )
+        {
+            std::sort( latencies.begin( ), latencies.end( ) );
+
+            for( std::vector<double>::iterator lit = latencies.begin( ); 
+                 lit != latencies.end( ); ++lit )
+                meanLatency += *lit;
+
+            meanLatency /= static_cast<double>( latencies.size( ) );
+            tailLatency = latencies[static_cast<size_t>( 
+                          std::ceil( 0.99 * static_cast<double>( latencies.size( ) ) ) ) - 1];
+        }
+
+        /* Bytes per ns is GB/s. */
+        out << "LoadedLatency " << *it << " " << offered << " " << bandwidth << " " 
+            << meanLatency << " " << tailLatency << " " << latencies.size( ) << std::endl;
+    }
+}
+
+void TraceMain::Cycle( ncycle_t /*steps*/ )
+{
+
+}
+
+/*
+ *  Number of cycles the front end may sleep while it is stalled. Whether
+ *  a request is accepted, or a drain succeeds, only changes when an event
+ *  fires in the memory system, so skip ahead to the next global event or
+ *  to the cycle the memory system says the request (any request, if NULL)
+ *  may be accepted. At least one cycle is taken, and no more than limit
+ *  cycles unless limit is 0.
+ */
+ncycle_t TraceMain::StallCycles( NVMainRequest *request, ncycle_t limit )
+{
+    GlobalEventQueue *globalEventQueue = GetGlobalEventQueue( );
+    EventQueue *memoryEventQueue = GetChild( )->GetTrampoline( )->GetEventQueue( );
+    ncycle_t currentCycle = globalEventQueue->GetCurrentCycle( );
+    ncycle_t wakeup, steps;
+
+    wakeup = std::min( globalEventQueue->GetNextEvent( ), 
+                       globalEventQueue->GetWakeupCycle( memoryEventQueue, 
+                           GetChild( )->NextIssuable( request ) ) );
+
+    /* Nothing is pending; keep stepping so the stall can still time out. */
+    if( wakeup == std::numeric_limits<ncycle_t>::max( ) )
+        steps = (limit != 0) ? limit : 1;
+    else if( wakeup <= currentCycle )
+        steps = 1;
+    else
+        steps = wakeup - currentCycle;
+
+    if( limit != 0 && steps > limit )
+        steps = limit;
+
+    return steps;
+}
+
+bool TraceMain::RequestComplete( NVMainRequest* request )
+{
+    /* This is the top-level module, so there are no more parents to fallback. */
+    assert( request->owner == this );
+
+    outstandingRequests--;
+
+    /* Completion time in the global clock, which may lag inside Cycle( ). */
+    if( !cores.empty( ) && cores.count( request->threadId ) != 0 )
+    {
+        EventQueue *memoryEventQueue = GetChild( )->GetTrampoline( )->GetEventQueue( );
+
+        cores[request->threadId]->Complete( request, 
+            GetGlobalEventQueue( )->GetWakeupCycle( memoryEventQueue, 
+                                                    memoryEventQueue->GetCurrentCycle( ) ) );
+    }
+
+    std::map<NVMainRequest *, ncycle_t>::iterator it = frontEndCycles.find( request );
+
+    if( it != frontEndCycles.end( ) )
+    {
+        if( request->completionCycle >= request->arrivalCycle )
+            latencies.push_back( static_cast<double>( it->second ) * cpuPeriod
+                + static_cast<double>( request->completionCycle - request->arrivalCycle ) 
+                * memoryPeriod );
+
+        frontEndCycles.erase( it );
+    }
 
     delete request;
 
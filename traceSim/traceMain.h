@@ -38,10 +38,18 @@
 
 
 #include "src/NVMObject.h"
+#include "traceReader/GenericTraceReader.h"
+
+#include <map>
+#include <vector>
+#include <ostream>
+#include <string>
+#include <sys/types.h>
 
 
 namespace NVM {
 
+class TraceCore;
 
 class TraceMain : public NVMObject
 {
@@ -55,8 +63,71 @@ class TraceMain : public NVMObject
 
     bool RequestComplete( NVMainRequest *request );
 
+    void CreateCheckpoint( std::string dir );
+    void RestoreCheckpoint( std::string dir );
+
   private:
     ncounter_t outstandingRequests;
+
+    /* Loaded-latency mode: front end delay of each measured request. */
+    std::map<NVMainRequest *, ncycle_t> frontEndCycles;
+    std::vector<double> latencies;
+    double cpuPeriod;
+    double memoryPeriod;
+
+    /* Core model: one core per trace thread. */
+    std::map<ncounters_t, TraceCore *> cores;
+
+    /* Forked sweep: override sets, and the children of the parent. */
+    std::vector<std::vector<std::string> > forkSets;
+    std::vector<pid_t> forkChildren;
+    std::string forkStatsFile;
+    ncycle_t forkCycle;
+    bool forkPending;
+
+    /* Checkpoints: the next one is due at checkpointCycle, 0 if none is. */
+    std::string checkpointDirectory;
+    ncycle_t checkpointCycle;
+    ncycle_t checkpointInterval;
+    ncounter_t traceLines;
+
+    /* Trace cycle simulated as cycle 0, moved past a functional warmup. */
+    ncycle_t timingStartCycle;
+
+    int Simulate( Config *config, std::string traceFile, ncycle_t traceCycles,
+                  GenericTraceReader *sharedTrace );
+    GenericTraceReader *OpenTrace( Config *config, std::string traceFile,
+                                   ncycle_t& traceStartCycle );
+    int RunSweep( Config *config, std::string traceFile, ncycle_t traceCycles );
+    static void *SweepThread( void *data );
+    bool ReadOverrideSets( std::string file, 
+                           std::vector<std::vector<std::string> >& overrideSets );
+    void ApplyOverrides( Config *config, std::vector<std::string>& overrides,
+                         std::string prefix );
+    void OverrideParams( NVMObject *object, Config *overrides );
+    void ForkChildren( Config *config, GenericTraceReader *trace );
+    int WaitForChildren( );
+    bool Quiesce( );
+    void TakeCheckpoint( std::string traceFile, ncycle_t traceStartCycle );
+    bool RestoreSimulation( std::string dir, std::string traceFile, 
+                            ncycle_t traceStartCycle, GenericTraceReader *trace, 
+                            TraceLine *tl );
+
+    void FunctionalWarmup( GenericTraceReader *trace, TraceLine *tl, 
+                           ncounter_t warmupRequests, bool ignoreData );
+    void FillRequest( NVMainRequest *request, TraceLine *tl, bool ignoreData );
+    void IssueAtomicLine( TraceLine *tl, bool ignoreData );
+    void IssueTimedLine( TraceLine *tl, bool ignoreData );
+    ncycle_t RunSampling( GenericTraceReader *trace, TraceLine *tl, Config *config,
+                          ncycle_t simulateCycles, double confidence,
+                          bool ignoreData, std::ostream& statOut );
+
+    ncycle_t StallCycles( NVMainRequest *request, ncycle_t limit );
+    int ConvertTrace( GenericTraceReader *trace, Config *config );
+    void RunLoadedLatency( Config *config, std::ostream& out );
+    ncycle_t RunCoreModel( GenericTraceReader *trace, Config *config,
+                           ncycle_t simulateCycles, ncycle_t traceStartCycle,
+                           bool ignoreData );
 };
 
 
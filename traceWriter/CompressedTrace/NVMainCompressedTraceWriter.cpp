@@ -0,0 +1,303 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceWriter/CompressedTrace/NVMainCompressedTraceWriter.h"
+#include <cstring>
+#include <cstdlib>
+
+using namespace NVM;
+
+NVMainCompressedTraceWriter::NVMainCompressedTraceWriter( )
+{
+    codec = TRACE_CODEC_LZ;
+    blockRecords = 4096;
+
+    memset( &header, 0, sizeof(header) );
+    wroteHeader = false;
+
+    bufferedRecords = 0;
+    blockFirstCycle = 0;
+}
+
+NVMainCompressedTraceWriter::~NVMainCompressedTraceWriter( )
+{
+    Finish( );
+}
+
+std::set<NVMainCompressedTraceWriter *>& NVMainCompressedTraceWriter::OpenWriters( )
+{
+    static std::set<NVMainCompressedTraceWriter *> openWriters;
+
+    return openWriters;
+}
+
+void NVMainCompressedTraceWriter::FinishOpenWriters( )
+{
+    /* Finish removes the writer from the set, so work on a copy. */
+    std::set<NVMainCompressedTraceWriter *> writers = OpenWriters( );
+    std::set<NVMainCompressedTraceWriter *>::iterator it;
+
+    for( it = writers.begin( ); it != writers.end( ); it++ )
+        (*it)->Finish( );
+}
+
+void NVMainCompressedTraceWriter::Init( Config *conf )
+{
+    if( conf->KeyExists( "CompressedTraceCodec" ) )
+    {
+        std::string codecName = conf->GetString( "CompressedTraceCodec" );
+
+        if( codecName == "LZ" )
+            codec = TRACE_CODEC_LZ;
+        else if( codecName == "zstd" )
+            codec = TRACE_CODEC_ZSTD;
+        else if( codecName == "none" )
+            codec = TRACE_CODEC_STORED;
+        else
+            std::cout << "Warning: Unknown CompressedTraceCodec `" << codecName 
+                << "'. Using LZ." << std::endl;
+
+        if( !TraceCompressor::IsSupported( codec ) )
+        {
+            std::cout << "Warning: NVMain was built without " << codecName 
+                << " support. Using LZ." << std::endl;
+            codec = TRACE_CODEC_LZ;
+        }
+    }
+
+    if( conf->KeyExists( "CompressedTraceBlockRecords" ) )
+        blockRecords = conf->GetValueUL( "CompressedTraceBlockRecords" );
+
+    if( blockRecords == 0 )
+        blockRecords = 1;
+}
+
+void NVMainCompressedTraceWriter::SetTraceFile( std::string file )
+{
+    // Note: This function assumes an absolute path is given, otherwise
+    // the current directory is used. 
+
+    traceFile = file;
+
+    trace.open( traceFile.c_str( ), std::ofstream::out | std::ofstream::binary );
+
+    if( !trace.is_open( ) )
+    {
+        std::cout << "Warning: Could not open trace file " << file
+                  << ". Output will be suppressed." << std::endl;
+        return;
+    }
+
+    OpenWriters( ).insert( this );
+
+    /* Registered after the set exists, so it runs before the set is destroyed. */
+    static bool finishAtExit = false;
+
+    if( !finishAtExit )
+    {
+        atexit( FinishOpenWriters );
+        finishAtExit = true;
+    }
+}
+
+std::string NVMainCompressedTraceWriter::GetTraceFile( )
+{
+    return traceFile;
+}
+
+void NVMainCompressedTraceWriter::SetEcho( bool echo )
+{
+    GenericTraceWriter::SetEcho( echo );
+    echoWriter.SetEcho( echo );
+}
+
+/*
+ *  The header is written with the first record, since that is the first
+ *  time the writer knows whether requests carry data. Later records without
+ *  data are written with zeroed payloads.
+ */
+void NVMainCompressedTraceWriter::WriteHeader( TraceLine *firstLine )
+{
+    memcpy( header.magic, NVMC_MAGIC, sizeof(header.magic) );
+    header.version = NVMC_VERSION;
+    header.codec = codec;
+    header.flags = 0;
+    header.dataSize = 0;
+    header.blockRecords = static_cast<uint32_t>( blockRecords );
+    header.indexOffset = 0;
+    header.blockCount = 0;
+
+    if( firstLine != NULL && firstLine->GetData( ).GetSize( ) > 0 )
+    {
+        header.flags |= NVMB_HAS_DATA;
+        header.dataSize = static_cast<uint32_t>( firstLine->GetData( ).GetSize( ) );
+    }
+
+    if( firstLine != NULL && firstLine->GetOldData( ).GetSize( ) > 0 )
+    {
+        header.flags |= NVMB_HAS_OLDDATA;
+
+        if( header.dataSize == 0 )
+            header.dataSize = static_cast<uint32_t>( firstLine->GetOldData( ).GetSize( ) );
+    }
+
+    header.recordSize = sizeof(NVMBinaryTraceRecord);
+    if( header.flags & NVMB_HAS_DATA )
+        header.recordSize += header.dataSize;
+    if( header.flags & NVMB_HAS_OLDDATA )
+        header.recordSize += header.dataSize;
+
+    rawBlock.reserve( blockRecords * header.recordSize );
+
+    trace.write( reinterpret_cast<const char *>( &header ), sizeof(header) );
+    wroteHeader = true;
+}
+
+void NVMainCompressedTraceWriter::AppendPayload( NVMDataBlock& block )
+{
+    uint64_t copySize = block.GetSize( );
+
+    if( block.rawData == NULL )
+        copySize = 0;
+    else if( copySize > header.dataSize )
+        copySize = header.dataSize;
+
+    rawBlock.insert( rawBlock.end( ), block.rawData, block.rawData + copySize );
+    rawBlock.insert( rawBlock.end( ), header.dataSize - copySize, 0 );
+}
+
+void NVMainCompressedTraceWriter::WriteBlock( )
+{
+    NVMCompressedTraceBlock block;
+    NVMCompressedTraceIndexEntry entry;
+
+    compressor.Compress( codec, &rawBlock[0], rawBlock.size( ), compressedBlock );
+
+    /* Store blocks as-is when compression does not help. */
+    if( compressedBlock.size( ) >= rawBlock.size( ) )
+        compressedBlock = rawBlock;
+
+    memset( &block, 0, sizeof(block) );
+    block.firstCycle = blockFirstCycle;
+    block.records = static_cast<uint32_t>( bufferedRecords );
+    block.rawSize = static_cast<uint32_t>( rawBlock.size( ) );
+    block.compressedSize = static_cast<uint32_t>( compressedBlock.size( ) );
+
+    entry.firstCycle = blockFirstCycle;
+    entry.offset = static_cast<uint64_t>( trace.tellp( ) );
+    index.push_back( entry );
+
+    trace.write( reinterpret_cast<const char *>( &block ), sizeof(block) );
+    trace.write( reinterpret_cast<const char *>( &compressedBlock[0] ), 
+                 compressedBlock.size( ) );
+
+    rawBlock.clear( );
+    bufferedRecords = 0;
+}
+
+void NVMainCompressedTraceWriter::Finish( )
+{
+    if( !trace.is_open( ) )
+        return;
+
+    /* An empty trace still gets a header so it can be read back. */
+    if( !wroteHeader )
+        WriteHeader( NULL );
+
+    if( bufferedRecords > 0 )
+        WriteBlock( );
+
+    header.indexOffset = static_cast<uint64_t>( trace.tellp( ) );
+    header.blockCount = index.size( );
+
+    if( !index.empty( ) )
+    {
+        trace.write( reinterpret_cast<const char *>( &index[0] ), 
+                     index.size( ) * sizeof(NVMCompressedTraceIndexEntry) );
+    }
+
+    trace.seekp( 0 );
+    trace.write( reinterpret_cast<const char *>( &header ), sizeof(header) );
+    trace.close( );
+
+    OpenWriters( ).erase( this );
+}
+
+bool NVMainCompressedTraceWriter::SetNextAccess( TraceLine *nextAccess )
+{
+    bool rv = false;
+
+    /* Only write reads or writes. */
+    if( trace.is_open( ) && (nextAccess->GetOperation( ) == READ 
+                             || nextAccess->GetOperation( ) == WRITE) )
+    {
+        NVMBinaryTraceRecord record;
+
+        if( !wroteHeader )
+            WriteHeader( nextAccess );
+
+        if( bufferedRecords == 0 )
+            blockFirstCycle = nextAccess->GetCycle( );
+
+        memset( &record, 0, sizeof(record) );
+        record.cycle = nextAccess->GetCycle( );
+        record.address = nextAccess->GetAddress( ).GetPhysicalAddress( );
+        record.threadId = static_cast<uint32_t>( nextAccess->GetThreadId( ) );
+        record.operation = (nextAccess->GetOperation( ) == WRITE) ? NVMB_OP_WRITE 
+                                                                  : NVMB_OP_READ;
+
+        const uint8_t *recordBytes = reinterpret_cast<const uint8_t *>( &record );
+        rawBlock.insert( rawBlock.end( ), recordBytes, recordBytes + sizeof(record) );
+
+        if( header.flags & NVMB_HAS_DATA )
+            AppendPayload( nextAccess->GetData( ) );
+        if( header.flags & NVMB_HAS_OLDDATA )
+            AppendPayload( nextAccess->GetOldData( ) );
+
+        bufferedRecords++;
+
+        if( bufferedRecords == blockRecords )
+            WriteBlock( );
+    }
+
+    if( trace.is_open( ) )
+        rv = trace.good( );
+
+    if( GetEcho( ) )
+    {
+        echoWriter.SetNextAccess( nextAccess );
+        rv = true;
+    }
+
+    return rv;
+}
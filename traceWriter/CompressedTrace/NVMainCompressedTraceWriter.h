@@ -0,0 +1,101 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#ifndef __NVMAINCOMPRESSEDTRACEWRITER_H__
+#define __NVMAINCOMPRESSEDTRACEWRITER_H__
+
+#include "traceWriter/GenericTraceWriter.h"
+#include "traceWriter/NVMainTrace/NVMainTraceWriter.h"
+#include "traceReader/CompressedTrace/NVMainCompressedTraceFormat.h"
+#include "traceReader/CompressedTrace/TraceCompressor.h"
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <set>
+
+namespace NVM {
+
+class NVMainCompressedTraceWriter : public GenericTraceWriter
+{
+  public:
+    NVMainCompressedTraceWriter( );
+    ~NVMainCompressedTraceWriter( );
+
+    void Init( Config *conf );
+    
+    void SetTraceFile( std::string file );
+    std::string GetTraceFile( );
+
+    void SetEcho( bool echo );
+    
+    bool SetNextAccess( TraceLine *nextAccess );
+  
+  private:
+    std::string traceFile;
+    std::ofstream trace;
+
+    uint32_t codec;
+    ncounter_t blockRecords;
+
+    NVMCompressedTraceHeader header;
+    bool wroteHeader;
+
+    /* Records of the block being filled. */
+    std::vector<uint8_t> rawBlock;
+    ncounter_t bufferedRecords;
+    ncycle_t blockFirstCycle;
+
+    std::vector<uint8_t> compressedBlock;
+    std::vector<NVMCompressedTraceIndexEntry> index;
+    TraceCompressor compressor;
+
+    /* Binary records are not readable on a console, so echo as text. */
+    NVMainTraceWriter echoWriter;
+
+    void WriteHeader( TraceLine *firstLine );
+    void AppendPayload( NVMDataBlock& block );
+    void WriteBlock( );
+    void Finish( );
+
+    /*
+     *  NVMain keeps its pre-trace writer until the process exits, and the
+     *  last block and the index are only written when a writer finishes,
+     *  so writers still open at exit are finished then.
+     */
+    static std::set<NVMainCompressedTraceWriter *>& OpenWriters( );
+    static void FinishOpenWriters( );
+};
+
+};
+
+#endif
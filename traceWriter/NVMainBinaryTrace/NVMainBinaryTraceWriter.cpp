@@ -0,0 +1,191 @@
+/*******************************************************************************
+* Copyright (c) 2012-2014, The Microsystems Design Labratory (MDL)
+* Department of Computer Science and Engineering, The Pennsylvania State University
+* All rights reserved.
+* 
+* This source code is part of NVMain - A cycle accurate timing, bit accurate
+* energy simulator for both volatile (e.g., DRAM) and non-volatile memory
+* (e.g., PCRAM). The source code is free and you can redistribute and/or
+* modify it by providing that the following conditions are met:
+* 
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer.
+* 
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+* 
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Author list: 
+*   Matt Poremba    ( Email: mrp5060 at psu dot edu 
+*                     Website: http://www.cse.psu.edu/~poremba/ )
+*******************************************************************************/
+
+#include "traceWriter/NVMainBinaryTrace/NVMainBinaryTraceWriter.h"
+#include <cstring>
+#include <cstddef>
+
+using namespace NVM;
+
+NVMainBinaryTraceWriter::NVMainBinaryTraceWriter( )
+{
+    memset( &header, 0, sizeof(header) );
+    wroteHeader = false;
+}
+
+NVMainBinaryTraceWriter::~NVMainBinaryTraceWriter( )
+{
+    if( trace.is_open( ) )
+    {
+        /* An empty trace still gets a header so it can be read back. */
+        if( !wroteHeader )
+            WriteHeader( NULL );
+
+        trace.seekp( offsetof( NVMBinaryTraceHeader, recordCount ) );
+        trace.write( reinterpret_cast<const char *>( &header.recordCount ),
+                     sizeof(header.recordCount) );
+        trace.close( );
+    }
+}
+
+void NVMainBinaryTraceWriter::SetTraceFile( std::string file )
+{
+    // Note: This function assumes an absolute path is given, otherwise
+    // the current directory is used. 
+
+    traceFile = file;
+
+    trace.open( traceFile.c_str( ), std::ofstream::out | std::ofstream::binary );
+
+    if( !trace.is_open( ) )
+    {
+        std::cout << "Warning: Could not open trace file " << file
+                  << ". Output will be suppressed." << std::endl;
+    }
+}
+
+std::string NVMainBinaryTraceWriter::GetTraceFile( )
+{
+    return traceFile;
+}
+
+void NVMainBinaryTraceWriter::SetEcho( bool echo )
+{
+    GenericTraceWriter::SetEcho( echo );
+    echoWriter.SetEcho( echo );
+}
+
+/*
+ *  The header is written with the first record, since that is the first
+ *  time the writer knows whether requests carry data. Later records without
+ *  data are written with zeroed payloads.
+ */
+void NVMainBinaryTraceWriter::WriteHeader( TraceLine *firstLine )
+{
+    memcpy( header.magic, NVMB_MAGIC, sizeof(header.magic) );
+    header.version = NVMB_VERSION;
+    header.flags = 0;
+    header.dataSize = 0;
+    header.recordCount = 0;
+
+    if( firstLine != NULL && firstLine->GetData( ).GetSize( ) > 0 )
+    {
+        header.flags |= NVMB_HAS_DATA;
+        header.dataSize = static_cast<uint32_t>( firstLine->GetData( ).GetSize( ) );
+    }
+
+    if( firstLine != NULL && firstLine->GetOldData( ).GetSize( ) > 0 )
+    {
+        header.flags |= NVMB_HAS_OLDDATA;
+
+        if( header.dataSize == 0 )
+            header.dataSize = static_cast<uint32_t>( firstLine->GetOldData( ).GetSize( ) );
+    }
+
+    /* Both payloads share one size; an old data-only trace uses its size. */
+    header.recordSize = sizeof(NVMBinaryTraceRecord);
+    if( header.flags & NVMB_HAS_DATA )
+        header.recordSize += header.dataSize;
+    if( header.flags & NVMB_HAS_OLDDATA )
+        header.recordSize += header.dataSize;
+
+    padding.assign( header.dataSize, 0 );
+
+    trace.write( reinterpret_cast<const char *>( &header ), sizeof(header) );
+    wroteHeader = true;
+}
+
+void NVMainBinaryTraceWriter::WritePayload( NVMDataBlock& block )
+{
+    uint64_t copySize = block.GetSize( );
+
+    if( block.rawData == NULL )
+        copySize = 0;
+    else if( copySize > header.dataSize )
+        copySize = header.dataSize;
+
+    if( copySize > 0 )
+        trace.write( reinterpret_cast<const char *>( block.rawData ), copySize );
+
+    if( copySize < header.dataSize )
+        trace.write( &padding[0], header.dataSize - copySize );
+}
+
+bool NVMainBinaryTraceWriter::SetNextAccess( TraceLine *nextAccess )
+{
+    bool rv = false;
+
+    /* Only write reads or writes. */
+    if( trace.is_open( ) && (nextAccess->GetOperation( ) == READ 
+                             || nextAccess->GetOperation( ) == WRITE) )
+    {
+        NVMBinaryTraceRecord record;
+
+        if( !wroteHeader )
+            WriteHeader( nextAccess );
+
+        memset( &record, 0, sizeof(record) );
+        record.cycle = nextAccess->GetCycle( );
+        record.address = nextAccess->GetAddress( ).GetPhysicalAddress( );
+        record.threadId = static_cast<uint32_t>( nextAccess->GetThreadId( ) );
+        record.operation = (nextAccess->GetOperation( ) == WRITE) ? NVMB_OP_WRITE 
+                                                                  : NVMB_OP_READ;
+
+        trace.write( reinterpret_cast<const char *>( &record ), sizeof(record) );
+
+        if( header.flags & NVMB_HAS_DATA )
+            WritePayload( nextAccess->GetData( ) );
+        if( header.flags & NVMB_HAS_OLDDATA )
+            WritePayload( nextAccess->GetOldData( ) );
+
+        header.recordCount++;
+
+        /* 
+         *  The writer may never be destroyed before the simulator exits,
+         *  so flush like the text writer does. The reader recovers the
+         *  record count from the file size in that case.
+         */
+        trace.flush( );
+    }
+
+    if( trace.is_open( ) )
+        rv = trace.good( );
+
+    if( GetEcho( ) )
+    {
+        echoWriter.SetNextAccess( nextAccess );
+        rv = true;
+    }
+
+    return rv;
+}
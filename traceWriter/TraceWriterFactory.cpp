@@ -38,6 +38,8 @@
 #include "traceWriter/NVMainTrace/NVMainTraceWriter.h"
 #include "traceWriter/VerilogTrace/VerilogTraceWriter.h"
 #include "traceWriter/DRAMPower2Trace/DRAMPower2TraceWriter.h"
+#include "traceWriter/NVMainBinaryTrace/NVMainBinaryTraceWriter.h"
+#include "traceWriter/CompressedTrace/NVMainCompressedTraceWriter.h"
 
 using namespace NVM;
 
@@ -55,6 +57,10 @@ GenericTraceWriter *TraceWriterFactory::CreateNewTraceWriter( std::string writer
         tracer = new VerilogTraceWriter( );
     else if( writer == "DRAMPower2Trace" )
         tracer = new DRAMPower2TraceWriter( );
+    else if( writer == "NVMainBinaryTrace" )
+        tracer = new NVMainBinaryTraceWriter( );
+    else if( writer == "NVMainCompressedTrace" )
+        tracer = new NVMainCompressedTraceWriter( );
 
     if( tracer == NULL )
         std::cout << "NVMain: Unknown trace writer `" << writer << "'." 